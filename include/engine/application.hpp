@@ -7,6 +7,7 @@
 #include "scene.hpp"
 #include "application/event.hpp"
 #include "application/window.hpp"
+#include "application/update_schedule.hpp"
 
 namespace engine {
     class application {
@@ -15,7 +16,15 @@ namespace engine {
         nullable_rc<scene> m_active_scene = nullptr;
         bool m_ignore_mouse_move_on_next_event = true;
         glm::vec2 m_prev_mouse_cursor_pos;
-        std::vector<event_variant_t> m_events_this_frame;
+        update_schedule m_updates;
+        bool m_pipelined = false;
+
+        // sync point at the start of each frame: switch scene if requested, poll events and fill the active scene's from_app channel
+        void begin_frame(float delta, float frame_time);
+        // update the active scene (once, or as many fixed timesteps as fit in delta); returns the interpolation factor to render with
+        float simulate(float delta);
+        void run_sequential();
+        void run_pipelined();
     public:
         application(application&&) = delete; // application cannot be moved: m_window's window handle points to it in its user pointer and scene::m_application points to it
         application(const application&) = delete;
@@ -30,6 +39,27 @@ namespace engine {
         //needs to be separate from the constructor because a scene can only be constructed after gl (gal) and resources_manager are initialized, which happens in application's constructor
         void set_start_scene(rc<scene> start_scene);
 
+        /* in pipelined mode the update of frame N+1 (scripts, collisions, transform propagation and extraction of the
+         * render snapshot) runs on a worker thread while the main thread submits frame N's render snapshot; ImGui windows
+         * lag the rendered scene by one frame.
+         * NOTE: since scripts then run concurrently with rendering, they must not create or destroy GL objects (e.g. by
+         * loading meshes, textures or shaders) and must change the node tree and payloads only through
+         * application_channel_t::mutations(), which are applied on the main thread once the update is done (so their
+         * effects are rendered one frame later than in sequential mode). Meshes and viewports are read-only during the
+         * update, since the main thread reads them: getting them mutably from a node fails a precondition check (see
+         * node::set_render_payloads_read_only).
+         * Calling ImGui from scripts is fine, as the main thread does not use it while the worker runs.
+         * must be called before run()
+         */
+        void set_pipelined(bool pipelined) { m_pipelined = pipelined; }
+
+        /* in fixed timestep mode the scene is updated in steps of exactly `seconds` (delta is always `seconds`), as many
+         * times per frame as needed to keep up with real time, and rendering interpolates the meshes' and cameras' global
+         * transforms between the last two steps; pass std::nullopt to update once per frame with the real delta instead.
+         * each frame's events are delivered to the first update following them.
+         */
+        void set_fixed_timestep(std::optional<float> seconds) { m_updates.set_fixed_timestep(seconds); }
+
         void run();
     };
 }
@@ -0,0 +1,66 @@
+#ifndef ENGINE_APPLICATION_UPDATE_SCHEDULE_HPP
+#define ENGINE_APPLICATION_UPDATE_SCHEDULE_HPP
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+#include <slogga/asserts.hpp>
+
+#include "event.hpp"
+
+namespace engine {
+    /* what application hands to the active scene's updates each frame: the events polled since the last update which
+     * received them, and, in fixed timestep mode, how many steps of exactly the timestep fit in the real time elapsed.
+     * a frame may run no update at all in fixed timestep mode, in which case its events are kept for the next frame's
+     */
+    class update_schedule {
+        std::optional<float> m_fixed_timestep = std::nullopt;
+        float m_accumulator = 0.f;
+        std::vector<event_variant_t> m_events;
+        bool m_events_consumed = true; // whether the events in m_events have been passed to an update
+    public:
+        // avoid the spiral of death: if updating takes longer than the timestep the accumulator would grow without bounds
+        static constexpr int max_steps_per_frame = 8;
+
+        void set_fixed_timestep(std::optional<float> seconds) {
+            EXPECTS(!seconds || *seconds > 0.f);
+            m_fixed_timestep = seconds;
+            m_accumulator = 0.f;
+        }
+        const std::optional<float>& fixed_timestep() const { return m_fixed_timestep; }
+
+        // starts a new frame, before polling its events: drops the events an update received
+        void begin_frame() {
+            if(m_events_consumed)
+                m_events.clear();
+        }
+        void push_event(event_variant_t e) {
+            m_events.push_back(e);
+            m_events_consumed = false;
+        }
+        const std::vector<event_variant_t>& events() const { return m_events; }
+        // to be called once an update has received events()
+        void consume_events() { m_events_consumed = true; }
+
+        // fixed timestep mode only: adds delta to the time to simulate, returning how many steps to run this frame
+        int advance(float delta) {
+            EXPECTS(m_fixed_timestep.has_value());
+            const float step = *m_fixed_timestep;
+            m_accumulator += delta;
+            int steps = int(m_accumulator / step);
+            if(steps > max_steps_per_frame) {
+                steps = max_steps_per_frame;
+                m_accumulator = float(steps) * step;
+            }
+            m_accumulator -= float(steps) * step;
+            return steps;
+        }
+        // fixed timestep mode only: the fraction of a step left over by the last advance(), to interpolate rendering by
+        float interpolation() const {
+            EXPECTS(m_fixed_timestep.has_value());
+            return std::clamp(m_accumulator / *m_fixed_timestep, 0.f, 1.f);
+        }
+    };
+}
+
+#endif // ENGINE_APPLICATION_UPDATE_SCHEDULE_HPP
@@ -37,6 +37,7 @@ namespace engine {
             register_new_component(std::unique_ptr<ecs_component_interface>(new ecs_component_dense_vector<glm::mat4>("transform", glm::mat4(1.))));
             register_new_component(std::unique_ptr<ecs_component_interface>(new ecs_component_optional_hashmap<glm::mat4>("global_transform_cache")));
             register_new_component(std::unique_ptr<ecs_component_interface>(new ecs_component_optional_hashmap<glm::mat4>("transform_edits")));
+            register_new_component(std::unique_ptr<ecs_component_interface>(new ecs_component_optional_hashmap<glm::mat4>("previous_global_transform"))); // for render interpolation in fixed timestep mode
             register_new_component(std::unique_ptr<ecs_component_interface>(new ecs_component_optional_hashmap<std::string>("name")));
         }
 
@@ -50,6 +51,9 @@ namespace engine {
         // the components used are only really ever used for cleaning them up on id deallocation, and aren't automatically updated when a new component is used by an entity
         ecs_id_t make_new_id(components_used_set_t components_used);
 
+        // make sure at least count ids can be allocated without growing the id pool, so many allocations in a row only grow it once
+        void reserve_ids(ecs_id_t count);
+
         void add_new_used_component(ecs_id_t id, component_name_t component_name);
 
         void release_id(ecs_id_t id);
@@ -10,7 +10,9 @@
 
 namespace engine {
     //this is only a temporary entry point; the window creation parameters and the start scene will be fetched from the asset-like file which defines the root of the game
-    ENGINE_API void entry_point(glm::ivec2 wnd_res, const std::string& wnd_name, window::hints wnd_hints, std::function<rc<scene>()> get_start_scene);
+    // pipelined: run the scene's update on a worker thread concurrently with rendering the previous frame (see application::set_pipelined for the restrictions this puts on scripts)
+    // fixed_timestep: if set, update the scene in fixed steps of this many seconds and interpolate rendering between them (see application::set_fixed_timestep)
+    ENGINE_API void entry_point(glm::ivec2 wnd_res, const std::string& wnd_name, window::hints wnd_hints, std::function<rc<scene>()> get_start_scene, bool pipelined = false, std::optional<float> fixed_timestep = std::nullopt);
 }
 
 #endif // ENGINE_ENTRY_POINT_HPP
@@ -13,6 +13,8 @@
 // frequently abbreviated as rm to save keystrokes/screenspace since it is used everywhere
 
 namespace engine {
+    struct script_index;
+
     enum class internal_resource_name_t : uint8_t {
         whole_screen_vao, simple_3d_shader, dither_texture,
     };
@@ -37,6 +39,10 @@ namespace engine {
 
         std::optional<rc<const shader>> m_default_3d_shader;
 
+        // script indices of the loaded dynamic libraries, erased when the library is unloaded; behind pointers so that
+        // script_index (see scene/node/script.hpp) need not be complete here
+        hashmap<const dylib::library*, std::unique_ptr<const script_index>> m_script_indices;
+
         resources_manager() = default;
         resources_manager(const resources_manager&) = delete;
         resources_manager(resources_manager&&) = delete;
@@ -85,6 +91,9 @@ namespace engine {
         template<AnyOneOf<shader, nodetree_blueprint, gal::texture, scene> T> [[nodiscard]] ENGINE_API
         rc<T> load_mut(const std::string& p);
 
+        // get the index of the scripts exported by dynlib; it is built on the first call for a given library and kept until the library is unloaded
+        [[nodiscard]] ENGINE_API const script_index& get_script_index(const rc<const dylib::library>& dynlib);
+
         // get/set default 3d shader (for models loaded from file). if it is null (it is by default) the "simple 3d shader" is used instead
         ///TODO: allow user to embed shader information in gltf (which would also allow different meshes in the same gltf to use different shaders)
         [[nodiscard]] ENGINE_API rc<const shader> get_default_3d_shader();
@@ -99,6 +108,18 @@ namespace engine {
 
         // get singleton instance
         [[nodiscard]] static resources_manager& get_instance();
+
+        // inits the singleton instance for its lifetime without an application (and therefore without an OpenGL context);
+        // for tests and benchmarks which only exercise the parts of the engine not touching the GPU, e.g. the node tree and collisions
+        class headless_instance {
+        public:
+            ENGINE_API headless_instance();
+            ENGINE_API ~headless_instance();
+            headless_instance(const headless_instance&) = delete;
+            headless_instance(headless_instance&&) = delete;
+            headless_instance& operator=(const headless_instance&) = delete;
+            headless_instance& operator=(headless_instance&&) = delete;
+        };
     private:
         friend class application;
         static void init_instance();
@@ -4,6 +4,9 @@
 #include "scene/node.hpp"
 #include "scene/broad_phase_collision.hpp"
 #include "scene/application_channel.hpp"
+#include "scene/mutation_queue.hpp"
+#include "scene/script_profiler.hpp"
+#include "scene/render_snapshot.hpp"
 
 #include <engine/resources_manager/rc.hpp>
 #include <engine/utils/api_macro.hpp>
@@ -16,14 +19,28 @@ namespace engine {
         engine::renderer m_renderer;
         rc<const gal::vertex_array> m_whole_screen_vao; // for post-processing
         gal::render_flags m_render_flags;
+        render_snapshot m_render_snapshot; // reused by render() to avoid reallocating the command list every frame
 
+        // heap allocated so that the pointer to it held by m_application_channel stays valid when the scene is moved
+        std::unique_ptr<mutation_queue> m_mutation_queue;
         application_channel_t m_application_channel;
 
-        pass_all_broad_phase_collision_detector m_bp_collision_detector;
+        // chosen at construction (see the constructor)
+        std::unique_ptr<broad_phase_collision_detector> m_bp_collision_detector;
+
+        // heap allocated so that the pointer to it held by m_bp_collision_detector stays valid when the scene is moved
+        std::unique_ptr<script_profiler> m_script_profiler;
+        bool m_show_script_profiler_window = false;
+        bool m_pipelined = false;
     public:
         scene() = delete;
         //TODO: these should not be ENGINE_API
-        ENGINE_API scene(std::string s, std::unique_ptr<node> root, application_channel_t::to_app_t to_app_chan = {});
+        // bp_collision_detector is the broad phase used by this scene; if null a pass_all_broad_phase_collision_detector is used
+        ENGINE_API scene(std::string s, std::unique_ptr<node> root, application_channel_t::to_app_t to_app_chan = {}, std::unique_ptr<broad_phase_collision_detector> bp_collision_detector = nullptr);
+        scene(scene&&) = default;
+        scene& operator=(scene&&) = default;
+        // detaches the node tree from the bpcd before destroying it, since the bpcd is destroyed first
+        ENGINE_API ~scene();
 
         // prepare() is called when the scene is inited and when the application switches from a different scene
         // (requires OpenGL to be inited)
@@ -31,7 +48,31 @@ namespace engine {
 
         //update() & render() are called every frame
         void update();
-        void render();
+        // called once per rendered frame, after the frame's updates (of which there may be several, or none, in fixed
+        // timestep mode): publishes the script profiler's frame and draws its window
+        void end_frame();
+        // equivalent to extract_render_snapshot() followed by submit_render_snapshot()
+        void render(float interpolation = 1.f);
+        // remember the current global transforms of meshes and cameras, so that rendering can interpolate between them and
+        // the ones after the next update; used in fixed timestep mode, before the last update of a frame
+        void capture_previous_transforms();
+
+        // the two halves of render(), which the application runs on different threads in pipelined mode:
+        // extracting reads the node tree (and sets the viewports' active cameras), submitting only reads the snapshot and issues GL calls
+        // interpolation is the fraction of a fixed timestep to blend from the captured previous transforms to the current ones (1 to use the current ones)
+        void extract_render_snapshot(render_snapshot& out, float interpolation = 1.f);
+        void submit_render_snapshot(const render_snapshot& snapshot);
+        /* in pipelined mode update() does not apply the mutation queue: the application calls apply_mutations() on the
+         * main thread (which owns the GL context, needed e.g. to copy viewports) while the update thread is idle; since a
+         * snapshot extracted before that may still be submitted, the nodes and payloads it destroys are kept alive until
+         * flush_deferred_destructions()
+         */
+        void set_pipelined(bool pipelined) {
+            m_pipelined = pipelined;
+            m_mutation_queue->set_deferred_destruction(pipelined);
+        }
+        void apply_mutations() { m_mutation_queue->apply(); }
+        void flush_deferred_destructions() { m_mutation_queue->flush_deferred_destructions(); }
 
         gal::render_flags get_render_flags() { return m_render_flags; }
         void set_render_flags(gal::render_flags flags) { m_render_flags = flags; }
@@ -40,11 +81,17 @@ namespace engine {
 
         node& get_root();
         node& get_node(std::string_view path);
-        [[nodiscard]] std::unique_ptr<node> into_node_tree() {
-            std::unique_ptr<node> ret = std::move(m_root);
-            m_root = nullptr;
-            return ret;
-        }
+        [[nodiscard]] ENGINE_API std::unique_ptr<node> into_node_tree();
+
+        // e.g. for spatial queries (raycasts, overlaps, nearest colliders)
+        const broad_phase_collision_detector& get_bp_collision_detector() const { return *m_bp_collision_detector; }
+        broad_phase_collision_detector& get_bp_collision_detector() { return *m_bp_collision_detector; }
+
+        // per-script cpu time accounting; disabled by default (see script_profiler::set_enabled)
+        script_profiler& get_script_profiler() { return *m_script_profiler; }
+        const script_profiler& get_script_profiler() const { return *m_script_profiler; }
+        // show or hide the ImGui window displaying the script profiler's stats
+        void show_script_profiler_window(bool show) { m_show_script_profiler_window = show; }
 
         //used by engine::application to communicate with the scene
         const application_channel_t& app_channel() const { return m_application_channel; }
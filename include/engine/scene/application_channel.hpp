@@ -12,6 +12,7 @@ struct ImGuiContext; //avoid including imgui.h (and linking imgui) just for this
 namespace engine {
     class scene;
     class application;
+    class mutation_queue;
 
     struct application_channel_t {
         struct to_app_t {
@@ -34,12 +35,15 @@ namespace engine {
     private:
         from_app_t m_from_app;
         to_app_t m_to_app;
+        mutation_queue* m_mutation_queue = nullptr; // owned by the scene
 
         friend class application;
         from_app_t& from_app_mut() { return m_from_app; }
     public:
         const from_app_t& from_app() const { return m_from_app; }
         to_app_t& to_app() { return m_to_app; }
+        // structural changes to the scene's node tree (spawn, destroy, reparent, payload swap) must be queued here during scene::update
+        mutation_queue& mutations() { EXPECTS(m_mutation_queue != nullptr); return *m_mutation_queue; }
 
         application_channel_t() = default;
         application_channel_t(const application_channel_t&) = delete;
@@ -47,7 +51,7 @@ namespace engine {
         application_channel_t& operator=(const application_channel_t&) = delete;
         application_channel_t& operator=(application_channel_t&&) = delete;
         ~application_channel_t() = default;
-        ENGINE_API application_channel_t(to_app_t to_app, from_app_t from_app);
+        ENGINE_API application_channel_t(to_app_t to_app, from_app_t from_app, mutation_queue& mutations);
     };
 
 
@@ -1,18 +1,188 @@
 #ifndef ENGINE_SCENE_BROAD_PHASE_COLLISION_HPP
 #define ENGINE_SCENE_BROAD_PHASE_COLLISION_HPP
 
+#include <cstdint>
+#include <limits>
+#include <span>
 #include <vector>
 
+#include <glm/glm.hpp>
+
 #include <engine/resources_manager/rc.hpp>
+#include <engine/scene/broad_phase_collision/collision_layer_buckets.hpp>
+#include <engine/scene/collision_resolver.hpp>
+#include <engine/scene/node/narrow_phase_collision.hpp>
+#include <engine/scene/spatial_query.hpp>
+#include <engine/utils/aabb.hpp>
+#include <engine/utils/api_macro.hpp>
+#include <engine/utils/hash.hpp>
+#include <engine/utils/thread_pool.hpp>
 
 namespace engine {
     class node;
+    class script_profiler;
+    enum class trigger_event : std::uint8_t;
+
+    /* the colliders subscribed to a bpcd, in subscription order.
+     * Removing a collider only leaves a hole, which is dropped by the next compact(): an unchanged list costs nothing,
+     * and however many colliders are removed in a frame they are all dropped in a single O(n) pass.
+     */
+    class collider_subscriptions {
+        std::vector<node*> m_nodes; // nullptr for removed nodes, until the next compact()
+        hashmap<node*, std::uint32_t> m_index_of;
+        std::size_t m_holes = 0;
+    public:
+        void add(node* n);
+        void remove(node* n);
+        // drop the holes left by remove(); returns whether there were any, i.e. whether the indices of the nodes changed
+        bool compact();
+
+        // the subscribed nodes, in subscription order; the list must have been compacted since the last remove()
+        std::span<node* const> nodes() const;
+        // the same, but holes included: the nodes keep the indices they had at the last compact(), and removed ones are nullptr
+        std::span<node* const> nodes_and_holes() const { return m_nodes; }
+        std::size_t size() const { return m_index_of.size(); }
+    };
 
     /* broad phase collision detector interface:
      * it is an abstract class even though the bpcd will never be "hot-swappable";
      * it will simply be useful for development and debugging.
+     * Colliders are subscribed by the nodes themselves when they are attached to a scene's tree (or get a collision
+     * shape), and unsubscribed when detached or destroyed (or when they lose it); detectors can therefore keep their
+     * acceleration structures across frames, and an unchanged scene costs nothing to keep subscribed.
      */
     class broad_phase_collision_detector {
+    public:
+        // how the narrow phase of the pairs went, since the last reset_pair_cache_stats()
+        struct pair_cache_stats {
+            std::size_t hits = 0; // pairs whose relative transform had not changed, whose last result was reused
+            std::size_t axis_early_outs = 0; // pairs checked again, and proved apart by their cached axis alone
+            std::size_t misses = 0; // pairs checked again in full
+        };
+    private:
+        enum class pair_cache_outcome : std::uint8_t { hit, axis_early_out, miss };
+
+        // a candidate pair whose colliders see each other's layers, with all check_collision needs
+        struct narrow_phase_job {
+            node* a;
+            node* b;
+            const collision_shape* a_shape;
+            const collision_shape* b_shape;
+            glm::mat4 a_trans;
+            glm::mat4 b_trans;
+            bool a_sees_b;
+            bool b_sees_a;
+            bool is_trigger; // only whether the colliders overlap is computed
+            // for pairs with a continuous collider: where a and b were at the end of the last frame (nullptr for a collider
+            // which is not continuous, or was not subscribed then); the pair is swept if either is set
+            const glm::mat4* a_from;
+            const glm::mat4* b_from;
+            std::uint32_t cache_index; // of the pair's entry in m_pair_cache
+            pair_cache_outcome outcome; // set by the narrow phase
+            bool overlapping; // set by the narrow phase, for trigger pairs only
+        };
+        std::vector<narrow_phase_job> m_jobs;
+        std::vector<collision_result> m_results; // same indices as m_jobs
+        thread_pool* m_thread_pool = &thread_pool::shared();
+        collision_resolver m_resolver;
+
+        // what is remembered of a pair of colliders which was a candidate in the last frame
+        struct cached_pair {
+            glm::mat4 b_to_a = glm::mat4(0); // b's transform in a's space, when last checked
+            glm::mat4 last_b_to_a = glm::mat4(0); // the same, as of the last narrow phase (even if it reused the result)
+            glm::vec3 a_space_versor = glm::vec3(0); // the result's versor in a's space (0 if there was no collision)
+            float depth = 0.f;
+            collision_axis_hint hint;
+            std::uint64_t frame = 0; // the last frame the pair was a candidate in
+            bool checked = false;
+            bool trigger = false; // whether it was a trigger pair when last checked: a_space_versor and depth are not kept then
+            bool overlapping = false; // trigger pairs only: whether the colliders overlapped when last checked
+            bool trigger_entered = false; // an enter event was sent, and no exit event yet
+            bool a_sees_b = false, b_sees_a = false; // trigger pairs only: who was sent the enter event, and so is sent the exit one
+        };
+        hashmap<std::pair<node*, node*>, cached_pair> m_pair_cache;
+        hashset<node*> m_forgotten_nodes; // unsubscribed since the last frame, so their pairs must leave the cache
+        std::size_t m_entered_trigger_pairs = 0; // the entries of m_pair_cache with trigger_entered set
+        std::uint64_t m_frame = 0;
+        float m_pair_cache_tolerance = 1e-5f;
+        pair_cache_stats m_pair_cache_stats;
+
+        // the narrow phase of a pair, reusing or updating its cache entry; trigger pairs return null and set job.overlapping
+        static collision_result check_pair(narrow_phase_job& job, cached_pair& cached, float tolerance);
+        // sends the pair's trigger event to the colliders which see each other
+        void send_trigger_event(node* a, node* b, bool a_sees_b, bool b_sees_a, trigger_event event);
+
+        static constexpr std::uint32_t no_island = std::numeric_limits<std::uint32_t>::max();
+        // whether a subscribed node which can sleep or is continuous moved lately, and whether it is asleep
+        struct sleep_state {
+            glm::mat4 transform = glm::mat4(0); // global, as of the last frame
+            std::uint32_t still_frames = 0; // for how many frames the transform has not changed; 0 if it changed this frame
+            std::uint32_t island = no_island; // the sleeping island the node is in, if it is asleep
+            bool can_sleep = false;
+            bool is_moved_away = false; // by itself or by an ancestor it passes its collision events to
+            std::uint64_t frame = 0; // the last frame the node needed a sleep state in
+        };
+        hashmap<const node*, sleep_state> m_sleep_states;
+        // continuous colliders (see node_collision_behaviour::is_continuous): those subscribed, and their global transforms
+        // as of the end of the last frame (after collisions moved them away), which they are swept from
+        std::vector<const node*> m_continuous_nodes;
+        hashmap<const node*, glm::mat4> m_swept_from;
+        std::vector<std::vector<const node*>> m_sleeping_islands; // the nodes of each sleeping island; empty if unused
+        std::vector<std::uint32_t> m_free_islands;
+        std::uint32_t m_sleep_frames = 60;
+        // scratch for fall_asleep, indexed like m_sleep_states' values
+        std::vector<std::uint32_t> m_island_parent;
+        std::vector<std::uint32_t> m_island_still_frames;
+        std::vector<std::uint32_t> m_new_island;
+
+        void wake_island(std::uint32_t island);
+        // whether the narrow phase can skip a pair (whose cache entry is cached, if any): when one of the nodes is asleep
+        // and neither moved, nothing changed since it fell asleep
+        bool is_resting_pair(const node* a, const node* b, const cached_pair* cached) const;
+        // after the narrow phase: wake the sleeping nodes hit by a node which moved (or has no sleep state)
+        void wake_on_contact(const node* a, const node* b);
+        // after the reactions: put to sleep the islands (of nodes in contact, which are moved away) which have all been still long enough
+        void fall_asleep();
+
+        // calls f(collider, transform) for the colliders of layers which overlap shape (transformed by trans), whose aabb is box
+        template<typename F> void for_each_overlapping(const collision_shape& shape, const glm::mat4& trans, const aabb& box, collision_layers_bitmask layers, F&& f) const;
+        void answer_query(const spatial_query& query, std::vector<spatial_query_hit>& out) const;
+    protected:
+        script_profiler* m_script_profiler = nullptr;
+        // filled by the detectors every frame, in a stable order, for narrow_phase_and_react
+        std::vector<std::pair<node*, node*>> m_candidate_pairs;
+
+        /* The part of a frame common to all detectors, once they have found the candidate pairs:
+         * 1. the pairs whose colliders see each other's layers are gathered along with their shapes and transforms;
+         * 2. the narrow phase, which is pure, runs on them in parallel (on the thread pool), each pair writing its own result;
+         * 3. the reactions are triggered serially, in the order of pairs; for trigger pairs, these are the trigger events,
+         *    found by comparing whether the colliders overlap with the last frame (pairs which stopped being candidates
+         *    exit after all the others);
+         * 4. the nodes moving away on collision are moved by the collision_resolver, which solves all of the frame's
+         *    penetrations together (in parallel, by island) and writes each node's transform once.
+         * So the results do not depend on the number of threads, but only on the order of pairs, which detectors keep stable;
+         * since the reactions come after the whole narrow phase, they (e.g. moving away) do not affect the frame's other pairs.
+         */
+        void narrow_phase_and_react();
+        // must be called by unsubscribe, while n is still alive: sends exit events for the trigger overlaps n is part of
+        // (to the other collider only), wakes n's island and forgets n's sleep state and cached pairs (so that a node
+        // allocated at the same address does not inherit them)
+        void forget_node(node* n);
+        // must be called by the detectors at the start of a frame, before is_asleep and collider_aabb: checks which
+        // subscribers are continuous, and which of those and of the ones which can sleep moved, waking them
+        void update_sleep_states(std::span<node* const> subscribers);
+        // the aabb the detectors must find n's candidates with: its world aabb, which for a continuous collider also
+        // covers where it was at the end of the last frame (a linearly interpolated transform moves each point of the
+        // shape along the segment between its two places)
+        aabb collider_aabb(const node* n) const;
+
+        /* For the spatial queries: appends to out (once each) the colliders whose aabb, as of the last check, overlaps box;
+         * colliders subscribed since then may be left out. Queries may run on several threads at once, so this must only
+         * read the detector.
+         */
+        virtual void colliders_in_aabb(const aabb& box, std::vector<node*>& out) const = 0;
+        // the same, for the colliders which the segment from `from` to `to` may hit; by default those in its aabb
+        virtual void colliders_along_segment(glm::vec3 from, glm::vec3 to, std::vector<node*>& out) const;
     public:
         broad_phase_collision_detector() = default;
         broad_phase_collision_detector(const broad_phase_collision_detector&) = default;
@@ -23,19 +193,83 @@ namespace engine {
 
         virtual void check_collisions_and_trigger_reactions() = 0;
         virtual void subscribe(node*) = 0;
-        virtual void reset_subscriptions() = 0;
+        virtual void unsubscribe(node*) = 0;
+
+        // time the scripts' react_to_collision calls with profiler (nullptr to stop)
+        void set_script_profiler(script_profiler* profiler) { m_script_profiler = profiler; }
+        // run the narrow phase and the collision resolution on pool (thread_pool::shared() by default); nullptr runs them on the calling thread only
+        void set_thread_pool(thread_pool* pool) { m_thread_pool = pool; }
+        // e.g. to set the number of iterations the penetrations are solved with
+        collision_resolver& get_collision_resolver() { return m_resolver; }
+
+        /* The pair cache keeps, for each candidate pair, b's transform in a's space, the narrow phase's result and its
+         * collision_axis_hint. When the relative transform has changed by at most tolerance (times the size of the shapes
+         * for the translation) since the pair was last checked, the result is reused; otherwise the cached axis is tested
+         * first. A negative tolerance disables reusing results, but not the axes.
+         */
+        void set_pair_cache_tolerance(float tolerance) { m_pair_cache_tolerance = tolerance; }
+        const pair_cache_stats& get_pair_cache_stats() const { return m_pair_cache_stats; }
+        void reset_pair_cache_stats() { m_pair_cache_stats = {}; }
+
+        /* Sleeping: the colliders which can sleep (see node_collision_behaviour::can_sleep) fall asleep once they, and all
+         * the nodes of their island, have not moved for frames frames (60 by default). Islands are the groups of colliders in
+         * contact with each other, linked only through the ones moved away on collision (so that e.g. a static floor does
+         * not join all the piles on it). Pairs of sleeping colliders, or of a sleeping one and one which did not move, are
+         * skipped by the narrow phase (and, where possible, by the broad phase) and trigger no reactions. A sleeping island
+         * wakes up when one of its nodes moves (e.g. by set_transform on it or an ancestor), is hit by a collider which
+         * moved, is woken with wake_up, or is unsubscribed.
+         */
+        void set_sleep_frames(std::uint32_t frames) { m_sleep_frames = frames; }
+        ENGINE_API bool is_asleep(const node* n) const;
+        ENGINE_API void wake_up(const node* n);
+
+        /* Triggers (see node_collision_behaviour::is_trigger): a pair of colliders at least one of which is a trigger only
+         * gets an overlap test, which stops at the first proof either way (see check_overlap), and the pair cache reuses
+         * it like any other result. Its colliders get trigger events instead of collision events: enter on the first
+         * frame they overlap, stay on the following ones, and exit on the first frame they do not (or they stop being
+         * candidates, e.g. because they moved apart). When one of them is unsubscribed (or destroyed), the other one gets
+         * its exit right away, from unsubscribe.
+         */
+
+        /* Continuous colliders (see node_collision_behaviour::is_continuous): the detectors find their candidates with
+         * aabbs covering where they were at the end of the last frame and where they are now, and the pairs involving
+         * one which do not collide at the end of the frame are checked with check_swept_collision. A swept collision
+         * is reported like any other, with its time_of_impact: moving away undoes the tunneling. Its result is not
+         * reused by the pair cache.
+         */
+
+        /* Spatial queries, for scripts: they find candidates with the detector's acceleration structure, as of the last
+         * check_collisions_and_trigger_reactions, and test them exactly against the colliders' current transforms (so
+         * colliders which moved far since then may be missed, or found where they were). They only read the scene, and may
+         * run concurrently with each other, but not with a check or with colliders being (un)subscribed.
+         */
+        ENGINE_API std::optional<spatial_query_hit> raycast(const raycast_query& query) const;
+        // these replace out's contents with the answer
+        ENGINE_API void sphere_overlap(const sphere_overlap_query& query, std::vector<node*>& out) const;
+        ENGINE_API void aabb_overlap(const aabb_overlap_query& query, std::vector<node*>& out) const;
+        ENGINE_API void k_nearest(const k_nearest_query& query, std::vector<spatial_query_hit>& out) const;
+        // answers the queries in parallel, on the detector's thread pool (see set_thread_pool)
+        ENGINE_API void run_queries(std::span<const spatial_query> queries, spatial_query_results& results) const;
     };
 
     /* pass all bpcd, a naïve implementation of bpcd:
      * simply passes everything to the narrow phase: not computationally viable, especially
      * for large scenes, but useful for debugging and as a first working implementation.
+     * Only pairs of colliders of interacting layers are enumerated (see collision_layer_buckets).
     `*/
     class pass_all_broad_phase_collision_detector : public broad_phase_collision_detector {
-        std::vector<node*> m_subscribers;
+        collider_subscriptions m_subscribers;
+        collision_layer_buckets m_buckets; // rebuilt only when subscriptions change
+        bool m_subscriptions_changed = false;
     public:
+        ENGINE_API pass_all_broad_phase_collision_detector();
+
         void check_collisions_and_trigger_reactions() override;
         void subscribe(node* n) override;
-        void reset_subscriptions() override;
+        void unsubscribe(node* n) override;
+    protected:
+        // there is no structure to query: every subscriber's aabb is computed and tested
+        void colliders_in_aabb(const aabb& box, std::vector<node*>& out) const override;
     };
 }
 
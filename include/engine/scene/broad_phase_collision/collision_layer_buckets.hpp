@@ -0,0 +1,88 @@
+#ifndef ENGINE_SCENE_BROAD_PHASE_COLLISION_COLLISION_LAYER_BUCKETS_HPP
+#define ENGINE_SCENE_BROAD_PHASE_COLLISION_COLLISION_LAYER_BUCKETS_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <engine/scene/node/narrow_phase_collision.hpp>
+#include <engine/utils/hash.hpp>
+
+namespace engine {
+    /* groups colliders by their layers (is_layers and sees_layers masks), and precomputes which groups interact, i.e.
+     * which ones have a collider seeing the other's. Colliders of non interacting buckets can never collide, so broad
+     * phases use this to skip them before any geometric test: e.g. hundreds of static world colliders which see nothing
+     * and are seen only by the player end up in a single bucket which only interacts with the player's.
+     * Buckets are kept when the colliders are cleared, since scenes use few distinct combinations of layers.
+     */
+    class collision_layer_buckets {
+    public:
+        using bucket_index_t = std::uint32_t;
+    private:
+        struct bucket {
+            collision_layers_bitmask is_layers;
+            collision_layers_bitmask sees_layers;
+            std::vector<std::uint32_t> members; // colliders' indices, in increasing order
+        };
+
+        std::vector<bucket> m_buckets;
+        hashmap<std::pair<collision_layers_bitmask, collision_layers_bitmask>, bucket_index_t> m_bucket_of_masks;
+        std::vector<std::uint8_t> m_interacts; // m_buckets.size() * m_buckets.size() matrix, symmetric
+        std::vector<bucket_index_t> m_bucket_of_collider; // indexed by the colliders' indices
+
+        // scratch buffer for for_each_interacting_pair, kept to avoid reallocating it every time
+        using members_iterator = std::vector<std::uint32_t>::const_iterator;
+        std::vector<std::pair<members_iterator, members_iterator>> m_cursors;
+    public:
+        // the bucket of colliders with shape's layers, created (along with its row of the interaction matrix) if needed
+        bucket_index_t bucket_of(const collision_shape& shape);
+        // add the collider with the given index to its bucket; indices must be added in order, starting from 0
+        bucket_index_t add(std::uint32_t index, const collision_shape& shape);
+        // remove all colliders from their buckets, keeping the buckets themselves
+        void clear_members();
+
+        bool interact(bucket_index_t a, bucket_index_t b) const {
+            return m_interacts[a * m_buckets.size() + b]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // a, b < m_buckets.size()
+        }
+
+        // calls f(i, j) for each pair of added colliders i < j whose buckets interact, sorted by i and then by j
+        template<std::invocable<std::uint32_t, std::uint32_t> F>
+        void for_each_interacting_pair(F&& f) {
+            for(std::uint32_t i = 0; i < m_bucket_of_collider.size(); i++) {
+                const bucket_index_t i_bucket = m_bucket_of_collider[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < m_bucket_of_collider.size()
+
+                // the colliders after i in each bucket interacting with i's
+                m_cursors.clear();
+                for(bucket_index_t b = 0; b < m_buckets.size(); b++) {
+                    if(!interact(i_bucket, b))
+                        continue;
+                    const std::vector<std::uint32_t>& members = m_buckets[b].members; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // b < m_buckets.size()
+                    auto first = std::ranges::upper_bound(members, i);
+                    if(first != members.end())
+                        m_cursors.emplace_back(first, members.end());
+                }
+
+                // merge them so that j is increasing; there are usually very few buckets, so a linear search for the minimum is fine
+                while(!m_cursors.empty()) {
+                    std::size_t min_c = 0;
+                    for(std::size_t c = 1; c < m_cursors.size(); c++) {
+                        if(*m_cursors[c].first < *m_cursors[min_c].first) // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // c, min_c < m_cursors.size()
+                            min_c = c;
+                    }
+
+                    auto& [it, end] = m_cursors[min_c]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // min_c < m_cursors.size()
+                    f(i, *it);
+                    if(++it == end) {
+                        m_cursors[min_c] = m_cursors.back(); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // min_c < m_cursors.size()
+                        m_cursors.pop_back();
+                    }
+                }
+            }
+        }
+
+        std::size_t buckets_count() const { return m_buckets.size(); }
+    };
+}
+
+#endif // ENGINE_SCENE_BROAD_PHASE_COLLISION_COLLISION_LAYER_BUCKETS_HPP
@@ -0,0 +1,82 @@
+#ifndef ENGINE_SCENE_BROAD_PHASE_COLLISION_DYNAMIC_AABB_TREE_HPP
+#define ENGINE_SCENE_BROAD_PHASE_COLLISION_DYNAMIC_AABB_TREE_HPP
+
+#include <cstdint>
+#include <vector>
+#include <engine/scene/broad_phase_collision.hpp>
+#include <engine/utils/aabb.hpp>
+#include <engine/utils/hash.hpp>
+#include <engine/utils/api_macro.hpp>
+
+namespace engine {
+    /* dynamic aabb tree bpcd: a bounding volume hierarchy of "fat" aabbs (the colliders' aabbs expanded by a margin),
+     * kept across frames. A collider's leaf is only reinserted when it moves out of its fat aabb, and insertions pick
+     * the sibling with a surface area heuristic and rebalance the tree with rotations, so it stays O(log n) deep.
+     * Candidate pairs are found by querying the tree with each collider's aabb, so the cost is O(n log n + pairs)
+     * instead of O(n^2).
+     * Pairs are handed to the narrow phase in the same order as pass_all_broad_phase_collision_detector would.
+     */
+    class dynamic_aabb_tree_broad_phase_collision_detector : public broad_phase_collision_detector {
+        using index_t = std::int32_t;
+        static constexpr index_t null_index = -1;
+
+        struct tree_node {
+            aabb box; // fat aabb for leaves, union of the children's boxes for internal nodes
+            index_t parent = null_index; // for free nodes, the next free node
+            index_t child1 = null_index, child2 = null_index;
+            std::int32_t height = 0; // 0 for leaves, -1 for free nodes
+            node* n = nullptr; // only for leaves
+
+            bool is_leaf() const { return child1 == null_index; }
+        };
+
+        struct proxy {
+            index_t leaf = null_index;
+            aabb tight_box;
+            collision_layer_buckets::bucket_index_t bucket = 0;
+            std::uint32_t order = 0; // index in m_subscribers
+            bool asleep = false; // sleeping proxies keep their leaf and run no query
+        };
+
+        std::vector<tree_node> m_nodes;
+        index_t m_root = null_index;
+        index_t m_free_list = null_index;
+
+        hashmap<node*, proxy> m_proxies;
+        collision_layer_buckets m_buckets;
+        collider_subscriptions m_subscribers;
+        float m_fat_margin;
+
+        // scratch buffers, kept to avoid reallocating them every frame
+        std::vector<index_t> m_query_stack;
+        std::vector<std::pair<proxy*, proxy*>> m_pairs;
+
+        index_t allocate_node();
+        void free_node(index_t i);
+        void insert_leaf(index_t leaf);
+        void remove_leaf(index_t leaf);
+        index_t balance(index_t i);
+        void refit_ancestors(index_t i);
+        tree_node& at(index_t i) { return m_nodes[i]; } // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // indices are always valid node indices
+        const tree_node& at(index_t i) const { return m_nodes[i]; } // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // indices are always valid node indices
+        // appends to out the colliders of the leaves whose (fat) box passes overlaps(box), descending only into the nodes whose box does
+        template<typename F> void query_tree(F&& overlaps, std::vector<node*>& out) const;
+    protected:
+        void colliders_in_aabb(const aabb& box, std::vector<node*>& out) const override;
+        // descends only into the boxes the segment crosses, rather than all those overlapping its aabb
+        void colliders_along_segment(glm::vec3 from, glm::vec3 to, std::vector<node*>& out) const override;
+    public:
+        // fat_margin: how much (in world units) colliders' aabbs are expanded, i.e. how far they can move before their leaf is reinserted
+        ENGINE_API explicit dynamic_aabb_tree_broad_phase_collision_detector(float fat_margin = 0.1f);
+
+        void check_collisions_and_trigger_reactions() override;
+        void subscribe(node* n) override;
+        void unsubscribe(node* n) override;
+
+        // for profiling/debugging
+        std::int32_t height() const { return m_root == null_index ? 0 : m_nodes[m_root].height; } // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access)
+        std::size_t proxies_count() const { return m_proxies.size(); }
+    };
+}
+
+#endif // ENGINE_SCENE_BROAD_PHASE_COLLISION_DYNAMIC_AABB_TREE_HPP
@@ -0,0 +1,71 @@
+#ifndef ENGINE_SCENE_BROAD_PHASE_COLLISION_SPATIAL_HASH_GRID_HPP
+#define ENGINE_SCENE_BROAD_PHASE_COLLISION_SPATIAL_HASH_GRID_HPP
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <engine/scene/broad_phase_collision.hpp>
+#include <engine/utils/aabb.hpp>
+#include <engine/utils/api_macro.hpp>
+
+namespace engine {
+    /* spatial hash grid bpcd: space is divided in cubic cells of a fixed size and each collider is inserted in every
+     * cell its aabb touches; only colliders sharing a cell are candidate pairs. The grid is rebuilt every frame, which is
+     * cheap since it has no structure to maintain: it suits swarms of similarly sized colliders, for which trees are overkill.
+     * The cell size should be about the size of the typical collider: much smaller and colliders span many cells, much
+     * larger and cells hold many colliders. Colliders spanning more than max_cells_per_collider cells are not inserted in
+     * the grid and are instead tested against every other collider.
+     * Cells live in a flat open addressing table, and their contents in a single array sorted by cell (with a counting
+     * sort), so no per-cell allocations are ever made.
+     * Pairs are handed to the narrow phase in the same order as pass_all_broad_phase_collision_detector would.
+     */
+    class spatial_hash_grid_broad_phase_collision_detector : public broad_phase_collision_detector {
+        static constexpr std::uint32_t empty_slot = UINT32_MAX;
+
+        struct cell_slot {
+            glm::ivec3 cell;
+            std::uint32_t count = empty_slot; // empty_slot if the slot is unused; otherwise the number of colliders in the cell
+            std::uint32_t begin = 0; // index of the cell's first collider in m_cell_contents
+        };
+
+        struct collider {
+            aabb box;
+            collision_layer_buckets::bucket_index_t bucket;
+            glm::ivec3 min_cell, max_cell;
+            bool oversized; // it touches too many cells (or ones too far away) to be put in them: it is checked against all the others
+        };
+
+        float m_cell_size;
+        std::uint32_t m_max_cells_per_collider;
+
+        collider_subscriptions m_subscribers;
+        collision_layer_buckets m_buckets;
+
+        // scratch buffers, kept to avoid reallocating them every frame
+        std::vector<collider> m_colliders; // same indices as m_subscribers.nodes()
+        std::vector<cell_slot> m_slots; // the open addressing table; its size is always a power of 2
+        std::vector<std::uint32_t> m_cell_contents; // colliders' indices, grouped by cell
+        std::vector<std::uint32_t> m_oversized;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> m_pairs;
+
+        static std::uint32_t cell_hash(glm::ivec3 cell);
+        cell_slot& find_or_insert_slot(glm::ivec3 cell);
+        const cell_slot* find_slot(glm::ivec3 cell) const; // nullptr if the cell is empty
+        template<typename F> static void for_each_cell(const collider& c, F&& f);
+    protected:
+        // looks the box's cells up, unless it spans more cells than there are colliders: then it is cheaper to test them all
+        void colliders_in_aabb(const aabb& box, std::vector<node*>& out) const override;
+    public:
+        // cell_size: side of the grid's cells in world units; max_cells_per_collider: see the class' description
+        ENGINE_API explicit spatial_hash_grid_broad_phase_collision_detector(float cell_size = 1.f, std::uint32_t max_cells_per_collider = 64);
+
+        void check_collisions_and_trigger_reactions() override;
+        void subscribe(node* n) override;
+        void unsubscribe(node* n) override;
+
+        float get_cell_size() const { return m_cell_size; }
+        void set_cell_size(float cell_size);
+    };
+}
+
+#endif // ENGINE_SCENE_BROAD_PHASE_COLLISION_SPATIAL_HASH_GRID_HPP
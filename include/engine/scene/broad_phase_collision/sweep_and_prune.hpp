@@ -0,0 +1,80 @@
+#ifndef ENGINE_SCENE_BROAD_PHASE_COLLISION_SWEEP_AND_PRUNE_HPP
+#define ENGINE_SCENE_BROAD_PHASE_COLLISION_SWEEP_AND_PRUNE_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <engine/scene/broad_phase_collision.hpp>
+#include <engine/utils/aabb.hpp>
+#include <engine/utils/hash.hpp>
+#include <engine/utils/api_macro.hpp>
+
+namespace engine {
+    /* sweep and prune bpcd: for each axis keeps the colliders' aabbs' endpoints sorted, and the set of overlapping pairs.
+     * Every frame the endpoints are updated and re-sorted with an insertion sort, which is close to O(n) when colliders
+     * move little between frames; each swap of a min endpoint past a max one (or vice versa) is exactly a pair starting
+     * (or stopping) to overlap on that axis, so the pair set is updated incrementally during the sort.
+     * Works best when colliders move slowly and are spread out along some axis; many colliders piled up on all three
+     * axes make the insertion sort degrade towards O(n^2).
+     * Pairs are handed to the narrow phase in the same order as pass_all_broad_phase_collision_detector would.
+     */
+    class sweep_and_prune_broad_phase_collision_detector : public broad_phase_collision_detector {
+        using proxy_index_t = std::uint32_t;
+
+        struct endpoint {
+            float value;
+            proxy_index_t proxy : 31;
+            proxy_index_t is_max : 1;
+
+            // at equal values mins come before maxes, so that touching aabbs overlap (as in aabb::overlaps)
+            bool operator<(const endpoint& o) const { return value < o.value || (value == o.value && is_max < o.is_max); }
+        };
+
+        struct proxy {
+            node* n = nullptr; // nullptr for free proxies and for those to be removed by the next check
+            aabb box;
+            collision_layer_buckets::bucket_index_t bucket = 0;
+            std::uint32_t order = 0; // index in m_subscribers
+        };
+
+        std::vector<proxy> m_proxies;
+        std::vector<proxy_index_t> m_free_proxies;
+        std::vector<proxy_index_t> m_removed_proxies; // proxies of unsubscribed nodes whose endpoints and pairs are still to be removed
+        std::size_t m_added_proxies = 0; // since the last check
+        hashmap<node*, proxy_index_t> m_proxy_of_node;
+        std::array<std::vector<endpoint>, 3> m_endpoints;
+        hashset<std::uint64_t> m_pairs; // pairs of overlapping proxies of interacting layers, as (min index << 32 | max index)
+        collision_layer_buckets m_buckets;
+
+        collider_subscriptions m_subscribers;
+
+        // scratch buffers, kept to avoid reallocating them every frame
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> m_ordered_pairs;
+        std::vector<std::uint8_t> m_is_removed;
+
+        bool may_collide(proxy_index_t a, proxy_index_t b) const {
+            const proxy& pa = m_proxies[a]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid proxy index
+            const proxy& pb = m_proxies[b]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid proxy index
+            return m_buckets.interact(pa.bucket, pb.bucket) && pa.box.overlaps(pb.box);
+        }
+        static std::uint64_t pair_key(proxy_index_t a, proxy_index_t b) { return a < b ? (std::uint64_t(a) << 32) | b : (std::uint64_t(b) << 32) | a; }
+
+        void remove_unsubscribed_proxies();
+        void insertion_sort_axis(int axis);
+        void rebuild();
+    protected:
+        // the endpoints are not suited to queries (nor sorted, until the next check, if colliders subscribed): they scan the boxes
+        void colliders_in_aabb(const aabb& box, std::vector<node*>& out) const override;
+    public:
+        ENGINE_API sweep_and_prune_broad_phase_collision_detector();
+
+        void check_collisions_and_trigger_reactions() override;
+        void subscribe(node* n) override;
+        void unsubscribe(node* n) override;
+
+        // for profiling/debugging
+        std::size_t overlapping_pairs_count() const { return m_pairs.size(); }
+    };
+}
+
+#endif // ENGINE_SCENE_BROAD_PHASE_COLLISION_SWEEP_AND_PRUNE_HPP
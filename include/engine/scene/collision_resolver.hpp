@@ -0,0 +1,82 @@
+#ifndef ENGINE_SCENE_COLLISION_RESOLVER_HPP
+#define ENGINE_SCENE_COLLISION_RESOLVER_HPP
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <engine/utils/api_macro.hpp>
+#include <engine/utils/hash.hpp>
+#include <engine/utils/thread_pool.hpp>
+
+namespace engine {
+    class node;
+
+    /* Resolves a frame's penetrations in a batch, for the nodes which move away on collision.
+     * While reactions are triggered, each node moving away records the translation which would separate it from the other
+     * collider; solve_and_apply() then turns them into constraints (the node has to move by at least that much along its
+     * direction, relative to the other collider's mover if both move away) and solves them iteratively, with projected
+     * gauss-seidel. Each node is then moved once, by the sum of its corrections.
+     * Constraints sharing no node form independent islands, which are solved in parallel; within an island constraints
+     * are solved in the order they were recorded, so the result does not depend on the number of threads.
+     */
+    class collision_resolver {
+    public:
+        // which of the two reactions of a candidate pair a correction comes from
+        struct reaction_id {
+            std::uint32_t pair;
+            bool second;
+        };
+    private:
+        static constexpr std::uint32_t no_body = std::numeric_limits<std::uint32_t>::max();
+
+        struct correction {
+            node* mover;
+            reaction_id reaction;
+            glm::vec3 min_translation; // world space
+        };
+        struct constraint {
+            std::uint32_t body;
+            std::uint32_t partner; // no_body if the other collider does not move away
+            glm::vec3 normal; // the direction body has to move along, in world space
+            float depth;
+        };
+
+        std::vector<correction> m_corrections;
+        std::size_t m_iterations = 4;
+
+        // scratch, reused across frames
+        hashmap<node*, std::uint32_t> m_body_of;
+        std::vector<node*> m_bodies;
+        std::vector<glm::vec3> m_body_corrections;
+        std::vector<std::uint32_t> m_island_parent;
+        std::vector<constraint> m_constraints;
+        hashmap<std::uint32_t, std::uint32_t> m_island_of_root;
+        std::vector<std::uint32_t> m_island_of_constraint;
+        std::vector<std::uint32_t> m_island_begin; // m_island_constraints[m_island_begin[i], m_island_begin[i+1]) are island i's
+        std::vector<std::uint32_t> m_island_constraints;
+        std::vector<std::uint32_t> m_island_next;
+
+        std::uint32_t body_index(node* n);
+        std::uint32_t find_island(std::uint32_t body);
+        void build_constraints();
+        void build_islands();
+        void solve_island(std::size_t island);
+    public:
+        // record that mover has to move by min_translation (in world space) as a result of the reaction
+        void add_correction(node& mover, reaction_id reaction, glm::vec3 min_translation) {
+            m_corrections.push_back({ .mover = &mover, .reaction = reaction, .min_translation = min_translation });
+        }
+
+        // the number of gauss-seidel iterations (4 by default); with 1, each constraint is only handled once, in order
+        void set_iterations(std::size_t iterations) { m_iterations = iterations; }
+        std::size_t get_iterations() const { return m_iterations; }
+
+        // solve the corrections recorded since the last call (on pool, if not null), move each node once and forget them
+        ENGINE_API void solve_and_apply(thread_pool* pool);
+    };
+}
+
+#endif // ENGINE_SCENE_COLLISION_RESOLVER_HPP
@@ -0,0 +1,88 @@
+#ifndef ENGINE_SCENE_MUTATION_QUEUE_HPP
+#define ENGINE_SCENE_MUTATION_QUEUE_HPP
+
+#include <vector>
+#include <memory>
+#include <optional>
+#include <engine/scene/node.hpp>
+#include <engine/resources_manager/rc.hpp>
+#include <engine/utils/api_macro.hpp>
+
+namespace engine {
+    /* A per-frame command buffer of structural changes to a scene's node tree.
+     *
+     * Nodes cannot be safely spawned, destroyed, reparented or have their payload swapped while the scene is being updated,
+     * since the scene holds raw pointers to them (in the traversal's stack, in the broad phase collision detector, ...).
+     * Scripts record these changes here instead (through application_channel_t::mutations()), and the scene applies all
+     * of them in a batch at a defined sync point: the end of scene::update(), after collisions have been handled (or, in
+     * pipelined mode, the application's sync point on the main thread once the update is done; see scene::set_pipelined).
+     *
+     * Within a batch commands are applied grouped by kind, in this order: payload swaps, reparents, spawns, destroys;
+     * commands of the same kind are applied in the order they were recorded. This means that destroying a node always wins:
+     * anything spawned or reparented into a destroyed subtree is destroyed along with it.
+     *
+     * When deferred destruction is enabled (see application::set_pipelined) destroyed subtrees and replaced payloads are
+     * not freed by apply(), but kept alive until flush_deferred_destructions(), since the render thread may still be
+     * reading them from the previous frame's render snapshot.
+     */
+    class mutation_queue {
+        struct spawn_cmd {
+            node* father;
+            std::unique_ptr<node> n;
+        };
+        struct spawn_from_blueprint_cmd {
+            node* father;
+            rc<const nodetree_blueprint> bp;
+            std::optional<std::string> name;
+            glm::mat4 transform;
+        };
+        struct reparent_cmd {
+            node* n;
+            node* new_father;
+        };
+        struct swap_payload_cmd {
+            node* n;
+            node_payload_t payload;
+        };
+
+        std::vector<spawn_cmd> m_spawns;
+        std::vector<spawn_from_blueprint_cmd> m_blueprint_spawns;
+        std::vector<node*> m_destroys;
+        std::vector<reparent_cmd> m_reparents;
+        std::vector<swap_payload_cmd> m_payload_swaps;
+
+        bool m_defer_destruction = false;
+        std::vector<std::unique_ptr<node>> m_deferred_nodes;
+        std::vector<node_payload_t> m_deferred_payloads;
+    public:
+        mutation_queue() = default;
+        mutation_queue(const mutation_queue&) = delete;
+        mutation_queue(mutation_queue&&) = default;
+        mutation_queue& operator=(const mutation_queue&) = delete;
+        mutation_queue& operator=(mutation_queue&&) = default;
+        ~mutation_queue() = default;
+
+        // add an already constructed node (tree) as a child of father
+        ENGINE_API void spawn(node& father, std::unique_ptr<node> n);
+        // instantiate a nodetree blueprint as a child of father; the copy happens when the batch is applied, so that ecs ids can be allocated all at once
+        ENGINE_API void spawn(node& father, rc<const nodetree_blueprint> bp, std::optional<std::string> name = std::nullopt, const glm::mat4& transform = glm::mat4(1));
+        // destroy n and all its descendants; n must not be the root of the scene
+        ENGINE_API void destroy(node& n);
+        // move n (and its descendants) to be a child of new_father; its local transform is kept as is
+        ENGINE_API void reparent(node& n, node& new_father);
+        // replace n's payload
+        ENGINE_API void swap_payload(node& n, node_payload_t payload);
+
+        bool empty() const { return m_spawns.empty() && m_blueprint_spawns.empty() && m_destroys.empty() && m_reparents.empty() && m_payload_swaps.empty(); }
+
+        // apply all recorded mutations and clear the queue; called by the scene at its sync point
+        void apply();
+
+        // keep the nodes and payloads destroyed by apply() alive until flush_deferred_destructions() is called
+        void set_deferred_destruction(bool defer) { m_defer_destruction = defer; }
+        // free the nodes and payloads destroyed by apply() while deferred destruction was enabled
+        ENGINE_API void flush_deferred_destructions();
+    };
+}
+
+#endif // ENGINE_SCENE_MUTATION_QUEUE_HPP
@@ -11,6 +11,7 @@
 #include <engine/resources_manager/rc.hpp>
 #include <engine/resources_manager/weak.hpp>
 #include <engine/resources_manager.hpp>
+#include <engine/scene/collision_resolver.hpp>
 #include <engine/utils/api_macro.hpp>
 
 // TODO: split different classes in this header into separate headers
@@ -21,9 +22,24 @@ namespace engine {
         bool moves_away_on_collision : 1 = false;
         bool passes_events_to_script : 1 = false;
         bool passes_events_to_father : 1 = false;
+        // whether the node's collider may fall asleep once it keeps still (see broad_phase_collision_detector::set_sleep_frames)
+        bool can_sleep : 1 = false;
+        /* whether the node's collider is a trigger: its overlaps are not resolved, and are reported as trigger events
+         * (enter, stay, exit) instead of collision events, both to it and to the colliders it overlaps. Only whether
+         * the colliders overlap is computed, which is cheaper than a collision_result; triggers never fall asleep
+         */
+        bool is_trigger : 1 = false;
+        /* whether the node's collider is swept from where it was at the end of the last frame to where it is now, so that
+         * it cannot tunnel through thin colliders by moving past them in a single frame (see check_swept_collision): its
+         * broad phase aabb covers both places, and its pairs which do not collide at the end of the frame get a time of
+         * impact search. A collider moved with set_transform is swept along the way too. Triggers are never swept
+         */
+        bool is_continuous : 1 = false;
     };
 
     class nodetree_blueprint;
+    class script_profiler;
+    class broad_phase_collision_detector;
 
     /* A node in the scene graph.
      * TODO: better doc comment
@@ -54,8 +70,22 @@ namespace engine {
 
         std::optional<script> m_script;
 
+        // the bpcd of the scene whose tree this node is in (null if it is in none); the same for all nodes of a tree
+        broad_phase_collision_detector* m_bp_collision_detector = nullptr;
+        // set the bpcd of this node's subtree, moving the subscriptions of its colliders from the old one to the new one
+        void set_bp_collision_detector(broad_phase_collision_detector* bpcd);
+        // after the payload changed: (un)subscribe this node from its bpcd if it gained (lost) a collision shape
+        void update_collider_subscription(bool was_collider);
+        friend class scene;
+
     public:
         ENGINE_API void add_child(std::unique_ptr<node> c);
+        // add many children at once: if children are sorted the children vector is only sorted once, instead of once per child
+        ENGINE_API void add_children(std::vector<std::unique_ptr<node>> cs);
+        // detach a child from this node, handing over its ownership to the caller
+        ENGINE_API std::unique_ptr<node> remove_child(node& c);
+        // detach many children at once (scanning the children vector only once), handing over their ownership to the caller
+        ENGINE_API std::vector<std::unique_ptr<node>> remove_children(std::span<node* const> cs);
 
         /*
          * Only these chars and alphanumeric chars (std::alnum) are allowed in node names; others are automatically replaced with '_'.
@@ -138,10 +168,21 @@ namespace engine {
         const node_collision_behaviour& get_collision_behaviour() { return m_col_behaviour; }
         // set the collision behaviour: should the node move away when it receives a collision event, and/or pass the event to its script and/or to its father?
         void set_collision_behaviour(node_collision_behaviour col_behaviour) { m_col_behaviour = col_behaviour; }
+        // whether the node's collider is asleep; it wakes up by itself when moved (e.g. by set_transform) or hit
+        ENGINE_API bool is_sleeping() const;
+        // wake up the node's collider, along with its island, e.g. after changing something its collisions depend on
+        ENGINE_API void wake_up();
+        // the collision detector of the scene whose tree the node is in (null if it is in none), e.g. for its spatial queries
+        const broad_phase_collision_detector* get_bp_collision_detector() const { return m_bp_collision_detector; }
 
 
-        // handle collision event, recursing up the node tree if necessary
-        void react_to_collision(collision_result res, node& other);
+        /* handle collision event, recursing up the node tree if necessary; script calls are timed by profiler if it is not null.
+         * Nodes moving away on collision are moved right away, unless resolver is not null: then their corrections are recorded
+         * in it (as coming from reaction), to be solved along with the rest of the frame's.
+         */
+        void react_to_collision(collision_result res, node& other, script_profiler* profiler = nullptr, collision_resolver* resolver = nullptr, collision_resolver::reaction_id reaction = {});
+        // handle trigger event, recursing up the node tree if necessary like react_to_collision; nodes are never moved
+        void react_to_trigger(trigger_event event, node& other, script_profiler* profiler = nullptr);
 
         //script
         // instantiates a script and attaches it to a node; params are for the script's constructor
@@ -157,21 +198,31 @@ namespace engine {
         // special node data access
         template<NodePayload T> bool     has() const { return std::holds_alternative<T>(m_payload); }
         template<NodePayload T> const T& get() const { EXPECTS(has<T>()); return std::get<T>(m_payload); }
-        template<NodePayload T> T&       get()       { EXPECTS(has<T>()); return std::get<T>(m_payload); }
+        template<NodePayload T> T&       get()       {
+            EXPECTS(has<T>());
+            if constexpr(std::same_as<T, mesh> || std::same_as<T, viewport>)
+                EXPECTS(!render_payloads_read_only());
+            return std::get<T>(m_payload);
+        }
 
         //allow has<collision_shape> instead of has<rc<collision_shape>>
         template<Resource T> requires NodePayload<rc<const T>> bool     has() const { return has<rc<const collision_shape>>(); }
         template<Resource T> requires NodePayload<rc<const T>> const T& get() const { return *get<rc<const collision_shape>>(); }
 
-        void set_payload(node_payload_t p) {
-            m_payload = std::move(p);
-        }
+        ENGINE_API void set_payload(node_payload_t p);
         //separate logic for rc<collision_shape>
-        void set_payload(rc<collision_shape> p) {
-            m_payload = std::move(p);
-        }
+        ENGINE_API void set_payload(rc<collision_shape> p);
+        // replace the payload, returning the previous one
+        [[nodiscard]] ENGINE_API node_payload_t exchange_payload(node_payload_t p);
+
+        /* Whether meshes and viewports are read-only on the calling thread: set by the application on its update thread
+         * in pipelined mode, while the main thread renders from them; getting them mutably from a node, or replacing
+         * them, then fails a precondition check.
+         */
+        ENGINE_API static void set_render_payloads_read_only(bool read_only);
+        ENGINE_API static bool render_payloads_read_only();
 
-        ecs_id_t ecs_id() { return m_ecs_id; }
+        ecs_id_t ecs_id() const { return m_ecs_id; }
     };
 
     class node_exception : public std::exception {
@@ -0,0 +1,56 @@
+#ifndef ENGINE_SCENE_NODE_COLLISION_SHAPE_CACHE_HPP
+#define ENGINE_SCENE_NODE_COLLISION_SHAPE_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <engine/scene/node/narrow_phase_collision.hpp>
+#include <engine/utils/api_macro.hpp>
+#include <engine/utils/hash.hpp>
+#include <engine/utils/mapped_file.hpp>
+
+namespace engine {
+    /* Cooked collision shapes: the shapes built from an asset's collision meshes, serialized in a cache file next to it,
+     * so that loading the asset again only copies them out of the (memory mapped) file instead of building them.
+     * Each entry is keyed by a hash of what its shapes are built from (see make_key): a stale entry is never found, and is
+     * dropped the next time the file is saved. The file is native-endian, meant to be rebuilt on each machine rather than
+     * shipped; a file which is truncated, of another format or of another endianness is ignored as a whole.
+     */
+    class collision_shape_cache {
+        std::string m_path;
+        std::optional<mapped_file> m_file;
+        hashmap<std::uint64_t, std::span<const std::byte>> m_entries; // each entry's bytes in m_file
+        // the entries to save: the ones found (whose bytes stay in m_file until save copies them) or inserted since the
+        // cache was opened
+        hashset<std::uint64_t> m_found;
+        hashmap<std::uint64_t, std::vector<std::byte>> m_inserted;
+
+        // maps the file at m_path and indexes its entries, if it exists and is a valid cache
+        void open();
+    public:
+        // bump whenever the collision_shape factories (or the serialized fields) change, so that old entries are not found
+        static constexpr std::uint64_t builder_version = 2;
+
+        // opens the cache at path, if it exists; a cache which does not exist (yet) is empty
+        ENGINE_API explicit collision_shape_cache(std::string path);
+
+        // the key for the shapes built from sources (e.g. a mesh's buffers and the build options' bytes); stable across runs
+        ENGINE_API static std::uint64_t make_key(std::initializer_list<std::span<const std::byte>> sources);
+
+        // the shapes cooked with key, if the cache has them
+        ENGINE_API std::optional<std::vector<collision_shape>> find(std::uint64_t key);
+        ENGINE_API void insert(std::uint64_t key, std::span<const collision_shape> shapes);
+
+        // if anything was inserted, writes the file again with the entries found or inserted since it was opened (so that
+        // stale ones are dropped), and opens it again, with all of its entries counting as found; returns false if it
+        // could not be written, keeping the old file and what was to be saved
+        ENGINE_API bool save();
+    };
+}
+
+#endif // ENGINE_SCENE_NODE_COLLISION_SHAPE_CACHE_HPP
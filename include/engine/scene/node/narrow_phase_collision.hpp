@@ -3,9 +3,14 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <optional>
+#include <variant>
 #include <vector>
 
 #include <engine/utils/stride_span.hpp>
+#include <engine/utils/aabb.hpp>
+#include <engine/utils/packed_polytope.hpp>
+#include <engine/utils/convex_hull.hpp>
 #include <engine/utils/api_macro.hpp>
 
 namespace engine {
@@ -15,23 +20,69 @@ namespace engine {
     // layers go from 0 to 63
     ENGINE_API collision_layers_bitmask collision_layer(int n);
 
-    //TODO: make collision_shape an abstract class from which others inherit: (mesh|ray|sphere)_collision_shape; we probably want GJK for this
+    // analytic shapes, centered on center (in the shape's space); check_collision has closed form tests for sphere-sphere,
+    // sphere-box and capsule-capsule, and uses gjk and epa for the other pairs involving a sphere or a capsule
+    struct sphere_primitive {
+        float radius;
+        glm::vec3 center = glm::vec3(0);
+    };
+    // the points within radius of the segment from center - (0, half_height, 0) to center + (0, half_height, 0)
+    struct capsule_primitive {
+        float radius;
+        float half_height;
+        glm::vec3 center = glm::vec3(0);
+    };
+    struct box_primitive {
+        glm::vec3 half_extents;
+        glm::vec3 center = glm::vec3(0);
+    };
+    // monostate: the shape is the convex polytope described by its polytope's vertices, face normals and edges (from_mesh or a hull)
+    using collision_primitive = std::variant<std::monostate, sphere_primitive, capsule_primitive, box_primitive>;
+
     struct collision_shape {
-        std::vector<glm::vec3> verts;
-        std::vector<glm::vec3> face_normals;
-        std::vector<glm::vec3> edges;
+        collision_primitive primitive;
+
+        // the vertices, face normals (with the extents of the vertices' projections on them, precomputed so that
+        // check_collision only needs to project the other shape on these axes) and edge directions, quantized and laid out
+        // for check_collision's simd projections. Empty for spheres and capsules; a box's are its corners, face normals and
+        // edge directions, so that it can be tested against polytopes with sat like them
+        packed_polytope polytope;
+        // bounding volumes, in the shape's space; used by check_collision to reject far apart pairs early
+        aabb local_aabb;
+        glm::vec3 bounding_sphere_center = glm::vec3(0);
+        float bounding_sphere_radius = 0.f;
+
         //the correctness of layers in a collision is NOT checked by collision_shape;
         collision_layers_bitmask is_layers = 0;
         collision_layers_bitmask sees_layers = 0;
 
         ENGINE_API static collision_shape from_mesh(stride_span<const glm::vec3> mesh_verts, std::span<const glm::uvec3> mesh_indices, collision_layers_bitmask is_layer, collision_layers_bitmask sees_layers);
         ENGINE_API static collision_shape from_mesh(stride_span<const glm::vec3> mesh_verts, std::span<const glm::u16vec3> mesh_indices, collision_layers_bitmask is_layer, collision_layers_bitmask sees_layers);
+
+        // the shape of the mesh's convex hull: it only has the hull's vertices, face normals and the edges between its faces,
+        // so check_collision tests far fewer axes than with from_mesh, which keeps every triangle's; flat meshes have no
+        // hull, and fall back to from_mesh
+        ENGINE_API static collision_shape from_mesh_convex_hull(stride_span<const glm::vec3> mesh_verts, std::span<const glm::uvec3> mesh_indices, collision_layers_bitmask is_layer, collision_layers_bitmask sees_layers, const convex_hull_options& options = {});
+        ENGINE_API static collision_shape from_mesh_convex_hull(stride_span<const glm::vec3> mesh_verts, std::span<const glm::u16vec3> mesh_indices, collision_layers_bitmask is_layer, collision_layers_bitmask sees_layers, const convex_hull_options& options = {});
+        // for concave meshes: one hull shape per part of the mesh's approximate convex decomposition (see convex_decomposition)
+        ENGINE_API static std::vector<collision_shape> from_mesh_convex_decomposition(stride_span<const glm::vec3> mesh_verts, std::span<const glm::uvec3> mesh_indices, collision_layers_bitmask is_layer, collision_layers_bitmask sees_layers, const convex_decomposition_options& options = {});
+        ENGINE_API static std::vector<collision_shape> from_mesh_convex_decomposition(stride_span<const glm::vec3> mesh_verts, std::span<const glm::u16vec3> mesh_indices, collision_layers_bitmask is_layer, collision_layers_bitmask sees_layers, const convex_decomposition_options& options = {});
+
+        ENGINE_API static collision_shape sphere(sphere_primitive s, collision_layers_bitmask is_layer, collision_layers_bitmask sees_layers);
+        ENGINE_API static collision_shape capsule(capsule_primitive c, collision_layers_bitmask is_layer, collision_layers_bitmask sees_layers);
+        ENGINE_API static collision_shape box(box_primitive b, collision_layers_bitmask is_layer, collision_layers_bitmask sees_layers);
+
+        // the tightest aabb of the shape after applying transform to it
+        ENGINE_API aabb world_aabb(const glm::mat4& transform) const;
     };
 
 
     struct collision_result {
         glm::vec3 versor;
         float depth;
+        // in [0, 1]: when the colliders first touched, as a fraction of their motion since the last frame; 1 (the end of the
+        // motion, i.e. the transforms they were tested at) except for the results of check_swept_collision
+        float time_of_impact = 1.f;
 
         static collision_result null();
 
@@ -42,11 +93,57 @@ namespace engine {
         // true if any collision occurred, even if shallow
         operator bool() const;
 
-        collision_result inverse() const { return collision_result { .versor = -versor, .depth = depth }; }
+        collision_result inverse() const { return collision_result { .versor = -versor, .depth = depth, .time_of_impact = time_of_impact }; }
         collision_result operator-() const { return inverse(); }
     };
 
-    collision_result check_collision(const collision_shape& a, glm::mat4 a_trans, const collision_shape& b, glm::mat4 b_trans);
+    ENGINE_API collision_result check_collision(const collision_shape& a, const glm::mat4& a_trans, const collision_shape& b, const glm::mat4& b_trans);
+
+    // what check_collision remembers of a pair of polytopes from one call to the next, to speed up the next
+    struct collision_axis_hint {
+        // in a's space: the axis which separated the shapes last time, or along which they overlapped the least
+        glm::vec3 axis = glm::vec3(0);
+        // set by check_collision: whether axis alone proved the shapes apart, before any of sat's own axes were tested
+        bool separated_early = false;
+    };
+    // the same as above, but tests hint.axis first (if any), and updates hint; pairs involving a sphere or a capsule ignore it
+    ENGINE_API collision_result check_collision(const collision_shape& a, const glm::mat4& a_trans, const collision_shape& b, const glm::mat4& b_trans, collision_axis_hint& hint);
+
+    /* whether the shapes overlap (touching included), without computing by how much: for triggers. Gjk stops as soon as
+     * it proves the shapes overlap or apart, instead of looking for the least penetration like sat and epa. Like the above,
+     * pairs of polytopes test hint.axis first and update it (with gjk's separating direction).
+     */
+    ENGINE_API bool check_overlap(const collision_shape& a, const glm::mat4& a_trans, const collision_shape& b, const glm::mat4& b_trans, collision_axis_hint& hint);
+
+    /* Continuous collision detection, for colliders which move farther in a frame than they (or what they may hit) are
+     * thick: the first contact of a and b while their transforms move from *_from to *_to, found by conservative
+     * advancement. The transforms are interpolated linearly, which is exact for translations and close enough for the
+     * rotations of a frame; since each interpolated transform is affine, the swept shapes stay convex and gjk handles them.
+     * Null if they do not touch during the motion, if they already overlap at its start (check_collision handles that), or
+     * if they only graze each other. Otherwise versor is the contact normal (from a to b) at time_of_impact, and depth is
+     * how far a (at a_to) has to move against it to be back where it touched b: the min translation undoes the tunneling.
+     */
+    ENGINE_API collision_result check_swept_collision(const collision_shape& a, const glm::mat4& a_from, const glm::mat4& a_to, const collision_shape& b, const glm::mat4& b_from, const glm::mat4& b_to);
+
+    struct collision_distance_result {
+        float distance;
+        // the closest points of a and b, in world space
+        glm::vec3 a_point;
+        glm::vec3 b_point;
+    };
+    // gjk distance query; nullopt if the shapes intersect
+    ENGINE_API std::optional<collision_distance_result> collision_distance(const collision_shape& a, const glm::mat4& a_trans, const collision_shape& b, const glm::mat4& b_trans);
+
+    struct ray_hit {
+        float distance; // the ray's parameter where it enters the shape, i.e. in units of its direction's length
+        // where the ray enters the shape, its outward normal (normalized, in world space); -direction (normalized) if the ray starts inside it
+        glm::vec3 normal;
+    };
+    /* where the ray origin + t * direction, for t in [0, max_distance], first enters the shape; nullopt if it misses it.
+     * Polytopes are hit as the intersection of the slabs between their faces, i.e. as their convex hull for shapes made
+     * from convex meshes or hulls; rays starting inside a shape hit it at 0.
+     */
+    ENGINE_API std::optional<ray_hit> check_ray(const collision_shape& shape, const glm::mat4& trans, glm::vec3 origin, glm::vec3 direction, float max_distance);
 }
 
 #endif // ENGINE_SCENE_NODE_NARROW_PHASE_COLLISION_HPP
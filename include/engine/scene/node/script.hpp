@@ -2,25 +2,53 @@
 #define ENGINE_SCENE_NODE_SCRIPT_HPP
 
 #include <any>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <vector>
 #include <engine/resources_manager/rc.hpp>
 #include <engine/utils/api_macro.hpp>
+#include <engine/utils/hash.hpp>
 
 namespace engine {
     class node;
     class application_channel_t;
     class collision_result;
 
+    // the events of a pair of colliders overlapping while one of them is a trigger (see node_collision_behaviour::is_trigger)
+    enum class trigger_event : std::uint8_t {
+        enter, // they started overlapping this frame
+        stay, // they overlapped last frame too
+        exit, // they overlapped last frame but not anymore (or stopped being candidates for collision, or the other one was unsubscribed)
+    };
+
     struct script_vtable {
         using construct_fn_t = std::any (node&, const std::any&);
         using process_fn_t = void (node&, std::any&, application_channel_t&);
         // NOTE: react_to_collision takes "const node"s because it should not move or delete any nodes, since it gets called after subscribing "node*"s to the bp collision detector
         using react_to_collision_fn_t = void (const node&, std::any&, collision_result, const node& event_src, const node& other);
+        using react_to_trigger_fn_t = void (const node&, std::any&, trigger_event, const node& event_src, const node& other);
 
         construct_fn_t* construct = [](node&, const std::any& construction_args) { return std::any(std::monostate()); };
         process_fn_t* process = [](node&, std::any&, application_channel_t&) {};
         // NOTE: react_to_collision takes "const node&"s because it should not move or delete any nodes, since it gets called after subscribing "node*"s to the bp collision detector
         std::optional<react_to_collision_fn_t*> react_to_collision = std::nullopt;
+        // scripts without it ignore trigger events; it takes "const node&"s for the same reason as react_to_collision
+        std::optional<react_to_trigger_fn_t*> react_to_trigger = std::nullopt;
+    };
+
+    // name -> vtable of every script exported by a dynamic library; see resources_manager::get_script_index
+    struct script_index {
+        // transparent, so that names are looked up as std::string_view without building a std::string
+        struct name_hash {
+            using is_transparent = void;
+            using is_avalanching = void;
+            std::uint64_t operator()(std::string_view name) const noexcept { return ankerl::unordered_dense::hash<std::string_view>()(name); }
+        };
+
+        ankerl::unordered_dense::map<std::string, script_vtable, name_hash, std::equal_to<>> scripts;
     };
 
     struct stateless_script {
@@ -30,7 +58,8 @@ namespace engine {
         nullable_rc<const dylib::library> dynlib_ref = nullptr;
 
         ENGINE_API static std::vector<std::pair<const char*, stateless_script>> from(rc<const dylib::library> dynlib);
-        ENGINE_API static stateless_script from(rc<const dylib::library> dynlib, const char* name);
+        // looks name up in the library's script index, which is built the first time a script is requested from it
+        ENGINE_API static stateless_script from(rc<const dylib::library> dynlib, std::string_view name);
     };
 
     class script {
@@ -52,6 +81,8 @@ namespace engine {
 
         ENGINE_API void process(node& n, application_channel_t& app_chan);
         ENGINE_API void react_to_collision(const node& self, collision_result res, const node& event_src, const node& other);
+        // does nothing if the script has no react_to_trigger
+        ENGINE_API void react_to_trigger(const node& self, trigger_event event, const node& event_src, const node& other);
     };
 }
 
@@ -0,0 +1,47 @@
+#ifndef ENGINE_SCENE_RENDER_SNAPSHOT_HPP
+#define ENGINE_SCENE_RENDER_SNAPSHOT_HPP
+
+#include <variant>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace engine {
+    class mesh;
+    class viewport;
+
+    /* An immutable description of a frame, extracted from the node tree by scene::extract_render_snapshot and submitted
+     * to the GPU by scene::submit_render_snapshot.
+     *
+     * Submitting a snapshot does not read the node tree or the ecs (all transforms and camera matrices are copied into it),
+     * so it can happen on the GL thread while the next frame's update runs on another one; the meshes and viewports it
+     * points to must however be kept alive until it has been submitted (see mutation_queue::set_deferred_destruction),
+     * and left unmodified meanwhile (see node::set_render_payloads_read_only).
+     */
+    struct render_snapshot {
+        // render the descendants of a viewport node to it, from the point of view of the given camera
+        struct begin_viewport {
+            const viewport* vp;
+            glm::mat4 view;
+        };
+        // go back to rendering to the enclosing viewport (or the default framebuffer)
+        struct end_viewport {};
+        struct draw_mesh {
+            const mesh* m;
+            glm::mat4 model;
+        };
+        using command_t = std::variant<begin_viewport, end_viewport, draw_mesh>;
+
+        // in the same order as the pre+post-order traversal of the node tree
+        std::vector<command_t> commands;
+        // view matrix of the camera rendering to the default framebuffer
+        glm::mat4 default_view = glm::mat4(1);
+        glm::vec4 clear_color = {0,0,0,0};
+        glm::ivec2 resolution = {0,0};
+        float frame_time = 0.f;
+
+        // empty the snapshot, keeping its allocations
+        void clear() { commands.clear(); }
+    };
+}
+
+#endif // ENGINE_SCENE_RENDER_SNAPSHOT_HPP
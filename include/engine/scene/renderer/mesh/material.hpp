@@ -28,13 +28,17 @@ namespace engine {
         //must be the same size as m_shader.uniforms.sampler_names
         std::vector<rc<const gal::texture>> m_textures;
         std::vector<std::pair<std::string, uniform_value_variant>> m_custom_uniforms;
+        // loaded when the shader is set (if it uses it), so that binding the material does not need to access the resources_manager
+        nullable_rc<const gal::texture> m_dither_texture;
+
+        void load_dither_texture_if_needed();
     public:
         material() = delete;
 
         ENGINE_API material(rc<const shader> shader, std::vector<rc<const gal::texture>> textures);
         ENGINE_API material(rc<const shader> shader, rc<const gal::texture> texture);
 
-        void set_shader(rc<const engine::shader> s) { m_shader = std::move(s);}
+        ENGINE_API void set_shader(rc<const engine::shader> s);
         const rc<const engine::shader>& get_shader() const { return m_shader; }
         const std::vector<rc<const gal::texture>>& get_textures() const { return m_textures; }
         rc<const gal::texture>& get_texture(size_t i) { EXPECTS(i < m_textures.size()); return m_textures[i]; } // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access)
@@ -0,0 +1,94 @@
+#ifndef ENGINE_SCENE_SCRIPT_PROFILER_HPP
+#define ENGINE_SCENE_SCRIPT_PROFILER_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <string>
+#include <engine/scene/node/script.hpp>
+#include <engine/utils/hash.hpp>
+#include <engine/utils/api_macro.hpp>
+
+namespace engine {
+    /* Per-script CPU time accounting, keyed by stateless_script::name.
+     *
+     * The scene wraps every call to script::process and script::react_to_collision (and react_to_trigger, which is
+     * accounted as react_to_collision) in measure(); when the profiler is
+     * disabled measure() simply forwards the call, so the only overhead is a branch. When it is enabled each call costs
+     * two clock reads and a hashmap lookup.
+     * Statistics are accumulated during a frame and published by end_frame(), which also pushes the frame's total time
+     * for each script into a rolling history.
+     */
+    class script_profiler {
+    public:
+        using clock = std::chrono::steady_clock;
+        static constexpr std::size_t history_size = 120;
+
+        struct call_stats {
+            std::uint32_t calls = 0;
+            clock::duration total = clock::duration::zero();
+            clock::duration max = clock::duration::zero();
+
+            void add_sample(clock::duration d) {
+                calls++;
+                total += d;
+                max = std::max(max, d);
+            }
+        };
+
+        struct script_stats {
+            // stats of the last completed frame
+            call_stats process, react_to_collision;
+            // total time (process + react_to_collision) spent in this script in each of the last history_size frames, in milliseconds; history[history_head] is the oldest frame
+            std::array<float, history_size> history{};
+            std::size_t history_head = 0;
+        };
+
+        enum class call_kind : std::uint8_t { process, react_to_collision };
+    private:
+        struct accumulator {
+            call_stats process, react_to_collision;
+        };
+
+        bool m_enabled = false;
+        hashmap<std::string, accumulator> m_current_frame;
+        hashmap<std::string, script_stats> m_stats;
+
+        ENGINE_API void add_sample(const std::string& script_name, call_kind kind, clock::duration d);
+    public:
+        script_profiler() = default;
+        script_profiler(const script_profiler&) = delete;
+        script_profiler(script_profiler&&) = default;
+        script_profiler& operator=(const script_profiler&) = delete;
+        script_profiler& operator=(script_profiler&&) = default;
+        ~script_profiler() = default;
+
+        bool is_enabled() const { return m_enabled; }
+        // enabling or disabling the profiler does not discard the collected stats; use clear() for that
+        void set_enabled(bool enabled) { m_enabled = enabled; }
+        ENGINE_API void clear();
+
+        // call f(), timing it and attributing the time to s if the profiler is enabled
+        template<typename F>
+        void measure(const stateless_script& s, call_kind kind, F&& f) {
+            if(!m_enabled) {
+                std::forward<F>(f)();
+                return;
+            }
+
+            clock::time_point start = clock::now();
+            std::forward<F>(f)();
+            add_sample(s.name, kind, clock::now() - start);
+        }
+
+        // publish the samples collected since the last call, advancing the rolling history by one frame
+        ENGINE_API void end_frame();
+
+        const hashmap<std::string, script_stats>& stats() const { return m_stats; }
+
+        // draw an ImGui window showing the collected stats; must be called between ImGui::NewFrame() and ImGui::Render()
+        ENGINE_API void draw_imgui_window(bool* p_open = nullptr);
+    };
+}
+
+#endif // ENGINE_SCENE_SCRIPT_PROFILER_HPP
@@ -0,0 +1,73 @@
+#ifndef ENGINE_SCENE_SPATIAL_QUERY_HPP
+#define ENGINE_SCENE_SPATIAL_QUERY_HPP
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <variant>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <engine/scene/node/narrow_phase_collision.hpp>
+#include <engine/utils/aabb.hpp>
+
+namespace engine {
+    class node;
+
+    // the queries answered by broad_phase_collision_detector; each only finds the colliders which are one of its layers
+    constexpr collision_layers_bitmask all_collision_layers = std::numeric_limits<collision_layers_bitmask>::max();
+
+    // the first collider hit by the ray origin + t * direction, for t in [0, max_distance]
+    struct raycast_query {
+        glm::vec3 origin;
+        glm::vec3 direction; // not necessarily normalized: distances are in units of its length
+        float max_distance;
+        collision_layers_bitmask layers = all_collision_layers;
+    };
+    // the colliders overlapping the sphere
+    struct sphere_overlap_query {
+        glm::vec3 center;
+        float radius;
+        collision_layers_bitmask layers = all_collision_layers;
+    };
+    // the colliders overlapping the box
+    struct aabb_overlap_query {
+        aabb box;
+        collision_layers_bitmask layers = all_collision_layers;
+    };
+    // the (at most) k colliders closest to point, within max_distance of it, closest first
+    struct k_nearest_query {
+        glm::vec3 point;
+        std::size_t k;
+        float max_distance;
+        collision_layers_bitmask layers = all_collision_layers;
+    };
+    using spatial_query = std::variant<raycast_query, sphere_overlap_query, aabb_overlap_query, k_nearest_query>;
+
+    struct spatial_query_hit {
+        node* collider;
+        // raycasts: where the ray hits the collider; k_nearest: the collider's closest point and its distance (0 if
+        // point is inside it); overlaps: both 0
+        float distance = 0.f;
+        glm::vec3 point = glm::vec3(0);
+        // raycasts only: the collider's outward normal where the ray enters it (see check_ray)
+        glm::vec3 normal = glm::vec3(0);
+    };
+
+    // the answers of a batch of spatial queries: all the hits, grouped by query
+    class spatial_query_results {
+        std::vector<spatial_query_hit> m_hits;
+        std::vector<std::uint32_t> m_begin; // query i's hits are m_hits[m_begin[i], m_begin[i+1])
+
+        friend class broad_phase_collision_detector;
+    public:
+        std::size_t size() const { return m_begin.empty() ? 0 : m_begin.size() - 1; }
+        // query i's hits: at most one for raycasts, the closest first for k_nearest, in no particular order for overlaps
+        std::span<const spatial_query_hit> operator[](std::size_t i) const {
+            return std::span(m_hits).subspan(m_begin[i], m_begin[i + 1] - m_begin[i]); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < size()
+        }
+    };
+}
+
+#endif // ENGINE_SCENE_SPATIAL_QUERY_HPP
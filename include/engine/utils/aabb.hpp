@@ -0,0 +1,58 @@
+#ifndef ENGINE_UTILS_AABB_HPP
+#define ENGINE_UTILS_AABB_HPP
+
+#include <limits>
+#include <span>
+#include <glm/glm.hpp>
+
+namespace engine {
+    // axis aligned bounding box
+    struct aabb {
+        glm::vec3 min = glm::vec3(std::numeric_limits<float>::infinity());
+        glm::vec3 max = glm::vec3(-std::numeric_limits<float>::infinity());
+
+        // an empty aabb contains nothing and overlaps nothing; merging anything with it yields the other operand
+        static aabb empty() { return {}; }
+
+        // the aabb of a set of points after applying transform to them
+        static aabb from_points(std::span<const glm::vec3> points, const glm::mat4& transform) {
+            aabb ret;
+            for(const glm::vec3& p : points) {
+                glm::vec3 tp = glm::vec3(transform * glm::vec4(p, 1));
+                ret.min = glm::min(ret.min, tp);
+                ret.max = glm::max(ret.max, tp);
+            }
+            return ret;
+        }
+
+        bool is_empty() const { return glm::any(glm::greaterThan(min, max)); }
+
+        bool overlaps(const aabb& o) const {
+            return glm::all(glm::lessThanEqual(min, o.max)) && glm::all(glm::lessThanEqual(o.min, max));
+        }
+        bool contains(const aabb& o) const {
+            return glm::all(glm::lessThanEqual(min, o.min)) && glm::all(glm::lessThanEqual(o.max, max));
+        }
+
+        aabb merge(const aabb& o) const { return { .min = glm::min(min, o.min), .max = glm::max(max, o.max) }; }
+        // the aabb of this box after applying transform to it; cheaper than transforming its 8 corners
+        aabb transform(const glm::mat4& transform) const {
+            if(is_empty())
+                return {};
+            const glm::vec3 center = glm::vec3(transform * glm::vec4((min + max) * .5f, 1));
+            const glm::mat3 abs_linear = glm::mat3(glm::abs(transform[0]), glm::abs(transform[1]), glm::abs(transform[2]));
+            const glm::vec3 half_extent = abs_linear * ((max - min) * .5f);
+            return { .min = center - half_extent, .max = center + half_extent };
+        }
+        aabb expand(float margin) const { return { .min = min - margin, .max = max + margin }; }
+
+        glm::vec3 extent() const { return max - min; }
+        // surface area; used as the cost heuristic when building bounding volume hierarchies
+        float area() const {
+            glm::vec3 e = extent();
+            return 2.f * (e.x * e.y + e.y * e.z + e.z * e.x);
+        }
+    };
+}
+
+#endif // ENGINE_UTILS_AABB_HPP
@@ -0,0 +1,51 @@
+#ifndef ENGINE_UTILS_CONVEX_HULL_HPP
+#define ENGINE_UTILS_CONVEX_HULL_HPP
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+#include <engine/utils/api_macro.hpp>
+
+namespace engine {
+    struct convex_hull_options {
+        // the hull stops growing once it has this many vertices (0: no limit); quickhull adds the farthest points first,
+        // so a limited hull is the best approximation (from the inside) quickhull finds along the way
+        std::uint32_t max_verts = 0;
+        // likewise for the hull's triangles, which are never fewer than its merged faces (0: no limit)
+        std::uint32_t max_faces = 0;
+        // adjacent triangles are merged into a face if the cosine of their angle is at least 1 - coplanar_tolerance and
+        // their vertices are closer than coplanar_tolerance * the points' extent to the face's plane
+        float coplanar_tolerance = 1e-3f;
+    };
+
+    struct convex_hull {
+        std::vector<glm::vec3> verts;
+        std::vector<glm::uvec3> triangles; // counterclockwise seen from outside
+        // the hull's faces, i.e. sets of adjacent coplanar triangles
+        std::vector<glm::vec3> face_normals;
+        std::vector<std::uint32_t> face_of_triangle; // same indices as triangles
+        // the edges between faces; the ones between triangles of the same face are left out
+        std::vector<glm::uvec2> edges;
+    };
+
+    // quickhull; returns nullopt if the points are fewer than 4 or (almost) coplanar, since then they have no hull with a volume
+    ENGINE_API std::optional<convex_hull> quickhull(std::span<const glm::vec3> points, const convex_hull_options& options = {});
+
+    struct convex_decomposition_options {
+        std::uint32_t max_hulls = 16;
+        // relative to the mesh's extent: parts are split until their surface is nowhere farther than this from their hull
+        float max_concavity = .05f;
+        convex_hull_options hull;
+    };
+
+    /* Approximate convex decomposition of a (possibly concave) triangle mesh, wound counterclockwise seen from outside:
+     * the part whose surface is farthest from its hull (measured along the surface's normals) is clipped in two along its
+     * longest axis, through its farthest point, until every part is convex enough or there are max_hulls of them.
+     * Returns the parts' hulls, or nothing if the whole mesh is degenerate (see quickhull).
+     */
+    ENGINE_API std::vector<convex_hull> convex_decomposition(std::span<const glm::vec3> verts, std::span<const glm::uvec3> triangles, const convex_decomposition_options& options = {});
+}
+
+#endif // ENGINE_UTILS_CONVEX_HULL_HPP
@@ -12,6 +12,9 @@ namespace engine {
     };
 
     glm::mat4 to_rotation_mat(const glm::mat4& m);
+    // interpolate between two affine transforms, decomposing them into translation, rotation and scale (shear is not preserved):
+    // translations and scales are lerped and rotations slerped; t=0 returns a and t=1 returns b
+    glm::mat4 interpolate_transforms(const glm::mat4& a, const glm::mat4& b, float t);
     inline glm::vec3 extract_position(const glm::mat4& m) {
         //NOLINTBEGIN(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access)
         return glm::vec3(m[3]);
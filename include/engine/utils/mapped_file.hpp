@@ -0,0 +1,36 @@
+#ifndef ENGINE_UTILS_MAPPED_FILE_HPP
+#define ENGINE_UTILS_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <engine/utils/api_macro.hpp>
+
+namespace engine {
+    // a whole file, mapped read-only in memory; the mapping lives as long as the object
+    class mapped_file {
+        const std::byte* m_data = nullptr;
+        std::size_t m_size = 0;
+#ifdef _WIN32
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#endif
+
+        mapped_file() = default;
+        void unmap();
+    public:
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+        ENGINE_API mapped_file(mapped_file&& o) noexcept;
+        ENGINE_API mapped_file& operator=(mapped_file&& o) noexcept;
+        ENGINE_API ~mapped_file();
+
+        // nullopt if the file does not exist or cannot be mapped
+        ENGINE_API static std::optional<mapped_file> open(const std::string& path);
+
+        std::span<const std::byte> bytes() const { return { m_data, m_size }; }
+    };
+}
+
+#endif // ENGINE_UTILS_MAPPED_FILE_HPP
@@ -0,0 +1,80 @@
+#ifndef ENGINE_UTILS_PACKED_POLYTOPE_HPP
+#define ENGINE_UTILS_PACKED_POLYTOPE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+#include <engine/utils/soa_points.hpp>
+#include <engine/utils/api_macro.hpp>
+
+namespace engine {
+    /* A convex polytope as sat needs it (vertices, face normals with the extents of the vertices' projections on them, and
+     * edge directions), compressed in a single allocation:
+     * - vertices are quantized to 16 bits per coordinate, relative to their aabb, and stored as a structure of arrays
+     *   padded like soa_points', so that project() decodes them on the fly in its simd loop. The step is a power of two
+     *   (at most 1/16384 of the aabb's half extent along each axis), so that vertices on a coarser grid, like most boxes'
+     *   corners, are exact, and others are off by at most half a step; everything else (extents, aabb, bounding sphere)
+     *   is computed from the quantized vertices, so the polytope is consistent with itself;
+     * - face normals and edges are unit directions, octahedral-encoded as pairs of 16 bit integers (exact for the
+     *   coordinate axes, within about 5e-5 radians otherwise);
+     * - the extents are the only floats.
+     * That is 6 bytes per vertex, 12 per face and 4 per edge, instead of 24 (vertices plus their soa copy), 20 and 12.
+     */
+    class packed_polytope {
+        std::vector<std::int16_t> m_data;
+        std::uint32_t m_vert_count = 0, m_face_count = 0, m_edge_count = 0;
+        // a vertex is m_center + m_step * its quantized coordinates; each of m_step's components is a power of two (or 0)
+        glm::vec3 m_center = glm::vec3(0);
+        glm::vec3 m_step = glm::vec3(0);
+
+        std::size_t padded_vert_count() const { return (m_vert_count + soa_points::padding - 1) / soa_points::padding * soa_points::padding; }
+        // where each array starts in m_data
+        const std::int16_t* xs() const { return m_data.data(); }
+        const std::int16_t* ys() const { return xs() + padded_vert_count(); } // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // within m_data
+        const std::int16_t* zs() const { return ys() + padded_vert_count(); } // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // within m_data
+        const std::int16_t* normals() const { return zs() + padded_vert_count(); } // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // within m_data
+        const std::int16_t* edges() const { return normals() + 2 * std::size_t(m_face_count); } // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // within m_data
+        const std::int16_t* extents() const { return edges() + 2 * std::size_t(m_edge_count); } // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // within m_data, 4 int16s (2 floats' bits) per face
+        static std::size_t data_size(std::size_t padded_verts, std::size_t faces, std::size_t edges) { return 3 * padded_verts + 2 * faces + 2 * edges + 4 * faces; }
+    public:
+        // what is serialized along with data(), to rebuild the polytope with from_data
+        struct layout {
+            std::uint32_t vert_count, face_count, edge_count;
+            glm::vec3 center, step;
+        };
+
+        packed_polytope() = default;
+        // face normals and edges need not be normalized, nor have a consistent verse
+        ENGINE_API packed_polytope(std::span<const glm::vec3> verts, std::span<const glm::vec3> face_normals, std::span<const glm::vec3> edges);
+        // nullopt if data's size does not match the layout
+        ENGINE_API static std::optional<packed_polytope> from_data(const layout& l, std::span<const std::int16_t> data);
+
+        std::size_t vert_count() const { return m_vert_count; }
+        std::size_t face_count() const { return m_face_count; }
+        std::size_t edge_count() const { return m_edge_count; }
+        bool empty() const { return m_vert_count == 0; }
+
+        ENGINE_API glm::vec3 vert(std::size_t i) const;
+        // unit length
+        ENGINE_API glm::vec3 face_normal(std::size_t i) const;
+        // min (x) and max (y) of the projections of the vertices on face_normal(i)
+        ENGINE_API glm::vec2 face_normal_extents(std::size_t i) const;
+        // unit length
+        ENGINE_API glm::vec3 edge(std::size_t i) const;
+
+        // min (x) and max (y) of the projections of the vertices on axis
+        ENGINE_API glm::vec2 project(glm::vec3 axis) const;
+        // the vertex farthest along d
+        ENGINE_API glm::vec3 support(glm::vec3 d) const;
+        // replaces out's points with transform * the vertices
+        ENGINE_API void transform_verts(const glm::mat4& transform, soa_points& out) const;
+
+        layout get_layout() const { return { .vert_count = m_vert_count, .face_count = m_face_count, .edge_count = m_edge_count, .center = m_center, .step = m_step }; }
+        std::span<const std::int16_t> data() const { return m_data; }
+    };
+}
+
+#endif // ENGINE_UTILS_PACKED_POLYTOPE_HPP
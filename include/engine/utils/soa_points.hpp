@@ -0,0 +1,50 @@
+#ifndef ENGINE_UTILS_SOA_POINTS_HPP
+#define ENGINE_UTILS_SOA_POINTS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+#include <engine/utils/api_macro.hpp>
+
+namespace engine {
+    // instruction sets soa_points::project can use; the best one the cpu supports is picked the first time it is needed
+    enum class simd_level { scalar, sse, avx2 };
+
+    ENGINE_API simd_level get_simd_level();
+    // mainly for benchmarks and tests; returns false (and changes nothing) if the cpu does not support level
+    ENGINE_API bool set_simd_level(simd_level level);
+
+    /* A set of points stored as a structure of arrays, so that they can be projected on an axis several at a time with
+     * simd instructions. The arrays are padded to a multiple of padding by repeating the last point, which changes
+     * neither the min nor the max of any projection.
+     */
+    class soa_points {
+        std::vector<float> m_x, m_y, m_z;
+        std::size_t m_size = 0;
+    public:
+        static constexpr std::size_t padding = 8;
+
+        soa_points() = default;
+        explicit soa_points(std::span<const glm::vec3> points) { assign(points); }
+
+        // replaces the points with transform * points; the arrays' storage is reused
+        ENGINE_API void assign(std::span<const glm::vec3> points, const glm::mat4& transform = glm::mat4(1));
+        // the same, for the size points of 16 bit coordinates (x[i], y[i], z[i]), e.g. quantized ones (see packed_polytope)
+        ENGINE_API void assign(const std::int16_t* x, const std::int16_t* y, const std::int16_t* z, std::size_t size, const glm::mat4& transform);
+
+        // min (x) and max (y) of the projections of the points on axis
+        ENGINE_API glm::vec2 project(glm::vec3 axis) const;
+
+        std::size_t size() const { return m_size; }
+    };
+
+    /* min (x) and max (y) of the projections on axis of the points (x[i], y[i], z[i]) of 16 bit coordinates, converted to
+     * floats as they are loaded, with the same simd kernels as soa_points::project; n must be a multiple of
+     * soa_points::padding
+     */
+    ENGINE_API glm::vec2 project_int16_points(const std::int16_t* x, const std::int16_t* y, const std::int16_t* z, std::size_t n, glm::vec3 axis);
+}
+
+#endif // ENGINE_UTILS_SOA_POINTS_HPP
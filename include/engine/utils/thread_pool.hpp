@@ -0,0 +1,70 @@
+#ifndef ENGINE_UTILS_THREAD_POOL_HPP
+#define ENGINE_UTILS_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <engine/utils/api_macro.hpp>
+
+namespace engine {
+    /* A fixed set of worker threads for data parallel loops: parallel_for splits a range in chunks which the workers and
+     * the calling thread take in turns, and returns once all of them are done. Only one loop runs at a time; concurrent
+     * calls wait for each other.
+     */
+    class thread_pool {
+        // the running loop; type erased without allocating, since the callable outlives it
+        struct job {
+            void (*call)(const void* f, std::size_t begin, std::size_t end) = nullptr;
+            const void* f = nullptr;
+            std::size_t count = 0;
+            std::size_t chunk_size = 0;
+            std::size_t chunks = 0;
+            std::atomic<std::size_t> next_chunk = 0;
+        };
+
+        std::vector<std::jthread> m_workers;
+        std::mutex m_loop_mutex; // held for the whole of a parallel_for
+
+        std::mutex m_mutex; // guards the members below
+        std::condition_variable m_wake_workers;
+        std::condition_variable m_wake_caller;
+        job m_job;
+        std::uint64_t m_job_generation = 0;
+        std::size_t m_busy_workers = 0; // workers running chunks; the job may only be replaced once there are none
+        std::exception_ptr m_exception = nullptr;
+        bool m_stop = false;
+
+        void worker_loop();
+        // takes chunks of the current job until there are none left
+        void run_chunks();
+        void run(void (*call)(const void*, std::size_t, std::size_t), const void* f, std::size_t count, std::size_t min_chunk_size);
+    public:
+        // threads: the number of workers, besides the threads calling parallel_for
+        ENGINE_API explicit thread_pool(std::size_t threads);
+        ENGINE_API ~thread_pool();
+        thread_pool(const thread_pool&) = delete;
+        thread_pool(thread_pool&&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+        thread_pool& operator=(thread_pool&&) = delete;
+
+        // a pool with a worker per hardware thread but one, created the first time it is needed
+        ENGINE_API static thread_pool& shared();
+
+        std::size_t size() const { return m_workers.size(); }
+
+        /* calls f(begin, end) over consecutive chunks of [0, count), each at least min_chunk_size long (but the last), in
+         * parallel. If f throws, the first exception is rethrown once all the chunks have been handed out and finished.
+         */
+        template<typename F>
+        void parallel_for(std::size_t count, std::size_t min_chunk_size, const F& f) {
+            run([](const void* fp, std::size_t begin, std::size_t end) { (*static_cast<const F*>(fp))(begin, end); }, &f, count, min_chunk_size);
+        }
+    };
+}
+
+#endif // ENGINE_UTILS_THREAD_POOL_HPP
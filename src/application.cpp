@@ -5,7 +5,11 @@
 #include <imgui.h>
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_opengl3.h>
+#include <array>
 #include <chrono>
+#include <exception>
+#include <semaphore>
+#include <thread>
 #include <slogga/log.hpp>
 
 #include <engine/application.hpp>
@@ -30,7 +34,7 @@ namespace engine {
 
             application* app = reinterpret_cast<application*>(window::window::get_user_ptr(window_handle));
 
-            app->m_events_this_frame.push_back(key_event_t{key, scancode, action, mods});
+            app->m_updates.push_event(key_event_t{key, scancode, action, mods});
         });
         m_window.set_mouse_cb([] (GLFWwindow* window_handle, double xpos, double ypos) {
             if(ImGui::GetIO().WantCaptureMouse)
@@ -48,7 +52,7 @@ namespace engine {
             }
 
 
-            app->m_events_this_frame.push_back(mouse_move_event_t{pos, movement});
+            app->m_updates.push_event(mouse_move_event_t{pos, movement});
             app->m_prev_mouse_cursor_pos = pos;
 
         }, [](GLFWwindow* window_handle, int button, int action, int mods) {
@@ -56,7 +60,7 @@ namespace engine {
                 return;
             application* app = reinterpret_cast<application*>(window::window::get_user_ptr(window_handle));
 
-            app->m_events_this_frame.push_back(key_event_t{button, -1, action, mods});
+            app->m_updates.push_event(key_event_t{button, -1, action, mods});
         });
 
 
@@ -86,7 +90,81 @@ namespace engine {
         ImGui::DestroyContext();
     }
 
+    void application::begin_frame(float delta, float frame_time) {
+        // read and write to the channel to the scene
+        EXPECTS(m_active_scene);
+        nullable_rc<scene> scene_to_change_to = std::move(m_active_scene->app_channel().to_app().scene_to_change_to);
+        if(scene_to_change_to) {
+            ASSERTS(m_active_scene->app_channel().from_app_mut().scene_is_active);
+
+            m_active_scene->app_channel().from_app_mut().scene_is_active = false;
+
+            m_active_scene = std::move(scene_to_change_to);
+            m_active_scene->app_channel().from_app_mut().scene_is_active = true;
+            m_active_scene->prepare();
+        }
+
+        bool cursor_is_captured = m_window.is_mouse_cursor_captured();
+        bool wants_cursor_captured = m_active_scene->app_channel().to_app().wants_mouse_cursor_captured;
+        if(wants_cursor_captured && !cursor_is_captured) {
+            m_window.capture_mouse_cursor();
+            m_ignore_mouse_move_on_next_event = true;
+            cursor_is_captured = true;
+        } else if(!wants_cursor_captured && cursor_is_captured) {
+            m_window.uncapture_mouse_cursor();
+            m_ignore_mouse_move_on_next_event = true;
+            cursor_is_captured = false;
+        }
+
+
+        ASSERTS(m_window.is_mouse_cursor_captured() == cursor_is_captured);
+        m_active_scene->app_channel().from_app_mut().mouse_cursor_is_captured = cursor_is_captured;
+        m_active_scene->app_channel().from_app_mut().framebuffer_size = m_window.get_framebuf_size();
+        m_active_scene->app_channel().from_app_mut().delta = delta;
+        m_active_scene->app_channel().from_app_mut().frame_time = frame_time;
+        // events which were not delivered yet (in fixed timestep mode no update may happen in a frame) are kept
+        m_updates.begin_frame();
+        window::window::poll_events(); // populates m_updates' events
+        m_active_scene->app_channel().from_app_mut().events = m_updates.events();
+
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplGlfw_NewFrame();
+        ImGui::NewFrame();
+    }
+
+    float application::simulate(float delta) {
+        if(!m_updates.fixed_timestep()) {
+            m_active_scene->update();
+            m_active_scene->end_frame();
+            m_updates.consume_events();
+            return 1.f;
+        }
+
+        const int steps = m_updates.advance(delta);
+        m_active_scene->app_channel().from_app_mut().delta = *m_updates.fixed_timestep();
+        for(int i = 0; i < steps; i++) {
+            if(i == steps - 1)
+                m_active_scene->capture_previous_transforms();
+
+            m_active_scene->update();
+
+            // deliver the events only once
+            m_updates.consume_events();
+            m_active_scene->app_channel().from_app_mut().events = {};
+        }
+        m_active_scene->end_frame();
+
+        return m_updates.interpolation();
+    }
+
     void application::run() {
+        if(m_pipelined)
+            run_pipelined();
+        else
+            run_sequential();
+    }
+
+    void application::run_sequential() {
         using clock = std::chrono::steady_clock;
         auto app_start_time = clock::now(); // frame_time is an offset from this
         auto last_frame_time = app_start_time;  //used to calculate the delta
@@ -96,57 +174,119 @@ namespace engine {
             float delta = std::chrono::duration<float>(curr_frame_time - last_frame_time).count();
             float frame_time = std::chrono::duration<float>(curr_frame_time - app_start_time).count();
 
-            // read and write to the channel to the scene
-            EXPECTS(m_active_scene);
-            nullable_rc<scene> scene_to_change_to = std::move(m_active_scene->app_channel().to_app().scene_to_change_to);
-            if(scene_to_change_to) {
-                ASSERTS(m_active_scene->app_channel().from_app_mut().scene_is_active);
+            begin_frame(delta, frame_time);
 
-                m_active_scene->app_channel().from_app_mut().scene_is_active = false;
+            float interpolation = simulate(delta);
+            m_active_scene->render(interpolation);
 
-                m_active_scene = std::move(scene_to_change_to);
-                m_active_scene->app_channel().from_app_mut().scene_is_active = true;
-                m_active_scene->prepare();
-            }
+            ImGui::Render();
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
-            bool cursor_is_captured = m_window.is_mouse_cursor_captured();
-            bool wants_cursor_captured = m_active_scene->app_channel().to_app().wants_mouse_cursor_captured;
-            if(wants_cursor_captured && !cursor_is_captured) {
-                m_window.capture_mouse_cursor();
-                m_ignore_mouse_move_on_next_event = true;
-                cursor_is_captured = true;
-            } else if(!wants_cursor_captured && cursor_is_captured) {
-                m_window.uncapture_mouse_cursor();
-                m_ignore_mouse_move_on_next_event = true;
-                cursor_is_captured = false;
-            }
+            m_window.swap_buffers();
 
 
-            ASSERTS(m_window.is_mouse_cursor_captured() == cursor_is_captured);
-            m_active_scene->app_channel().from_app_mut().mouse_cursor_is_captured = cursor_is_captured;
-            m_active_scene->app_channel().from_app_mut().framebuffer_size = m_window.get_framebuf_size();
-            m_active_scene->app_channel().from_app_mut().delta = delta;
-            m_active_scene->app_channel().from_app_mut().frame_time = frame_time;
-            m_events_this_frame.clear();
-            window::window::poll_events(); // populates m_events_this_frame
-            m_active_scene->app_channel().from_app_mut().events = m_events_this_frame;
 
-            ImGui_ImplOpenGL3_NewFrame();
-            ImGui_ImplGlfw_NewFrame();
-            ImGui::NewFrame();
+            last_frame_time = curr_frame_time;
+        }
+    }
 
+    void application::run_pipelined() {
+        using clock = std::chrono::steady_clock;
+        auto app_start_time = clock::now(); // frame_time is an offset from this
+        auto last_frame_time = app_start_time;  //used to calculate the delta
 
-            m_active_scene->update();
-            m_active_scene->render();
+        // double buffered render snapshot: the worker extracts into snapshots[1-front] while the main thread submits snapshots[front]
+        std::array<render_snapshot, 2> snapshots;
+        std::size_t front = 0;
+        nullable_rc<scene> front_scene = nullptr; // the scene snapshots[front] was extracted from; kept alive until it is submitted
+
+        // state shared with the worker; accesses are ordered by the semaphores
+        std::binary_semaphore start_update(0), update_done(0);
+        scene* worker_scene = nullptr;
+        render_snapshot* worker_snapshot = nullptr;
+        float worker_delta = 0.f;
+        bool stop_worker = false;
+        std::exception_ptr worker_exception = nullptr;
+
+        std::jthread worker([&]() {
+            while(true) {
+                start_update.acquire();
+                if(stop_worker)
+                    return;
+
+                try {
+                    // meshes and viewports are being read by the main thread, which submits the previous snapshot
+                    node::set_render_payloads_read_only(true);
+                    float interpolation = simulate(worker_delta);
+                    node::set_render_payloads_read_only(false);
+                    worker_scene->extract_render_snapshot(*worker_snapshot, interpolation);
+                } catch(...) {
+                    node::set_render_payloads_read_only(false);
+                    worker_exception = std::current_exception();
+                }
+                update_done.release();
+            }
+        });
+        bool update_in_flight = false; // whether the worker was started and update_done not acquired yet; main thread only
+
+        // stops the worker however this function is left, waiting for the update in flight first: if something thrown on
+        // the main thread (e.g. while submitting a snapshot or applying mutations) left the worker waiting for
+        // start_update, std::jthread's destructor would join it forever. Declared after worker, so it runs before the join
+        struct worker_stopper {
+            std::binary_semaphore& start_update;
+            std::binary_semaphore& update_done;
+            bool& stop_worker;
+            const bool& update_in_flight;
+
+            ~worker_stopper() {
+                if(update_in_flight)
+                    update_done.acquire();
+                stop_worker = true;
+                start_update.release();
+            }
+        } stopper{start_update, update_done, stop_worker, update_in_flight};
+
+        while (!m_window.should_close()) {
+            auto curr_frame_time = clock::now();
+            float delta = std::chrono::duration<float>(curr_frame_time - last_frame_time).count();
+            float frame_time = std::chrono::duration<float>(curr_frame_time - app_start_time).count();
+
+            begin_frame(delta, frame_time);
+
+            // update frame N+1 on the worker...
+            m_active_scene->set_pipelined(true);
+            worker_scene = &*m_active_scene;
+            worker_snapshot = &snapshots[1 - front]; // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index) // front is 0 or 1
+            worker_delta = delta;
+            update_in_flight = true;
+            start_update.release();
+
+            // ...while submitting frame N
+            if(front_scene)
+                front_scene->submit_render_snapshot(snapshots[front]); // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index) // front is 0 or 1
+
+            update_done.acquire();
+            update_in_flight = false;
+            if(worker_exception)
+                std::rethrow_exception(worker_exception);
+
+            // sync point, with the worker idle: snapshots[front] has been submitted, so nothing references the nodes
+            // destroyed at the last sync point anymore; the structural changes requested during this update are applied
+            // here, on the GL thread, and what they destroy is kept alive until the next one, since the snapshot just
+            // extracted may reference it
+            worker_scene->flush_deferred_destructions();
+            worker_scene->apply_mutations();
+            front = 1 - front;
+            front_scene = m_active_scene;
 
             ImGui::Render();
             ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
             m_window.swap_buffers();
 
-
-
             last_frame_time = curr_frame_time;
         }
+
+        m_active_scene->set_pipelined(false); // the worker is stopped by stopper and then joined by std::jthread's destructor
     }
 }
@@ -40,6 +40,28 @@ namespace engine {
         return id;
     }
 
+    void entity_component_system::reserve_ids(ecs_id_t count) {
+        const ecs_id_t free_ids = m_freed_ids.size();
+        if(free_ids >= count) {
+            return;
+        }
+
+        const ecs_id_t ids_previously_in_use = m_id_pool_size;
+        m_id_pool_size = std::max(m_id_pool_size * 2, m_id_pool_size + (count - free_ids));
+
+        // extend the last free interval if it reaches the end of the previous pool, instead of adding an adjacent one
+        ecs_id_t new_interval_start = ids_previously_in_use;
+        if(!m_freed_ids.empty() && m_freed_ids.peek_last_interval().b == ids_previously_in_use - 1) {
+            new_interval_start = m_freed_ids.peek_last_interval().a;
+            m_freed_ids.erase_last_interval();
+        }
+        m_freed_ids.insert_at_end({new_interval_start, m_id_pool_size - 1});
+
+        for(std::pair<component_name_t, std::unique_ptr<ecs_component_interface>>& c : m_components) {
+            c.second->number_of_ids_in_use_changed(m_id_pool_size);
+        }
+    }
+
     void entity_component_system::add_new_used_component(ecs_id_t id, component_name_t component_name) { m_components_used[id].insert(component_name); } // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // hashmap access is safe
 
     // well defined for n/0 (just returns numeric_limits::max())
@@ -11,7 +11,7 @@
 namespace engine {
     static void terminate_handler();
 
-    void entry_point(glm::ivec2 wnd_res, const std::string& wnd_name, window::hints wnd_hints, std::function<rc<scene>()> get_start_scene) {
+    void entry_point(glm::ivec2 wnd_res, const std::string& wnd_name, window::hints wnd_hints, std::function<rc<scene>()> get_start_scene, bool pipelined, std::optional<float> fixed_timestep) {
         #ifdef NDEBUG
             slogga::stdout_log.set_log_level(slogga::log_level::WARN);
         #else
@@ -23,6 +23,8 @@ namespace engine {
         engine::application application(wnd_res, wnd_name, wnd_hints);
 
         application.set_start_scene(get_start_scene());
+        application.set_pipelined(pipelined);
+        application.set_fixed_timestep(fixed_timestep);
 
         application.run();
     }
@@ -8,6 +8,7 @@
 #include <engine/entity_component_system.hpp>
 
 #include <engine/resources_manager.hpp>
+#include <engine/scene/node/script.hpp>
 
 namespace engine {
     using namespace detail;
@@ -25,6 +26,25 @@ namespace engine {
     rc<const shader> resources_manager::get_default_3d_shader() { return m_default_3d_shader.value_or(load<shader>(internal_resource_name_t::simple_3d_shader)); }
     void resources_manager::set_default_3d_shader(std::optional<rc<const shader>> s) { m_default_3d_shader = std::move(s); }
 
+    const script_index& resources_manager::get_script_index(const rc<const dylib::library>& dynlib) {
+        const dylib::library* key = &*dynlib;
+        if(auto it = m_script_indices.find(key); it != m_script_indices.end())
+            return *it->second;
+
+        const std::size_t exported_plugins_size = dynlib->get_variable<std::size_t>("exported_plugins_size");
+        const std::pair<const char*, script_vtable> (&exported_plugins)[] = dynlib->get_variable<const std::pair<const char*, script_vtable>[]>("exported_plugins"); // NOLINT(cppcoreguidelines-avoid-c-arrays)
+
+        auto index = std::make_unique<script_index>();
+        index->scripts.reserve(exported_plugins_size);
+        for(std::size_t i = 0; i < exported_plugins_size; i++) {
+            auto [it, inserted] = index->scripts.emplace(exported_plugins[i].first, exported_plugins[i].second); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            if(!inserted)
+                slogga::stdout_log.warn("dynamic library exports more than one script named '{}'; only the first one will be used", it->first);
+        }
+
+        return *m_script_indices.emplace(key, std::move(index)).first->second;
+    }
+
     void resources_manager::collect_garbage() {
         slogga::stdout_log("called resources_manager::collect_garbage");
 
@@ -48,6 +68,12 @@ namespace engine {
 
                 //refcount can be >0 if the obj was flagged and a weak<T> managed to lock() it before it was deleted, or if a rc<T> to it was obtained through its name
                 if(rc_ref.refcount() == 0) {
+                    // the library is about to be unloaded: drop its script index (its vtables point into it)
+                    if constexpr (std::same_as<T, dylib::library>) {
+                        if(rc_ref.resource().has_value())
+                            m_script_indices.erase(&*rc_ref.resource());
+                    }
+
                     if(rc_ref.weak_refcount() == 0) {
                         //there are neither rc<T> nor weak<T> pointing to this resource
                         //if present remove name-id correspondence
@@ -136,6 +162,9 @@ namespace engine {
         global_rm_instance_is_inited = false;
     }
 
+    resources_manager::headless_instance::headless_instance() { init_instance(); }
+    resources_manager::headless_instance::~headless_instance() { deinit_instance(); }
+
     resources_manager& get_rm() {
         return resources_manager::get_instance();
     }
@@ -70,65 +70,13 @@ namespace engine {
         }
     }
 
-    static void render_tree(renderer& r, const gal::vertex_array& whole_screen_vao, const node& root, const mvp_matrices& viewproj, glm::ivec2 out_res, float frame_time) {
-        struct payload_t {
-            glm::ivec2 out_res;
-            mvp_matrices viewproj;
-            const node* vp_node;
-        };
-
-        constexpr std::nullptr_t default_framebuffer = nullptr;
-
-        depth_first_traversal(root, payload_t {out_res, viewproj, default_framebuffer},
-            //preorder: construction of payload
-            [frame_time, &r](const node& n, const payload_t& father_payload) {
-                payload_t children_payload{};
-
-                // if n is a viewport first setup rendering of children,
-                // otherwise render them to the same viewport as n
-                if (n.has<viewport>()) {
-                    n.get<viewport>().output_resolution_changed(father_payload.out_res);
-
-                    children_payload.vp_node = &n;
-                    children_payload.out_res = n.get<viewport>().fbo().resolution();
+    // the global transform to render n with: interpolated from the one captured by scene::capture_previous_transforms() if there is one
+    static mat4 interpolated_global_transform(const node& n, const ecs_component_typed_interface<mat4>& previous_global_transforms, float interpolation) {
+        if(interpolation >= 1.f)
+            return n.get_global_transform();
 
-                    n.get<viewport>().bind_draw();
-
-                    float aspect_ratio = float(children_payload.out_res.x) / float(children_payload.out_res.y);
-                    mat4 proj_mat = glm::perspective(fovy, aspect_ratio, znear, zfar); // TODO: fovy and znear and zfar are opinionated choices, and should be somehow parameterized (probably through the camera/viewport)
-                    mat4 view_mat = n.get<viewport>().get_active_camera().value_or(mat4(1)).get_view_mat();
-                    children_payload.viewproj = mvp_matrices { .m=glm::mat4(1.), .v=view_mat, .p=proj_mat };
-                    r.clear();
-                } else {
-                    children_payload = father_payload;
-                }
-
-                return children_payload;
-            },
-            //postorder: rendering and viewport switching
-            [frame_time, &r, &whole_screen_vao](const node& n, const payload_t& father_payload){
-                // render self
-                if (n.has<mesh>()){
-                    r.get_low_level_renderer().change_viewport_size(father_payload.out_res);
-
-                    mvp_matrices mvp = father_payload.viewproj;
-                    mvp.m = n.get_global_transform();
-                    r.draw(n.get<mesh>(), father_payload.out_res,  mvp, frame_time);
-                }
-
-                // only rebind the viewport if n is a viewport (to unbind n and bind whatever its ancestor viewport is)
-                if (n.has<viewport>()) {
-                    //bind the correct output fbo
-                    if(father_payload.vp_node) {
-                        EXPECTS(father_payload.vp_node->has<viewport>());
-                        father_payload.vp_node->get<viewport>().bind_draw();
-                    } else {
-                        framebuffer::unbind();
-                    }
-
-                    r.get_low_level_renderer().change_viewport_size(father_payload.out_res);
-                }
-            });
+        optional_ref<const mat4> previous = previous_global_transforms.try_get(n.ecs_id());
+        return previous ? interpolate_transforms(*previous, n.get_global_transform(), interpolation) : n.get_global_transform();
     }
 
     //sets the cameras for all viewports in the hierarchy, and returns the camera to use for the default framebuffer.
@@ -165,8 +113,9 @@ namespace engine {
         return default_fb_camera;
     }
     [[nodiscard]]
-    static std::optional<camera> set_cameras_no_recursion(node& root) {
+    static std::optional<camera> set_cameras_no_recursion(node& root, float interpolation = 1.f) {
         std::optional<camera> default_fb_camera = std::nullopt;
+        const auto& previous_global_transforms = get_rm().ecs().get_component<mat4>("previous_global_transform");
 
         struct payload_t {
             node* ancestor_vp = nullptr;
@@ -179,7 +128,7 @@ namespace engine {
 
                 //if this is a camera set it as active for it forefather (/default) viewport
                 if(n.has<camera>()) {
-                    n.get<camera>().set_view_mat(glm::inverse(n.get_global_transform()));
+                    n.get<camera>().set_view_mat(glm::inverse(interpolated_global_transform(n, previous_global_transforms, interpolation)));
 
                     if(father_pl.ancestor_vp) {
                         EXPECTS(father_pl.ancestor_vp->has<viewport>());
@@ -204,33 +153,127 @@ namespace engine {
     }
 
 
-    scene::scene(std::string name, std::unique_ptr<node> root, application_channel_t::to_app_t to_app_chan)
+    scene::scene(std::string name, std::unique_ptr<node> root, application_channel_t::to_app_t to_app_chan, std::unique_ptr<broad_phase_collision_detector> bp_collision_detector)
         : m_root(std::move(root)),
           m_name(std::move(name)),
           m_renderer(),
           m_whole_screen_vao(get_rm().load<gal::vertex_array>(internal_resource_name_t::whole_screen_vao)),
           m_render_flags(),
-          m_application_channel(std::move(to_app_chan), application_channel_t::from_app_t{ .scene_name = m_name }) {
+          m_mutation_queue(std::make_unique<mutation_queue>()),
+          m_application_channel(std::move(to_app_chan), application_channel_t::from_app_t{ .scene_name = m_name }, *m_mutation_queue),
+          m_bp_collision_detector(bp_collision_detector ? std::move(bp_collision_detector) : std::make_unique<pass_all_broad_phase_collision_detector>()),
+          m_script_profiler(std::make_unique<script_profiler>()) {
         //the root of a scene's name should always be unnamed.
         EXPECTS(m_root.get());
         EXPECTS(m_root->name().empty());
+
+        m_bp_collision_detector->set_script_profiler(m_script_profiler.get());
+        // from now on the tree's colliders (un)subscribe themselves as they are attached or detached
+        m_root->set_bp_collision_detector(m_bp_collision_detector.get());
+    }
+
+    scene::~scene() {
+        if(m_root)
+            m_root->set_bp_collision_detector(nullptr);
+    }
+
+    void scene::render(float interpolation) {
+        extract_render_snapshot(m_render_snapshot, interpolation);
+        submit_render_snapshot(m_render_snapshot);
+    }
+
+    void scene::capture_previous_transforms() {
+        auto& previous_global_transforms = get_rm().ecs().get_component<mat4>("previous_global_transform");
+
+        depth_first_traversal(std::as_const(get_root()), [&](const node& n) {
+            if(n.has<mesh>() || n.has<camera>())
+                previous_global_transforms.set(n.ecs_id(), n.get_global_transform());
+        });
     }
 
-    void scene::render() {
-        glm::ivec2 resolution = m_application_channel.from_app().framebuffer_size;
-        float frame_time = m_application_channel.from_app().frame_time;
+    void scene::extract_render_snapshot(render_snapshot& out, float interpolation) {
+        out.clear();
+        out.resolution = m_application_channel.from_app().framebuffer_size;
+        out.frame_time = m_application_channel.from_app().frame_time;
+        out.clear_color = m_application_channel.to_app().clear_color;
 
-        std::optional<camera> default_fb_camera = set_cameras_no_recursion(get_root());
-        // std::optional<camera> default_fb_camera = set_cameras_recursive_bk(get_root(), std::nullopt);
-        // std::optional<camera> default_fb_camera = std::nullopt;
+        std::optional<camera> default_fb_camera = set_cameras_no_recursion(get_root(), interpolation);
+        out.default_view = default_fb_camera ? default_fb_camera->get_view_mat() : mat4(1);
 
-        m_renderer.clear(m_application_channel.to_app().clear_color);
+        const auto& previous_global_transforms = get_rm().ecs().get_component<mat4>("previous_global_transform");
+
+        depth_first_traversal(std::as_const(get_root()), std::monostate(),
+            [&out](const node& n, std::monostate) { // preorder
+                if(n.has<viewport>()) {
+                    const viewport& vp = n.get<viewport>();
+                    mat4 view = vp.get_active_camera().value_or(mat4(1)).get_view_mat();
+                    out.commands.emplace_back(render_snapshot::begin_viewport{ .vp = &vp, .view = view });
+                }
+                return std::monostate();
+            },
+            [&](const node& n, std::monostate) { // postorder
+                if(n.has<mesh>()) {
+                    mat4 model = interpolated_global_transform(n, previous_global_transforms, interpolation);
+                    out.commands.emplace_back(render_snapshot::draw_mesh{ .m = &n.get<mesh>(), .model = model });
+                }
+                if(n.has<viewport>())
+                    out.commands.emplace_back(render_snapshot::end_viewport{});
+            }
+        );
+    }
+
+    void scene::submit_render_snapshot(const render_snapshot& snapshot) {
+        struct render_target_t {
+            const viewport* vp; // nullptr for the default framebuffer
+            glm::ivec2 out_res;
+            mvp_matrices viewproj;
+        };
+
+        auto make_viewproj = [](glm::ivec2 res, const mat4& view) {
+            float aspect_ratio = float(res.x) / float(res.y);
+            mat4 proj_mat = glm::perspective(fovy, aspect_ratio, znear, zfar); // TODO: fovy and znear and zfar are opinionated choices, and should be somehow parameterized (probably through the camera/viewport)
+            return mvp_matrices { .m=mat4(1.), .v=view, .p=proj_mat };
+        };
+
+        std::vector<render_target_t> targets;
+        targets.push_back({ nullptr, snapshot.resolution, make_viewproj(snapshot.resolution, snapshot.default_view) });
+
+        m_renderer.clear(snapshot.clear_color);
+
+        for(const render_snapshot::command_t& command : snapshot.commands) {
+            match_variant(command,
+                [&](const render_snapshot::begin_viewport& cmd) {
+                    cmd.vp->output_resolution_changed(targets.back().out_res);
+                    glm::ivec2 out_res = cmd.vp->fbo().resolution();
+
+                    cmd.vp->bind_draw();
+                    targets.push_back({ cmd.vp, out_res, make_viewproj(out_res, cmd.view) });
+                    m_renderer.clear();
+                },
+                [&](const render_snapshot::end_viewport&) {
+                    EXPECTS(targets.size() > 1);
+                    targets.pop_back();
+
+                    //bind the correct output fbo
+                    const render_target_t& target = targets.back();
+                    if(target.vp) {
+                        target.vp->bind_draw();
+                    } else {
+                        framebuffer::unbind();
+                    }
+                    m_renderer.get_low_level_renderer().change_viewport_size(target.out_res);
+                },
+                [&](const render_snapshot::draw_mesh& cmd) {
+                    const render_target_t& target = targets.back();
+                    m_renderer.get_low_level_renderer().change_viewport_size(target.out_res);
+
+                    mvp_matrices mvp = target.viewproj;
+                    mvp.m = cmd.model;
+                    m_renderer.draw(*cmd.m, target.out_res, mvp, snapshot.frame_time);
+                }
+            );
+        }
 
-        float aspect_ratio = float(resolution.x) / float(resolution.y);
-        mat4 proj_mat = glm::perspective(fovy, aspect_ratio, znear, zfar); // TODO: fovy and znear and zfar are opinionated choices, and should be somehow parameterized (probably through the camera/viewport)
-        mat4 view_mat = default_fb_camera ? default_fb_camera->get_view_mat() : mat4(1);
-        mvp_matrices viewproj { .m=mat4(1.), .v=view_mat, .p=proj_mat };
-        render_tree(m_renderer, *m_whole_screen_vao, get_root(), viewproj, resolution, frame_time);
         m_renderer.finalize_frame();
     }
 
@@ -238,19 +281,25 @@ namespace engine {
         // process nodes
         depth_first_traversal(get_root(), [&](node& n){
             visit_optional(n.get_script(), [&](auto& s) {
-                s.process(n, m_application_channel);
+                m_script_profiler->measure(s.get_underlying_stateless_script(), script_profiler::call_kind::process, [&]() {
+                    s.process(n, m_application_channel);
+                });
             });
         });
 
-        // TODO: currently resubscribing all colliders at every update: is it ok? ideally colliders would subscribe/unsubscribe themselves, making this unnecessary
-        m_bp_collision_detector.reset_subscriptions();
+        m_bp_collision_detector->check_collisions_and_trigger_reactions();
 
-        depth_first_traversal(get_root(), [&](node& n){
-            if(n.has<collision_shape>())
-                m_bp_collision_detector.subscribe(&n);
-        });
+        // sync point: apply the structural changes requested during this update (in pipelined mode the application does
+        // it instead, on the main thread)
+        if(!m_pipelined)
+            m_mutation_queue->apply();
+    }
 
-        m_bp_collision_detector.check_collisions_and_trigger_reactions();
+    void scene::end_frame() {
+        if(m_script_profiler->is_enabled())
+            m_script_profiler->end_frame();
+        if(m_show_script_profiler_window)
+            m_script_profiler->draw_imgui_window(&m_show_script_profiler_window);
     }
 
     void scene::prepare() {
@@ -259,6 +308,13 @@ namespace engine {
 
     node& scene::get_root() { return *m_root; }
 
+    std::unique_ptr<node> scene::into_node_tree() {
+        std::unique_ptr<node> ret = std::move(m_root);
+        m_root = nullptr;
+        ret->set_bp_collision_detector(nullptr);
+        return ret;
+    }
+
     node& scene::get_node(std::string_view path) {
         if(path.at(0) != '/')
             throw invalid_path_exception(path);
@@ -2,7 +2,8 @@
 #include <imgui.h>
 
 namespace engine {
-    application_channel_t::application_channel_t(to_app_t to_app, from_app_t from_app) : m_to_app(std::move(to_app)), m_from_app(std::move(from_app)) {}
+    application_channel_t::application_channel_t(to_app_t to_app, from_app_t from_app, mutation_queue& mutations)
+        : m_to_app(std::move(to_app)), m_from_app(std::move(from_app)), m_mutation_queue(&mutations) {}
 
     ImGuiContext* application_channel_t::from_app_t::get_current_imgui_context() const {
         return ImGui::GetCurrentContext();
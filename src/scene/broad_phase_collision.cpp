@@ -1,7 +1,13 @@
 #include <engine/scene/broad_phase_collision.hpp>
 #include <engine/scene/node/narrow_phase_collision.hpp>
 #include <engine/scene/node.hpp>
+#include <engine/utils/meta.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include <slogga/asserts.hpp>
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <numeric>
 
 namespace engine {
     inline node* assert_nonnull(node* p) {
@@ -9,40 +15,635 @@ namespace engine {
         return p;
     }
 
-    void pass_all_broad_phase_collision_detector::check_collisions_and_trigger_reactions() {
-        for(size_t i = 0; i < m_subscribers.size(); i++) {
-            node* a = assert_nonnull(m_subscribers[i]); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < m_subscribers.size()
-            EXPECTS(a->has<rc<const collision_shape>>());
-
-            for(size_t j = i + 1; j < m_subscribers.size(); j++) {
-                node* b = assert_nonnull(m_subscribers[j]); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < m_subscribers.size()
-                EXPECTS(b->has<rc<const collision_shape>>());
-
-                //TODO: check layer correctness
-                const auto& a_cs = a->get<collision_shape>();
-                const auto& b_cs = b->get<collision_shape>();
-                bool a_sees_b = bool(a_cs.sees_layers & b_cs.is_layers);
-                bool b_sees_a = bool(b_cs.sees_layers & a_cs.is_layers);
-                if(!a_sees_b && !b_sees_a)
+    void collider_subscriptions::add(node* n) {
+        EXPECTS(n != nullptr);
+        auto [it, inserted] = m_index_of.try_emplace(n, (std::uint32_t)m_nodes.size());
+        EXPECTS(inserted); // a node cannot be subscribed twice
+        m_nodes.push_back(n);
+    }
+
+    void collider_subscriptions::remove(node* n) {
+        auto it = m_index_of.find(n);
+        EXPECTS(it != m_index_of.end());
+        m_nodes[it->second] = nullptr; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // indices in m_index_of are valid
+        m_index_of.erase(it);
+        m_holes++;
+    }
+
+    bool collider_subscriptions::compact() {
+        if(m_holes == 0)
+            return false;
+
+        std::erase(m_nodes, nullptr);
+        for(std::uint32_t i = 0; i < m_nodes.size(); i++)
+            m_index_of.at(m_nodes[i]) = i; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < m_nodes.size()
+        m_holes = 0;
+        return true;
+    }
+
+    std::span<node* const> collider_subscriptions::nodes() const {
+        EXPECTS(m_holes == 0);
+        return m_nodes;
+    }
+
+    collision_result broad_phase_collision_detector::check_pair(narrow_phase_job& job, cached_pair& cached, float tolerance) {
+        const glm::mat4 b_to_a = glm::inverse(job.a_trans) * job.b_trans;
+        cached.last_b_to_a = b_to_a;
+
+        // the translation is compared relative to the size of the shapes, the linear part as is
+        const float translation_tolerance = tolerance * (job.a_shape->bounding_sphere_radius + job.b_shape->bounding_sphere_radius);
+        auto unchanged = [&]() {
+            for(int col = 0; col < 4; col++) {
+                for(int row = 0; row < 3; row++) {
+                    if(std::abs(b_to_a[col][row] - cached.b_to_a[col][row]) > (col == 3 ? translation_tolerance : tolerance)) //NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // col < 4, row < 3
+                        return false;
+                }
+            }
+            return true;
+        };
+        if(cached.checked && cached.trigger == job.is_trigger && unchanged()) {
+            job.outcome = pair_cache_outcome::hit;
+            if(job.is_trigger) {
+                job.overlapping = cached.overlapping;
+                return collision_result::null();
+            }
+            if(cached.a_space_versor == glm::vec3(0))
+                return collision_result::null();
+            // a may have moved along with b
+            return { .versor = glm::mat3(job.a_trans) * cached.a_space_versor, .depth = cached.depth };
+        }
+
+        cached.checked = true;
+        cached.trigger = job.is_trigger;
+        cached.b_to_a = b_to_a;
+        if(job.is_trigger) {
+            job.overlapping = check_overlap(*job.a_shape, job.a_trans, *job.b_shape, job.b_trans, cached.hint);
+            job.outcome = cached.hint.separated_early ? pair_cache_outcome::axis_early_out : pair_cache_outcome::miss;
+            cached.overlapping = job.overlapping;
+            return collision_result::null();
+        }
+
+        const collision_result res = check_collision(*job.a_shape, job.a_trans, *job.b_shape, job.b_trans, cached.hint);
+        job.outcome = cached.hint.separated_early ? pair_cache_outcome::axis_early_out : pair_cache_outcome::miss;
+        cached.a_space_versor = res ? glm::inverse(glm::mat3(job.a_trans)) * res.versor : glm::vec3(0);
+        cached.depth = res ? res.depth : 0.f;
+        if(!res && (job.a_from != nullptr || job.b_from != nullptr)) {
+            const glm::mat4& a_from = job.a_from != nullptr ? *job.a_from : job.a_trans;
+            const glm::mat4& b_from = job.b_from != nullptr ? *job.b_from : job.b_trans;
+            if(a_from != job.a_trans || b_from != job.b_trans) {
+                if(const collision_result swept = check_swept_collision(*job.a_shape, a_from, job.a_trans, *job.b_shape, b_from, job.b_trans)) {
+                    // it depends on where the colliders came from, which the cache does not compare
+                    cached.checked = false;
+                    return swept;
+                }
+            }
+        }
+        return res;
+    }
+
+    // whether collisions move n away: n's own behaviour, or that of the ancestors it passes its events to
+    static bool collisions_move_away(node* n) {
+        for(node* cursor = n; cursor != nullptr; cursor = cursor->get_father()) {
+            const node_collision_behaviour& behaviour = cursor->get_collision_behaviour();
+            if(behaviour.moves_away_on_collision)
+                return true;
+            if(!behaviour.passes_events_to_father)
+                return false;
+        }
+        return false;
+    }
+
+    void broad_phase_collision_detector::forget_node(node* n) {
+        m_forgotten_nodes.insert(n);
+        // the triggers n is in, or the colliders in n, exit it now, while it is still alive; it may have lost its collision
+        // shape already (see node::set_payload), so who sees whom is as of the enter event
+        if(m_entered_trigger_pairs != 0) {
+            for(auto& [pair, cached] : m_pair_cache) {
+                if(!cached.trigger_entered || (pair.first != n && pair.second != n))
+                    continue;
+                node* other = pair.first == n ? pair.second : pair.first;
+                if(pair.first == n ? cached.b_sees_a : cached.a_sees_b)
+                    other->react_to_trigger(trigger_event::exit, *n, m_script_profiler);
+                cached.trigger_entered = false;
+                m_entered_trigger_pairs--;
+            }
+        }
+        m_swept_from.erase(n);
+        if(auto it = m_sleep_states.find(n); it != m_sleep_states.end()) {
+            if(it->second.island != no_island)
+                wake_island(it->second.island);
+            m_sleep_states.erase(it);
+        }
+    }
+
+    void broad_phase_collision_detector::update_sleep_states(std::span<node* const> subscribers) {
+        m_continuous_nodes.clear();
+        std::size_t tracked = 0;
+        for(node* n : subscribers) {
+            const node_collision_behaviour& behaviour = n->get_collision_behaviour();
+            const bool is_continuous = behaviour.is_continuous && !behaviour.is_trigger;
+            const bool can_sleep = behaviour.can_sleep && !behaviour.is_trigger;
+            if(is_continuous)
+                m_continuous_nodes.push_back(n);
+            else if(!m_swept_from.empty())
+                m_swept_from.erase(n); // it may have stopped being continuous
+            // the others have no sleep state: the pairs they form with sleeping nodes tell whether they moved (see is_resting_pair)
+            if(!can_sleep && !is_continuous)
+                continue;
+
+            tracked++;
+            auto [it, inserted] = m_sleep_states.try_emplace(n);
+            sleep_state& s = it->second;
+            s.frame = m_frame;
+            s.can_sleep = can_sleep;
+            s.is_moved_away = can_sleep && collisions_move_away(n);
+
+            const glm::mat4& transform = n->get_global_transform();
+            if(inserted || transform != s.transform) {
+                s.transform = transform;
+                s.still_frames = 0;
+                if(s.island != no_island)
+                    wake_island(s.island);
+            } else if(s.island != no_island && !s.can_sleep) {
+                wake_island(s.island);
+            } else if(s.still_frames != std::numeric_limits<std::uint32_t>::max()) {
+                s.still_frames++;
+            }
+        }
+
+        // forget the nodes which stopped needing a sleep state (e.g. they cannot sleep anymore)
+        if(tracked != m_sleep_states.size()) {
+            for(const auto& [n, s] : m_sleep_states) {
+                if(s.frame != m_frame && s.island != no_island)
+                    wake_island(s.island);
+            }
+            std::erase_if(m_sleep_states, [&](const auto& entry) { return entry.second.frame != m_frame; });
+        }
+    }
+
+    aabb broad_phase_collision_detector::collider_aabb(const node* n) const {
+        const collision_shape& shape = n->get<collision_shape>();
+        const glm::mat4& transform = n->get_global_transform();
+        aabb box = shape.world_aabb(transform);
+        if(m_swept_from.empty())
+            return box;
+        if(const auto it = m_swept_from.find(n); it != m_swept_from.end() && it->second != transform)
+            box = box.merge(shape.world_aabb(it->second));
+        return box;
+    }
+
+    void broad_phase_collision_detector::wake_island(std::uint32_t island) {
+        std::vector<const node*>& nodes = m_sleeping_islands[island]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid island index
+        for(const node* n : nodes) {
+            sleep_state& s = m_sleep_states.at(n);
+            s.island = no_island;
+            // woken nodes count as moved: their pairs are checked again, and they stay awake for a while even if they keep still
+            s.still_frames = 0;
+        }
+        nodes.clear();
+        m_free_islands.push_back(island);
+    }
+
+    bool broad_phase_collision_detector::is_asleep(const node* n) const {
+        if(m_sleep_states.empty())
+            return false;
+        const auto it = m_sleep_states.find(n);
+        return it != m_sleep_states.end() && it->second.island != no_island;
+    }
+
+    void broad_phase_collision_detector::wake_up(const node* n) {
+        if(auto it = m_sleep_states.find(n); it != m_sleep_states.end() && it->second.island != no_island)
+            wake_island(it->second.island);
+    }
+
+    bool broad_phase_collision_detector::is_resting_pair(const node* a, const node* b, const cached_pair* cached) const {
+        const auto a_it = m_sleep_states.find(a), b_it = m_sleep_states.find(b);
+        const bool a_asleep = a_it != m_sleep_states.end() && a_it->second.island != no_island;
+        const bool b_asleep = b_it != m_sleep_states.end() && b_it->second.island != no_island;
+        if(!a_asleep && !b_asleep)
+            return false;
+        if(a_it != m_sleep_states.end() && b_it != m_sleep_states.end())
+            return a_it->second.still_frames != 0 && b_it->second.still_frames != 0;
+        // one has no sleep state: the sleeping one did not move (or it would have been woken), so the other did not either
+        // if their relative transform is the same as when the pair was last checked
+        return cached != nullptr && cached->checked && !cached->trigger && cached->last_b_to_a == glm::inverse(a->get_global_transform()) * b->get_global_transform();
+    }
+
+    void broad_phase_collision_detector::wake_on_contact(const node* a, const node* b) {
+        const auto a_it = m_sleep_states.find(a), b_it = m_sleep_states.find(b);
+        // a node without sleep state whose pair was not skipped moved (see is_resting_pair)
+        const bool a_moved = a_it == m_sleep_states.end() || a_it->second.still_frames == 0;
+        const bool b_moved = b_it == m_sleep_states.end() || b_it->second.still_frames == 0;
+        if(a_it != m_sleep_states.end() && a_it->second.island != no_island && b_moved)
+            wake_island(a_it->second.island);
+        else if(b_it != m_sleep_states.end() && b_it->second.island != no_island && a_moved)
+            wake_island(b_it->second.island);
+    }
+
+    void broad_phase_collision_detector::send_trigger_event(node* a, node* b, bool a_sees_b, bool b_sees_a, trigger_event event) {
+        if(a_sees_b)
+            a->react_to_trigger(event, *b, m_script_profiler);
+        if(b_sees_a)
+            b->react_to_trigger(event, *a, m_script_profiler);
+    }
+
+    void broad_phase_collision_detector::fall_asleep() {
+        const std::size_t count = m_sleep_states.size();
+        m_island_parent.resize(count);
+        std::iota(m_island_parent.begin(), m_island_parent.end(), std::uint32_t(0));
+        auto find = [&](std::uint32_t i) {
+            // union-find with path halving
+            while(m_island_parent[i] != i) { // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid state index
+                m_island_parent[i] = m_island_parent[m_island_parent[i]]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid state index
+                i = m_island_parent[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid state index
+            }
+            return i;
+        };
+        auto state_at = [&](std::uint32_t i) -> sleep_state& { return (m_sleep_states.begin() + i)->second; };
+        auto may_join = [](const sleep_state& s) { return s.can_sleep && s.island == no_island; };
+
+        // the islands: awake nodes which can sleep, linked by their contacts with each other, if both are moved away
+        for(std::size_t i = 0; i < m_jobs.size(); i++) {
+            if(!m_results[i]) // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // m_results.size() == m_jobs.size()
+                continue;
+            const narrow_phase_job& job = m_jobs[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < m_jobs.size()
+            const auto a_it = m_sleep_states.find(job.a), b_it = m_sleep_states.find(job.b);
+            if(a_it == m_sleep_states.end() || b_it == m_sleep_states.end())
+                continue;
+            if(may_join(a_it->second) && may_join(b_it->second) && a_it->second.is_moved_away && b_it->second.is_moved_away)
+                m_island_parent[find(std::uint32_t(a_it - m_sleep_states.begin()))] = find(std::uint32_t(b_it - m_sleep_states.begin())); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid state index
+        }
+
+        // an island falls asleep once all of its nodes have kept still long enough
+        m_island_still_frames.assign(count, std::numeric_limits<std::uint32_t>::max());
+        for(std::uint32_t i = 0; i < count; i++) {
+            if(may_join(state_at(i))) {
+                std::uint32_t& still_frames = m_island_still_frames[find(i)]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid state index
+                still_frames = std::min(still_frames, state_at(i).still_frames);
+            }
+        }
+
+        m_new_island.assign(count, no_island);
+        for(std::uint32_t i = 0; i < count; i++) {
+            sleep_state& s = state_at(i);
+            const std::uint32_t root = find(i);
+            if(!may_join(s) || m_island_still_frames[root] < m_sleep_frames) // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid state index
+                continue;
+
+            std::uint32_t& island = m_new_island[root]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid state index
+            if(island == no_island) {
+                if(m_free_islands.empty()) {
+                    island = std::uint32_t(m_sleeping_islands.size());
+                    m_sleeping_islands.emplace_back();
+                } else {
+                    island = m_free_islands.back();
+                    m_free_islands.pop_back();
+                }
+            }
+            m_sleeping_islands[island].push_back((m_sleep_states.begin() + i)->first); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid island index
+            s.island = island;
+        }
+    }
+
+    void broad_phase_collision_detector::narrow_phase_and_react() {
+        m_frame++;
+        if(!m_forgotten_nodes.empty()) {
+            std::erase_if(m_pair_cache, [&](const auto& entry) {
+                return m_forgotten_nodes.contains(entry.first.first) || m_forgotten_nodes.contains(entry.first.second);
+            });
+            m_forgotten_nodes.clear();
+        }
+
+        // gathering the transforms fills their caches, so it has to happen before the parallel part; so does inserting
+        // into the pair cache, which may move its entries
+        const bool any_asleep = m_sleeping_islands.size() != m_free_islands.size();
+        std::size_t resting_pairs_kept = 0;
+        m_jobs.clear();
+        for(const auto& [a, b] : m_candidate_pairs) {
+            //TODO: check layer correctness
+            const auto& a_cs = a->get<collision_shape>();
+            const auto& b_cs = b->get<collision_shape>();
+            bool a_sees_b = bool(a_cs.sees_layers & b_cs.is_layers);
+            bool b_sees_a = bool(b_cs.sees_layers & a_cs.is_layers);
+            if(!a_sees_b && !b_sees_a)
+                continue;
+            const bool is_trigger = a->get_collision_behaviour().is_trigger || b->get_collision_behaviour().is_trigger;
+            // a trigger never sleeps, but it may be still while a sleeping collider lies in it: it must keep seeing it
+            if(any_asleep && !is_trigger) {
+                const auto it = m_pair_cache.find({ a, b });
+                if(is_resting_pair(a, b, it != m_pair_cache.end() ? &it->second : nullptr)) {
+                    // kept, since it may be needed to tell whether the pair is still resting next frame
+                    if(it != m_pair_cache.end()) {
+                        it->second.frame = m_frame;
+                        resting_pairs_kept++;
+                    }
                     continue;
+                }
+            }
 
-                collision_result res = check_collision(a_cs, a->get_global_transform(), b_cs, b->get_global_transform());
+            const auto cached = m_pair_cache.try_emplace({ a, b }).first;
+            cached->second.frame = m_frame;
+
+            const glm::mat4* a_from = nullptr;
+            const glm::mat4* b_from = nullptr;
+            if(!m_swept_from.empty() && !is_trigger) {
+                if(const auto it = m_swept_from.find(a); it != m_swept_from.end())
+                    a_from = &it->second;
+                if(const auto it = m_swept_from.find(b); it != m_swept_from.end())
+                    b_from = &it->second;
+            }
 
-                if(res) {
-                    if(a_sees_b)
-                        a->react_to_collision(res, *b);
-                    if(b_sees_a)
-                        b->react_to_collision(-res, *a);
+            m_jobs.push_back({
+                .a = a, .b = b, .a_shape = &a_cs, .b_shape = &b_cs,
+                .a_trans = a->get_global_transform(), .b_trans = b->get_global_transform(),
+                .a_sees_b = a_sees_b, .b_sees_a = b_sees_a, .is_trigger = is_trigger, .a_from = a_from, .b_from = b_from,
+                .cache_index = std::uint32_t(cached - m_pair_cache.begin()), .outcome = pair_cache_outcome::miss, .overlapping = false,
+            });
+        }
+
+        m_results.resize(m_jobs.size());
+        const float tolerance = m_pair_cache_tolerance;
+        auto narrow_phase = [&](std::size_t begin, std::size_t end) {
+            for(std::size_t i = begin; i < end; i++) {
+                narrow_phase_job& job = m_jobs[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < m_jobs.size()
+                cached_pair& cached = (m_pair_cache.begin() + job.cache_index)->second; // each pair has its own entry
+                m_results[i] = check_pair(job, cached, tolerance); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // m_results.size() == m_jobs.size()
+            }
+        };
+        // pairs far apart are rejected in well under a microsecond: smaller chunks would cost more to hand out than to run
+        constexpr std::size_t min_chunk_size = 32;
+        if(m_thread_pool != nullptr)
+            m_thread_pool->parallel_for(m_jobs.size(), min_chunk_size, narrow_phase);
+        else
+            narrow_phase(0, m_jobs.size());
+
+        for(std::size_t i = 0; i < m_jobs.size(); i++) {
+            const narrow_phase_job& job = m_jobs[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < m_jobs.size()
+            const collision_result& res = m_results[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // m_results.size() == m_jobs.size()
+            switch(job.outcome) {
+                case pair_cache_outcome::hit: m_pair_cache_stats.hits++; break;
+                case pair_cache_outcome::axis_early_out: m_pair_cache_stats.axis_early_outs++; break;
+                case pair_cache_outcome::miss: m_pair_cache_stats.misses++; break;
+            }
+            cached_pair& cached = (m_pair_cache.begin() + job.cache_index)->second;
+            if(job.is_trigger) {
+                if(job.overlapping)
+                    send_trigger_event(job.a, job.b, job.a_sees_b, job.b_sees_a, cached.trigger_entered ? trigger_event::stay : trigger_event::enter);
+                else if(cached.trigger_entered) // the exit goes to who was sent the enter event
+                    send_trigger_event(job.a, job.b, cached.a_sees_b, cached.b_sees_a, trigger_event::exit);
+                if(job.overlapping && !cached.trigger_entered) {
+                    m_entered_trigger_pairs++;
+                    cached.a_sees_b = job.a_sees_b;
+                    cached.b_sees_a = job.b_sees_a;
                 }
+                else if(!job.overlapping && cached.trigger_entered)
+                    m_entered_trigger_pairs--;
+                cached.trigger_entered = job.overlapping;
+                continue;
+            }
+            if(cached.trigger_entered) {
+                // neither collider is a trigger anymore
+                send_trigger_event(job.a, job.b, cached.a_sees_b, cached.b_sees_a, trigger_event::exit);
+                cached.trigger_entered = false;
+                m_entered_trigger_pairs--;
+            }
+            if(res) {
+                if(any_asleep)
+                    wake_on_contact(job.a, job.b);
+                if(job.a_sees_b)
+                    job.a->react_to_collision(res, *job.b, m_script_profiler, &m_resolver, { .pair = std::uint32_t(i), .second = false });
+                if(job.b_sees_a)
+                    job.b->react_to_collision(-res, *job.a, m_script_profiler, &m_resolver, { .pair = std::uint32_t(i), .second = true });
+            }
+        }
+        m_resolver.solve_and_apply(m_thread_pool);
+        // where the continuous colliders will be swept from next frame: where they ended up, once moved away
+        for(const node* n : m_continuous_nodes)
+            m_swept_from.insert_or_assign(n, n->get_global_transform());
+        if(!m_sleep_states.empty())
+            fall_asleep();
+
+        // every job touched its own entry, and so did the resting pairs kept: any other one belongs to a pair which stopped
+        // being a candidate, and whose colliders (if they overlapped as trigger) exit each other
+        if(m_pair_cache.size() > m_jobs.size() + resting_pairs_kept) {
+            for(const auto& [pair, cached] : m_pair_cache) {
+                if(cached.frame == m_frame || !cached.trigger_entered)
+                    continue;
+                send_trigger_event(pair.first, pair.second, cached.a_sees_b, cached.b_sees_a, trigger_event::exit);
+                m_entered_trigger_pairs--;
+            }
+            std::erase_if(m_pair_cache, [&](const auto& entry) { return entry.second.frame != m_frame; });
+        }
+    }
+
+    // the candidates of a spatial query; queries may run on several threads at once
+    static std::vector<node*>& query_candidates() {
+        thread_local std::vector<node*> candidates;
+        return candidates;
+    }
+
+    // the shapes the overlap queries test the candidates against: a sphere, and a unit cube scaled to the box
+    static collision_shape query_sphere(const sphere_overlap_query& query) {
+        return collision_shape::sphere({ .radius = query.radius, .center = query.center }, 0, 0);
+    }
+    static const collision_shape& unit_cube() {
+        static const collision_shape cube = collision_shape::box({ .half_extents = glm::vec3(1) }, 0, 0);
+        return cube;
+    }
+    static glm::mat4 unit_cube_to(const aabb& box) {
+        // flat boxes are given some thickness, so that the transform stays invertible
+        const glm::vec3 half_extents = glm::max(box.extent() * .5f, glm::vec3(1e-6f));
+        return glm::scale(glm::translate(glm::mat4(1), (box.min + box.max) * .5f), half_extents);
+    }
+
+    void broad_phase_collision_detector::colliders_along_segment(glm::vec3 from, glm::vec3 to, std::vector<node*>& out) const {
+        colliders_in_aabb({ .min = glm::min(from, to), .max = glm::max(from, to) }, out);
+    }
+
+    template<typename F>
+    void broad_phase_collision_detector::for_each_overlapping(const collision_shape& shape, const glm::mat4& trans, const aabb& box, collision_layers_bitmask layers, F&& f) const {
+        std::vector<node*>& candidates = query_candidates();
+        candidates.clear();
+        colliders_in_aabb(box, candidates);
+        for(node* n : candidates) {
+            const collision_shape& collider = n->get<collision_shape>();
+            if((collider.is_layers & layers) != 0 && check_collision(collider, n->get_global_transform(), shape, trans))
+                f(n);
+        }
+    }
+
+    std::optional<spatial_query_hit> broad_phase_collision_detector::raycast(const raycast_query& query) const {
+        EXPECTS(query.max_distance >= 0.f && std::isfinite(query.max_distance));
+        std::vector<node*>& candidates = query_candidates();
+        candidates.clear();
+        colliders_along_segment(query.origin, query.origin + query.max_distance * query.direction, candidates);
+
+        std::optional<spatial_query_hit> closest;
+        float max_distance = query.max_distance;
+        for(node* n : candidates) {
+            const collision_shape& shape = n->get<collision_shape>();
+            if((shape.is_layers & query.layers) == 0)
+                continue;
+            // each hit shortens the ray for the candidates after it
+            if(const std::optional<ray_hit> hit = check_ray(shape, n->get_global_transform(), query.origin, query.direction, max_distance); hit && (!closest || hit->distance < closest->distance)) {
+                max_distance = hit->distance;
+                closest = spatial_query_hit { .collider = n, .distance = hit->distance, .point = query.origin + hit->distance * query.direction, .normal = hit->normal };
             }
         }
+        return closest;
+    }
+
+    void broad_phase_collision_detector::sphere_overlap(const sphere_overlap_query& query, std::vector<node*>& out) const {
+        EXPECTS(query.radius >= 0.f);
+        out.clear();
+        const aabb box = { .min = query.center - query.radius, .max = query.center + query.radius };
+        for_each_overlapping(query_sphere(query), glm::mat4(1), box, query.layers, [&](node* n) { out.push_back(n); });
+    }
+
+    void broad_phase_collision_detector::aabb_overlap(const aabb_overlap_query& query, std::vector<node*>& out) const {
+        EXPECTS(!query.box.is_empty());
+        out.clear();
+        for_each_overlapping(unit_cube(), unit_cube_to(query.box), query.box, query.layers, [&](node* n) { out.push_back(n); });
+    }
+
+    void broad_phase_collision_detector::k_nearest(const k_nearest_query& query, std::vector<spatial_query_hit>& out) const {
+        EXPECTS(query.max_distance >= 0.f && std::isfinite(query.max_distance));
+        out.clear();
+        if(query.k == 0)
+            return;
+
+        std::vector<node*>& candidates = query_candidates();
+        candidates.clear();
+        colliders_in_aabb({ .min = query.point - query.max_distance, .max = query.point + query.max_distance }, candidates);
+
+        const collision_shape point = collision_shape::sphere({ .radius = 0.f, .center = query.point }, 0, 0);
+        for(node* n : candidates) {
+            const collision_shape& shape = n->get<collision_shape>();
+            if((shape.is_layers & query.layers) == 0)
+                continue;
+            const std::optional<collision_distance_result> distance = collision_distance(point, glm::mat4(1), shape, n->get_global_transform());
+            if(!distance)
+                out.push_back({ .collider = n, .distance = 0.f, .point = query.point });
+            else if(distance->distance <= query.max_distance)
+                out.push_back({ .collider = n, .distance = distance->distance, .point = distance->b_point });
+        }
+
+        auto by_distance = [](const spatial_query_hit& a, const spatial_query_hit& b) { return a.distance < b.distance; };
+        if(out.size() > query.k) {
+            std::ranges::nth_element(out, out.begin() + std::ptrdiff_t(query.k), by_distance);
+            out.resize(query.k);
+        }
+        std::ranges::sort(out, by_distance);
+    }
+
+    void broad_phase_collision_detector::answer_query(const spatial_query& query, std::vector<spatial_query_hit>& out) const {
+        std::visit(merge_callables {
+            [&](const raycast_query& q) {
+                if(const std::optional<spatial_query_hit> hit = raycast(q))
+                    out.push_back(*hit);
+            },
+            [&](const sphere_overlap_query& q) {
+                EXPECTS(q.radius >= 0.f);
+                const aabb box = { .min = q.center - q.radius, .max = q.center + q.radius };
+                for_each_overlapping(query_sphere(q), glm::mat4(1), box, q.layers, [&](node* n) { out.push_back({ .collider = n }); });
+            },
+            [&](const aabb_overlap_query& q) {
+                EXPECTS(!q.box.is_empty());
+                for_each_overlapping(unit_cube(), unit_cube_to(q.box), q.box, q.layers, [&](node* n) { out.push_back({ .collider = n }); });
+            },
+            [&](const k_nearest_query& q) {
+                thread_local std::vector<spatial_query_hit> nearest;
+                k_nearest(q, nearest);
+                out.insert(out.end(), nearest.begin(), nearest.end());
+            },
+        }, query);
+    }
+
+    void broad_phase_collision_detector::run_queries(std::span<const spatial_query> queries, spatial_query_results& results) const {
+        results.m_hits.clear();
+        results.m_begin.assign(queries.size() + 1, 0);
+        if(queries.empty())
+            return;
+
+        // reading a global transform fills its cache if needed, which is not thread safe: fill them all beforehand
+        std::vector<node*>& colliders = query_candidates();
+        colliders.clear();
+        constexpr float inf = std::numeric_limits<float>::infinity();
+        colliders_in_aabb({ .min = glm::vec3(-inf), .max = glm::vec3(inf) }, colliders);
+        for(node* n : colliders)
+            n->get_global_transform();
+
+        // each chunk of queries answers into its own buffer, and stores the queries' hit counts in m_begin (shifted by one,
+        // so that summing them up turns them into offsets); the buffers are joined in order afterwards
+        struct chunk_hits {
+            std::size_t begin;
+            std::vector<spatial_query_hit> hits;
+        };
+        std::vector<chunk_hits> chunks;
+        std::mutex chunks_mutex;
+        auto answer = [&](std::size_t begin, std::size_t end) {
+            std::vector<spatial_query_hit> hits;
+            for(std::size_t i = begin; i < end; i++) {
+                const std::size_t hits_before = hits.size();
+                answer_query(queries[i], hits); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < end <= queries.size()
+                results.m_begin[i + 1] = std::uint32_t(hits.size() - hits_before); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i + 1 <= queries.size()
+            }
+            const std::scoped_lock lock(chunks_mutex);
+            chunks.push_back({ .begin = begin, .hits = std::move(hits) });
+        };
+        constexpr std::size_t min_chunk_size = 16;
+        if(m_thread_pool != nullptr)
+            m_thread_pool->parallel_for(queries.size(), min_chunk_size, answer);
+        else
+            answer(0, queries.size());
+
+        std::ranges::sort(chunks, {}, &chunk_hits::begin);
+        for(const chunk_hits& c : chunks)
+            results.m_hits.insert(results.m_hits.end(), c.hits.begin(), c.hits.end());
+        std::inclusive_scan(results.m_begin.begin(), results.m_begin.end(), results.m_begin.begin());
+    }
+
+    // defined here rather than in the header so that the vtable is emitted (and exported) along with it
+    pass_all_broad_phase_collision_detector::pass_all_broad_phase_collision_detector() = default;
+
+    void pass_all_broad_phase_collision_detector::check_collisions_and_trigger_reactions() {
+        m_subscribers.compact();
+        const std::span<node* const> subscribers = m_subscribers.nodes();
+        update_sleep_states(subscribers);
+
+        if(m_subscriptions_changed) {
+            m_buckets.clear_members();
+            for(std::uint32_t i = 0; i < subscribers.size(); i++) {
+                node* n = assert_nonnull(subscribers[i]); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < subscribers.size()
+                EXPECTS(n->has<rc<const collision_shape>>());
+                m_buckets.add(i, n->get<collision_shape>());
+            }
+            m_subscriptions_changed = false;
+        }
+
+        // pairs come sorted, so they are handled in the same order as if all of them were enumerated
+        m_candidate_pairs.clear();
+        m_buckets.for_each_interacting_pair([&](std::uint32_t i, std::uint32_t j) {
+            m_candidate_pairs.emplace_back(subscribers[i], subscribers[j]); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i, j < subscribers.size()
+        });
+        narrow_phase_and_react();
     }
 
     void pass_all_broad_phase_collision_detector::subscribe(node* n) {
-        m_subscribers.push_back(n);
+        m_subscribers.add(n);
+        m_subscriptions_changed = true;
+    }
+
+    void pass_all_broad_phase_collision_detector::unsubscribe(node* n) {
+        m_subscribers.remove(n);
+        forget_node(n);
+        m_subscriptions_changed = true;
     }
 
-    void pass_all_broad_phase_collision_detector::reset_subscriptions() {
-        m_subscribers.clear();
+    void pass_all_broad_phase_collision_detector::colliders_in_aabb(const aabb& box, std::vector<node*>& out) const {
+        for(node* n : m_subscribers.nodes_and_holes()) {
+            if(n != nullptr && n->get<collision_shape>().world_aabb(n->get_global_transform()).overlaps(box))
+                out.push_back(n);
+        }
     }
 }
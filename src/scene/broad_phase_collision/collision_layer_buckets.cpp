@@ -0,0 +1,44 @@
+#include <engine/scene/broad_phase_collision/collision_layer_buckets.hpp>
+#include <slogga/asserts.hpp>
+
+namespace engine {
+    auto collision_layer_buckets::bucket_of(const collision_shape& shape) -> bucket_index_t {
+        auto [it, inserted] = m_bucket_of_masks.try_emplace({ shape.is_layers, shape.sees_layers }, (bucket_index_t)m_buckets.size());
+        if(!inserted)
+            return it->second;
+
+        m_buckets.push_back({ .is_layers = shape.is_layers, .sees_layers = shape.sees_layers, .members = {} });
+
+        // grow the matrix by a row and a column, moving the old rows to their new positions
+        const std::size_t n = m_buckets.size();
+        std::vector<std::uint8_t> interacts(n * n);
+        for(std::size_t a = 0; a < n - 1; a++)
+            for(std::size_t b = 0; b < n - 1; b++)
+                interacts[a * n + b] = m_interacts[a * (n - 1) + b]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // a, b < n - 1
+
+        const bucket& new_bucket = m_buckets.back();
+        for(std::size_t a = 0; a < n; a++) {
+            const bucket& other = m_buckets[a]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // a < n
+            const bool v = (new_bucket.sees_layers & other.is_layers) || (other.sees_layers & new_bucket.is_layers);
+            interacts[a * n + (n - 1)] = v; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // a < n
+            interacts[(n - 1) * n + a] = v; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // a < n
+        }
+        m_interacts = std::move(interacts);
+
+        return it->second;
+    }
+
+    auto collision_layer_buckets::add(std::uint32_t index, const collision_shape& shape) -> bucket_index_t {
+        EXPECTS(index == m_bucket_of_collider.size());
+        const bucket_index_t b = bucket_of(shape);
+        m_buckets[b].members.push_back(index); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid bucket index
+        m_bucket_of_collider.push_back(b);
+        return b;
+    }
+
+    void collision_layer_buckets::clear_members() {
+        for(bucket& b : m_buckets)
+            b.members.clear();
+        m_bucket_of_collider.clear();
+    }
+}
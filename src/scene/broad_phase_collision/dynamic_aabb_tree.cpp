@@ -0,0 +1,334 @@
+#include <engine/scene/broad_phase_collision/dynamic_aabb_tree.hpp>
+#include <engine/scene/node/narrow_phase_collision.hpp>
+#include <engine/scene/node.hpp>
+#include <algorithm>
+#include <slogga/asserts.hpp>
+
+namespace engine {
+    dynamic_aabb_tree_broad_phase_collision_detector::dynamic_aabb_tree_broad_phase_collision_detector(float fat_margin)
+        : m_fat_margin(fat_margin) {
+        EXPECTS(fat_margin >= 0.f);
+    }
+
+    void dynamic_aabb_tree_broad_phase_collision_detector::subscribe(node* n) {
+        EXPECTS(n->has<rc<const collision_shape>>());
+        m_subscribers.add(n);
+        // the leaf is created by the next check, once the aabb is known
+        m_proxies.emplace(n, proxy{ .bucket = m_buckets.bucket_of(n->get<collision_shape>()), .order = (std::uint32_t)m_subscribers.size() - 1 });
+    }
+
+    void dynamic_aabb_tree_broad_phase_collision_detector::unsubscribe(node* n) {
+        m_subscribers.remove(n);
+        forget_node(n);
+        index_t leaf = m_proxies.at(n).leaf;
+        if(leaf != null_index) {
+            remove_leaf(leaf);
+            free_node(leaf);
+        }
+        m_proxies.erase(n);
+    }
+
+    void dynamic_aabb_tree_broad_phase_collision_detector::check_collisions_and_trigger_reactions() {
+        // if some colliders unsubscribed the others' indices changed
+        if(m_subscribers.compact()) {
+            const std::span<node* const> subscribers = m_subscribers.nodes();
+            for(std::uint32_t i = 0; i < subscribers.size(); i++)
+                m_proxies.at(subscribers[i]).order = i; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < subscribers.size()
+        }
+        const std::span<node* const> subscribers = m_subscribers.nodes();
+        update_sleep_states(subscribers);
+
+        // update the leaves: only reinsert those which moved out of their fat aabb
+        for(node* n : subscribers) {
+            proxy& p = m_proxies.at(n);
+            p.asleep = is_asleep(n);
+            if(p.asleep && p.leaf != null_index)
+                continue;
+            p.tight_box = collider_aabb(n);
+
+            if(p.leaf != null_index && at(p.leaf).box.contains(p.tight_box))
+                continue;
+
+            if(p.leaf == null_index) {
+                p.leaf = allocate_node();
+                at(p.leaf).n = n;
+            } else {
+                remove_leaf(p.leaf);
+            }
+            at(p.leaf).box = p.tight_box.expand(m_fat_margin);
+            insert_leaf(p.leaf);
+        }
+
+        // find candidate pairs: each pair is reported by the query of the proxy which subscribed first, or by the awake one
+        // if the other is asleep, always ordered by subscription; pairs of sleeping proxies are not reported at all
+        m_pairs.clear();
+        for(node* n : subscribers) {
+            proxy& p = m_proxies.at(n);
+            if(p.asleep)
+                continue;
+
+            m_query_stack.clear();
+            if(m_root != null_index)
+                m_query_stack.push_back(m_root);
+
+            while(!m_query_stack.empty()) {
+                const tree_node& t = at(m_query_stack.back());
+                m_query_stack.pop_back();
+
+                if(!t.box.overlaps(p.tight_box))
+                    continue;
+
+                if(t.is_leaf()) {
+                    // the leaf's box is fat: check the tight ones before handing the pair to the (much more expensive) narrow phase
+                    proxy& other = m_proxies.at(t.n);
+                    if((other.order > p.order || other.asleep) && m_buckets.interact(p.bucket, other.bucket) && other.tight_box.overlaps(p.tight_box)) {
+                        if(other.order > p.order)
+                            m_pairs.emplace_back(&p, &other);
+                        else
+                            m_pairs.emplace_back(&other, &p);
+                    }
+                } else {
+                    m_query_stack.push_back(t.child1);
+                    m_query_stack.push_back(t.child2);
+                }
+            }
+        }
+
+        std::ranges::sort(m_pairs, {}, [](const std::pair<proxy*, proxy*>& pair) { return std::pair(pair.first->order, pair.second->order); });
+
+        m_candidate_pairs.clear();
+        for(const auto& [a, b] : m_pairs) {
+            node* a_node = subscribers[a->order]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // order < subscribers.size()
+            node* b_node = subscribers[b->order]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // order < subscribers.size()
+            m_candidate_pairs.emplace_back(a_node, b_node);
+        }
+        narrow_phase_and_react();
+    }
+
+    template<typename F>
+    void dynamic_aabb_tree_broad_phase_collision_detector::query_tree(F&& overlaps, std::vector<node*>& out) const {
+        // not m_query_stack: queries may run on several threads at once
+        thread_local std::vector<index_t> stack;
+        stack.clear();
+        if(m_root != null_index)
+            stack.push_back(m_root);
+
+        while(!stack.empty()) {
+            const tree_node& t = at(stack.back());
+            stack.pop_back();
+
+            if(!overlaps(t.box))
+                continue;
+
+            if(t.is_leaf()) {
+                out.push_back(t.n);
+            } else {
+                stack.push_back(t.child1);
+                stack.push_back(t.child2);
+            }
+        }
+    }
+
+    void dynamic_aabb_tree_broad_phase_collision_detector::colliders_in_aabb(const aabb& box, std::vector<node*>& out) const {
+        query_tree([&](const aabb& node_box) { return node_box.overlaps(box); }, out);
+    }
+
+    void dynamic_aabb_tree_broad_phase_collision_detector::colliders_along_segment(glm::vec3 from, glm::vec3 to, std::vector<node*>& out) const {
+        const glm::vec3 delta = to - from;
+        // slab test: whether the segment's part within each axis' slab, [t_min, t_max] of from + t * delta, is ever common to all three
+        query_tree([&](const aabb& node_box) {
+            float t_min = 0.f, t_max = 1.f;
+            for(int axis = 0; axis < 3; axis++) {
+                if(delta[axis] == 0.f) { // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // axis < 3
+                    if(from[axis] < node_box.min[axis] || from[axis] > node_box.max[axis]) // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // axis < 3
+                        return false;
+                    continue;
+                }
+                const float t0 = (node_box.min[axis] - from[axis]) / delta[axis]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // axis < 3
+                const float t1 = (node_box.max[axis] - from[axis]) / delta[axis]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // axis < 3
+                t_min = std::max(t_min, std::min(t0, t1));
+                t_max = std::min(t_max, std::max(t0, t1));
+                if(t_min > t_max)
+                    return false;
+            }
+            return true;
+        }, out);
+    }
+
+    auto dynamic_aabb_tree_broad_phase_collision_detector::allocate_node() -> index_t {
+        if(m_free_list == null_index) {
+            m_nodes.emplace_back();
+            return index_t(m_nodes.size() - 1);
+        }
+
+        index_t i = m_free_list;
+        m_free_list = at(i).parent;
+        at(i) = tree_node{};
+        return i;
+    }
+
+    void dynamic_aabb_tree_broad_phase_collision_detector::free_node(index_t i) {
+        at(i) = tree_node{ .parent = m_free_list, .height = -1 };
+        m_free_list = i;
+    }
+
+    void dynamic_aabb_tree_broad_phase_collision_detector::insert_leaf(index_t leaf) {
+        if(m_root == null_index) {
+            m_root = leaf;
+            at(leaf).parent = null_index;
+            return;
+        }
+
+        // find the best sibling, descending the tree with the surface area heuristic
+        const aabb leaf_box = at(leaf).box;
+        index_t i = m_root;
+        while(!at(i).is_leaf()) {
+            const tree_node& t = at(i);
+            float area = t.box.area();
+            float combined_area = t.box.merge(leaf_box).area();
+
+            // cost of making a new parent for this node and the leaf
+            float cost = 2.f * combined_area;
+            // minimum cost of pushing the leaf further down the tree
+            float inheritance_cost = 2.f * (combined_area - area);
+
+            auto descend_cost = [&](index_t c) {
+                const tree_node& child = at(c);
+                float merged_area = child.box.merge(leaf_box).area();
+                return child.is_leaf() ? merged_area + inheritance_cost : merged_area - child.box.area() + inheritance_cost;
+            };
+            float cost1 = descend_cost(t.child1);
+            float cost2 = descend_cost(t.child2);
+
+            if(cost < cost1 && cost < cost2)
+                break;
+
+            i = cost1 < cost2 ? t.child1 : t.child2;
+        }
+        const index_t sibling = i;
+
+        // create a new parent for the sibling and the leaf
+        const index_t old_parent = at(sibling).parent;
+        const index_t new_parent = allocate_node();
+        at(new_parent).parent = old_parent;
+        at(new_parent).box = leaf_box.merge(at(sibling).box);
+        at(new_parent).height = at(sibling).height + 1;
+        at(new_parent).child1 = sibling;
+        at(new_parent).child2 = leaf;
+        at(sibling).parent = new_parent;
+        at(leaf).parent = new_parent;
+
+        if(old_parent != null_index) {
+            if(at(old_parent).child1 == sibling)
+                at(old_parent).child1 = new_parent;
+            else
+                at(old_parent).child2 = new_parent;
+        } else {
+            m_root = new_parent;
+        }
+
+        refit_ancestors(at(leaf).parent);
+    }
+
+    void dynamic_aabb_tree_broad_phase_collision_detector::remove_leaf(index_t leaf) {
+        if(leaf == m_root) {
+            m_root = null_index;
+            return;
+        }
+
+        const index_t parent = at(leaf).parent;
+        const index_t grandparent = at(parent).parent;
+        const index_t sibling = at(parent).child1 == leaf ? at(parent).child2 : at(parent).child1;
+
+        // replace the parent with the sibling
+        if(grandparent != null_index) {
+            if(at(grandparent).child1 == parent)
+                at(grandparent).child1 = sibling;
+            else
+                at(grandparent).child2 = sibling;
+            at(sibling).parent = grandparent;
+            free_node(parent);
+
+            refit_ancestors(grandparent);
+        } else {
+            m_root = sibling;
+            at(sibling).parent = null_index;
+            free_node(parent);
+        }
+
+        at(leaf).parent = null_index;
+    }
+
+    void dynamic_aabb_tree_broad_phase_collision_detector::refit_ancestors(index_t i) {
+        while(i != null_index) {
+            i = balance(i);
+
+            tree_node& t = at(i);
+            t.height = 1 + std::max(at(t.child1).height, at(t.child2).height);
+            t.box = at(t.child1).box.merge(at(t.child2).box);
+
+            i = t.parent;
+        }
+    }
+
+    // if a's subtrees' heights differ by more than one, rotate the taller child up; returns the index of the new root of the subtree
+    auto dynamic_aabb_tree_broad_phase_collision_detector::balance(index_t a_idx) -> index_t {
+        tree_node& a = at(a_idx);
+        if(a.is_leaf() || a.height < 2)
+            return a_idx;
+
+        const index_t b_idx = a.child1, c_idx = a.child2;
+        tree_node& b = at(b_idx);
+        tree_node& c = at(c_idx);
+        const std::int32_t imbalance = c.height - b.height;
+
+        // make child (the taller child) the root of the subtree, moving a down; child's shorter child replaces it as a's child
+        auto rotate_up = [&](index_t child_idx, tree_node& child, tree_node& other, bool child_is_child2) {
+            const index_t f_idx = child.child1, g_idx = child.child2;
+            tree_node& f = at(f_idx);
+            tree_node& g = at(g_idx);
+
+            child.child1 = a_idx;
+            child.parent = a.parent;
+            a.parent = child_idx;
+
+            if(child.parent != null_index) {
+                tree_node& parent = at(child.parent);
+                if(parent.child1 == a_idx)
+                    parent.child1 = child_idx;
+                else
+                    parent.child2 = child_idx;
+            } else {
+                m_root = child_idx;
+            }
+
+            // keep the taller grandchild under child, give the shorter one to a
+            const bool f_is_taller = f.height > g.height;
+            const index_t taller_idx = f_is_taller ? f_idx : g_idx;
+            const index_t shorter_idx = f_is_taller ? g_idx : f_idx;
+            tree_node& taller = at(taller_idx);
+            tree_node& shorter = at(shorter_idx);
+
+            child.child2 = taller_idx;
+            if(child_is_child2)
+                a.child2 = shorter_idx;
+            else
+                a.child1 = shorter_idx;
+            shorter.parent = a_idx;
+
+            a.box = other.box.merge(shorter.box);
+            child.box = a.box.merge(taller.box);
+            a.height = 1 + std::max(other.height, shorter.height);
+            child.height = 1 + std::max(a.height, taller.height);
+
+            return child_idx;
+        };
+
+        if(imbalance > 1)
+            return rotate_up(c_idx, c, b, true);
+        if(imbalance < -1)
+            return rotate_up(b_idx, b, c, false);
+
+        return a_idx;
+    }
+}
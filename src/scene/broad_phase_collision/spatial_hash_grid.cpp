@@ -0,0 +1,223 @@
+#include <engine/scene/broad_phase_collision/spatial_hash_grid.hpp>
+#include <engine/scene/node/narrow_phase_collision.hpp>
+#include <engine/scene/node.hpp>
+#include <algorithm>
+#include <bit>
+#include <slogga/asserts.hpp>
+
+namespace engine {
+    spatial_hash_grid_broad_phase_collision_detector::spatial_hash_grid_broad_phase_collision_detector(float cell_size, std::uint32_t max_cells_per_collider)
+        : m_cell_size(cell_size), m_max_cells_per_collider(max_cells_per_collider) {
+        EXPECTS(cell_size > 0.f);
+        EXPECTS(max_cells_per_collider > 0);
+    }
+
+    void spatial_hash_grid_broad_phase_collision_detector::set_cell_size(float cell_size) {
+        EXPECTS(cell_size > 0.f);
+        m_cell_size = cell_size;
+    }
+
+    void spatial_hash_grid_broad_phase_collision_detector::subscribe(node* n) {
+        m_subscribers.add(n);
+    }
+
+    void spatial_hash_grid_broad_phase_collision_detector::unsubscribe(node* n) {
+        m_subscribers.remove(n);
+        forget_node(n);
+    }
+
+    template<typename F>
+    void spatial_hash_grid_broad_phase_collision_detector::for_each_cell(const collider& c, F&& f) {
+        for(int x = c.min_cell.x; x <= c.max_cell.x; x++)
+            for(int y = c.min_cell.y; y <= c.max_cell.y; y++)
+                for(int z = c.min_cell.z; z <= c.max_cell.z; z++)
+                    f(glm::ivec3(x, y, z));
+    }
+
+    std::uint32_t spatial_hash_grid_broad_phase_collision_detector::cell_hash(glm::ivec3 cell) {
+        std::uint32_t h = (std::uint32_t(cell.x) * 73856093u) ^ (std::uint32_t(cell.y) * 19349663u) ^ (std::uint32_t(cell.z) * 83492791u);
+        h = (h ^ (h >> 16)) * 0x45d9f3bu;
+        h ^= h >> 16;
+        return h;
+    }
+
+    auto spatial_hash_grid_broad_phase_collision_detector::find_or_insert_slot(glm::ivec3 cell) -> cell_slot& {
+        // linear probing; the table is never more than half full, so an empty slot is always found
+        const std::size_t mask = m_slots.size() - 1;
+        for(std::size_t i = cell_hash(cell) & mask; ; i = (i + 1) & mask) {
+            cell_slot& slot = m_slots[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i <= mask < m_slots.size()
+            if(slot.count == empty_slot) {
+                slot.cell = cell;
+                slot.count = 0;
+                return slot;
+            }
+            if(slot.cell == cell)
+                return slot;
+        }
+    }
+
+    auto spatial_hash_grid_broad_phase_collision_detector::find_slot(glm::ivec3 cell) const -> const cell_slot* {
+        if(m_slots.empty())
+            return nullptr;
+
+        const std::size_t mask = m_slots.size() - 1;
+        for(std::size_t i = cell_hash(cell) & mask; ; i = (i + 1) & mask) {
+            const cell_slot& slot = m_slots[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i <= mask < m_slots.size()
+            if(slot.count == empty_slot)
+                return nullptr;
+            if(slot.cell == cell)
+                return &slot;
+        }
+    }
+
+    void spatial_hash_grid_broad_phase_collision_detector::colliders_in_aabb(const aabb& box, std::vector<node*>& out) const {
+        // m_colliders are as of the last check: since then nodes may have been removed (leaving holes) or added after them
+        const std::span<node* const> nodes = m_subscribers.nodes_and_holes();
+        auto add = [&](std::uint32_t i) {
+            node* n = nodes[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < m_colliders.size() <= nodes.size()
+            if(n != nullptr && m_colliders[i].box.overlaps(box)) // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < m_colliders.size()
+                out.push_back(n);
+        };
+
+        const glm::vec3 min_cell = glm::floor(box.min / m_cell_size), max_cell = glm::floor(box.max / m_cell_size);
+        const glm::vec3 cells_per_axis = max_cell - min_cell + 1.f;
+        // written so that infinite (or nan) cell counts fail, and so do cells whose coordinates do not fit in an int
+        const bool few_cells = cells_per_axis.x * cells_per_axis.y * cells_per_axis.z <= float(m_colliders.size())
+            && glm::all(glm::lessThan(glm::abs(min_cell), glm::vec3(1e9f))) && glm::all(glm::lessThan(glm::abs(max_cell), glm::vec3(1e9f)));
+        if(!few_cells) {
+            for(std::uint32_t i = 0; i < m_colliders.size(); i++)
+                add(i);
+            return;
+        }
+
+        const collider query = { .box = box, .bucket = 0, .min_cell = glm::ivec3(min_cell), .max_cell = glm::ivec3(max_cell), .oversized = false };
+        for_each_cell(query, [&](glm::ivec3 cell) {
+            const cell_slot* slot = find_slot(cell);
+            if(slot == nullptr)
+                return;
+            for(std::uint32_t a = slot->begin; a < slot->begin + slot->count; a++) {
+                const std::uint32_t i = m_cell_contents[a]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // a < m_cell_contents.size()
+                // a collider may share many cells with the box: only report it in the first cell of their ranges' intersection
+                if(glm::max(m_colliders[i].min_cell, query.min_cell) == cell) // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid collider index
+                    add(i);
+            }
+        });
+        for(std::uint32_t i : m_oversized)
+            add(i);
+    }
+
+    void spatial_hash_grid_broad_phase_collision_detector::check_collisions_and_trigger_reactions() {
+        m_subscribers.compact();
+        const std::span<node* const> subscribers = m_subscribers.nodes();
+        update_sleep_states(subscribers);
+
+        // compute the colliders' aabbs and the range of cells they touch
+        m_colliders.resize(subscribers.size());
+        m_oversized.clear();
+        std::size_t total_cells = 0;
+        for(std::size_t i = 0; i < subscribers.size(); i++) {
+            node* n = subscribers[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < subscribers.size()
+            EXPECTS(n->has<rc<const collision_shape>>());
+
+            collider& c = m_colliders[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // m_colliders.size() == subscribers.size()
+            const collision_shape& shape = n->get<collision_shape>();
+            c.box = collider_aabb(n);
+            c.bucket = m_buckets.bucket_of(shape);
+            const glm::vec3 min_cell = glm::floor(c.box.min / m_cell_size), max_cell = glm::floor(c.box.max / m_cell_size);
+            // cells whose coordinates do not fit in an int (or are nan, e.g. for infinite boxes) cannot be hashed: such
+            // colliders are handled like oversized ones
+            if(!glm::all(glm::lessThan(glm::abs(min_cell), glm::vec3(1e9f))) || !glm::all(glm::lessThan(glm::abs(max_cell), glm::vec3(1e9f)))) {
+                c.min_cell = c.max_cell = glm::ivec3(0);
+                c.oversized = true;
+                m_oversized.push_back((std::uint32_t)i);
+                continue;
+            }
+            c.min_cell = glm::ivec3(min_cell);
+            c.max_cell = glm::ivec3(max_cell);
+
+            const glm::u64vec3 cells_per_axis = glm::u64vec3(c.max_cell - c.min_cell + 1);
+            const std::uint64_t cells = cells_per_axis.x * cells_per_axis.y * cells_per_axis.z;
+            c.oversized = cells > m_max_cells_per_collider;
+            if(c.oversized)
+                m_oversized.push_back((std::uint32_t)i);
+            else
+                total_cells += cells;
+        }
+
+        // reset the table, keeping it at most half full
+        m_slots.assign(std::bit_ceil(std::max<std::size_t>(16, 2 * total_cells)), cell_slot{});
+
+        // counting sort of the colliders by cell: count the colliders in each cell...
+        for(const collider& c : m_colliders) {
+            if(!c.oversized)
+                for_each_cell(c, [&](glm::ivec3 cell) { find_or_insert_slot(cell).count++; });
+        }
+
+        // ...compute where each cell's colliders start...
+        std::uint32_t offset = 0;
+        for(cell_slot& slot : m_slots) {
+            if(slot.count != empty_slot) {
+                slot.begin = offset;
+                offset += slot.count;
+                slot.count = 0;
+            }
+        }
+
+        // ...and place them; since they are placed in order each cell's colliders are sorted by index
+        m_cell_contents.resize(total_cells);
+        for(std::uint32_t i = 0; i < m_colliders.size(); i++) {
+            const collider& c = m_colliders[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < m_colliders.size()
+            if(!c.oversized) {
+                for_each_cell(c, [&](glm::ivec3 cell) {
+                    cell_slot& slot = find_or_insert_slot(cell);
+                    m_cell_contents[slot.begin + slot.count++] = i; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // slot.begin + slot.count < total_cells
+                });
+            }
+        }
+
+        // find the candidate pairs in each cell
+        m_pairs.clear();
+        for(const cell_slot& slot : m_slots) {
+            if(slot.count == empty_slot)
+                continue;
+
+            for(std::uint32_t a = slot.begin; a < slot.begin + slot.count; a++) {
+                const std::uint32_t i = m_cell_contents[a]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // a < total_cells
+                const collider& ci = m_colliders[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid collider index
+
+                for(std::uint32_t b = a + 1; b < slot.begin + slot.count; b++) {
+                    const std::uint32_t j = m_cell_contents[b]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // b < total_cells
+                    const collider& cj = m_colliders[j]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid collider index
+
+                    // two colliders may share many cells: only report the pair in the first cell of their ranges' intersection
+                    if(glm::max(ci.min_cell, cj.min_cell) != slot.cell)
+                        continue;
+
+                    if(m_buckets.interact(ci.bucket, cj.bucket) && ci.box.overlaps(cj.box))
+                        m_pairs.emplace_back(i, j);
+                }
+            }
+        }
+
+        // oversized colliders are tested against everything else (and pairs of them only once)
+        for(std::uint32_t i : m_oversized) {
+            const collider& ci = m_colliders[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid collider index
+            for(std::uint32_t j = 0; j < m_colliders.size(); j++) {
+                const collider& cj = m_colliders[j]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // j < m_colliders.size()
+                if(j == i || (cj.oversized && j < i))
+                    continue;
+
+                if(m_buckets.interact(ci.bucket, cj.bucket) && ci.box.overlaps(cj.box))
+                    m_pairs.emplace_back(std::min(i, j), std::max(i, j));
+            }
+        }
+
+        std::ranges::sort(m_pairs);
+
+        m_candidate_pairs.clear();
+        for(const auto& [i, j] : m_pairs) {
+            m_candidate_pairs.emplace_back(subscribers[i], subscribers[j]); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i, j < subscribers.size()
+        }
+        narrow_phase_and_react();
+    }
+}
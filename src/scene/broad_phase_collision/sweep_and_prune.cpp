@@ -0,0 +1,173 @@
+#include <engine/scene/broad_phase_collision/sweep_and_prune.hpp>
+#include <engine/scene/node/narrow_phase_collision.hpp>
+#include <engine/scene/node.hpp>
+#include <algorithm>
+#include <slogga/asserts.hpp>
+
+namespace engine {
+    // above this many new proxies in a frame, re-sorting everything from scratch is cheaper than insertion sorting them in
+    constexpr std::size_t max_incremental_insertions = 16;
+
+    // out of line so that the vtable gets exported with the constructor
+    sweep_and_prune_broad_phase_collision_detector::sweep_and_prune_broad_phase_collision_detector() = default;
+
+    void sweep_and_prune_broad_phase_collision_detector::subscribe(node* n) {
+        EXPECTS(n->has<rc<const collision_shape>>());
+        m_subscribers.add(n);
+
+        proxy_index_t i;
+        if(m_free_proxies.empty()) {
+            i = (proxy_index_t)m_proxies.size();
+            m_proxies.emplace_back();
+        } else {
+            i = m_free_proxies.back();
+            m_free_proxies.pop_back();
+        }
+        m_proxies[i] = proxy{ .n = n, .bucket = m_buckets.bucket_of(n->get<collision_shape>()), .order = (std::uint32_t)m_subscribers.size() - 1 }; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid proxy index
+        m_proxy_of_node.emplace(n, i);
+
+        // the endpoints are appended with the right values by the next check, which then sorts them into place
+        for(std::vector<endpoint>& axis_endpoints : m_endpoints) {
+            axis_endpoints.push_back({ .value = 0.f, .proxy = i, .is_max = 0 });
+            axis_endpoints.push_back({ .value = 0.f, .proxy = i, .is_max = 1 });
+        }
+        m_added_proxies++;
+    }
+
+    void sweep_and_prune_broad_phase_collision_detector::unsubscribe(node* n) {
+        m_subscribers.remove(n);
+        forget_node(n);
+
+        auto it = m_proxy_of_node.find(n);
+        EXPECTS(it != m_proxy_of_node.end());
+        // the proxy can only be reused once its endpoints and pairs are gone, by the next check
+        m_proxies[it->second].n = nullptr; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid proxy index
+        m_removed_proxies.push_back(it->second);
+        m_proxy_of_node.erase(it);
+    }
+
+    void sweep_and_prune_broad_phase_collision_detector::colliders_in_aabb(const aabb& box, std::vector<node*>& out) const {
+        // the boxes of proxies added since the last check are still empty
+        for(const proxy& p : m_proxies) {
+            if(p.n != nullptr && p.box.overlaps(box))
+                out.push_back(p.n);
+        }
+    }
+
+    void sweep_and_prune_broad_phase_collision_detector::remove_unsubscribed_proxies() {
+        m_is_removed.assign(m_proxies.size(), false);
+        for(proxy_index_t i : m_removed_proxies)
+            m_is_removed[i] = true; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid proxy index
+
+        for(std::vector<endpoint>& axis_endpoints : m_endpoints)
+            std::erase_if(axis_endpoints, [&](const endpoint& e) { return m_is_removed[e.proxy]; }); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid proxy index
+        std::erase_if(m_pairs, [&](std::uint64_t key) { return m_is_removed[key >> 32] || m_is_removed[key & 0xffffffff]; }); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid proxy indices
+
+        for(proxy_index_t i : m_removed_proxies)
+            m_proxies[i] = proxy{}; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid proxy index
+        m_free_proxies.insert(m_free_proxies.end(), m_removed_proxies.begin(), m_removed_proxies.end());
+        m_removed_proxies.clear();
+    }
+
+    void sweep_and_prune_broad_phase_collision_detector::check_collisions_and_trigger_reactions() {
+        if(!m_removed_proxies.empty())
+            remove_unsubscribed_proxies();
+
+        // if some colliders unsubscribed the others' indices changed
+        if(m_subscribers.compact()) {
+            const std::span<node* const> subscribers = m_subscribers.nodes();
+            for(std::uint32_t i = 0; i < subscribers.size(); i++)
+                m_proxies[m_proxy_of_node.at(subscribers[i])].order = i; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < subscribers.size(); valid proxy index
+        }
+        const std::span<node* const> subscribers = m_subscribers.nodes();
+        update_sleep_states(subscribers);
+
+        // update the boxes and the endpoints' values
+        for(node* n : subscribers) {
+            proxy& p = m_proxies[m_proxy_of_node.at(n)]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid proxy index
+            p.box = collider_aabb(n);
+        }
+        for(int axis = 0; axis < 3; axis++) {
+            for(endpoint& e : m_endpoints[axis]) { // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index) // axis < 3
+                const aabb& box = m_proxies[e.proxy].box; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid proxy index
+                e.value = e.is_max ? box.max[axis] : box.min[axis];
+            }
+        }
+
+        // re-sort the endpoints, updating the pairs
+        if(m_added_proxies > max_incremental_insertions) {
+            rebuild();
+        } else {
+            for(int axis = 0; axis < 3; axis++)
+                insertion_sort_axis(axis);
+        }
+        m_added_proxies = 0;
+
+        // hand the pairs to the narrow phase, in subscription order
+        m_ordered_pairs.clear();
+        for(std::uint64_t key : m_pairs) {
+            std::uint32_t a_order = m_proxies[key >> 32].order; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid proxy index
+            std::uint32_t b_order = m_proxies[key & 0xffffffff].order; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid proxy index
+            m_ordered_pairs.emplace_back(std::min(a_order, b_order), std::max(a_order, b_order));
+        }
+        std::ranges::sort(m_ordered_pairs);
+
+        m_candidate_pairs.clear();
+        for(const auto& [a_order, b_order] : m_ordered_pairs) {
+            m_candidate_pairs.emplace_back(subscribers[a_order], subscribers[b_order]); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // order < subscribers.size()
+        }
+        narrow_phase_and_react();
+    }
+
+    void sweep_and_prune_broad_phase_collision_detector::insertion_sort_axis(int axis) {
+        std::vector<endpoint>& endpoints = m_endpoints[axis]; // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index) // axis < 3
+
+        for(std::size_t i = 1; i < endpoints.size(); i++) {
+            const endpoint e = endpoints[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < endpoints.size()
+            std::size_t j = i;
+
+            while(j > 0 && e < endpoints[j-1]) { // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // 0 < j <= i
+                const endpoint& prev = endpoints[j-1]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // 0 < j <= i
+
+                if(!e.is_max && prev.is_max) {
+                    // a min moving left past a max: the two boxes start overlapping on this axis; check the others too
+                    if(may_collide(e.proxy, prev.proxy))
+                        m_pairs.insert(pair_key(e.proxy, prev.proxy));
+                } else if(e.is_max && !prev.is_max) {
+                    // a max moving left past a min: the two boxes stop overlapping
+                    m_pairs.erase(pair_key(e.proxy, prev.proxy));
+                }
+
+                endpoints[j] = prev; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // j <= i
+                j--;
+            }
+            endpoints[j] = e; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // j <= i
+        }
+    }
+
+    void sweep_and_prune_broad_phase_collision_detector::rebuild() {
+        for(std::vector<endpoint>& axis_endpoints : m_endpoints)
+            std::sort(axis_endpoints.begin(), axis_endpoints.end());
+
+        // sweep along the x axis, keeping the set of proxies whose interval contains the current endpoint
+        m_pairs.clear();
+        std::vector<proxy_index_t> active;
+        std::vector<std::size_t> position_in_active(m_proxies.size());
+        for(const endpoint& e : m_endpoints[0]) {
+            if(!e.is_max) {
+                for(proxy_index_t other : active) {
+                    if(may_collide(e.proxy, other))
+                        m_pairs.insert(pair_key(e.proxy, other));
+                }
+                position_in_active[e.proxy] = active.size(); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid proxy index
+                active.push_back(e.proxy);
+            } else {
+                // swap-remove from active
+                std::size_t pos = position_in_active[e.proxy]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid proxy index
+                position_in_active[active.back()] = pos; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid proxy index
+                active[pos] = active.back(); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // pos < active.size()
+                active.pop_back();
+            }
+        }
+    }
+}
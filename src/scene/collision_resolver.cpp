@@ -0,0 +1,154 @@
+#include <engine/scene/collision_resolver.hpp>
+#include <engine/scene/node.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <slogga/asserts.hpp>
+#include <array>
+#include <utility>
+
+namespace engine {
+    std::uint32_t collision_resolver::body_index(node* n) {
+        auto [it, inserted] = m_body_of.try_emplace(n, std::uint32_t(m_bodies.size()));
+        if(inserted) {
+            m_bodies.push_back(n);
+            m_body_corrections.push_back(glm::vec3(0));
+            m_island_parent.push_back(it->second);
+        }
+        return it->second;
+    }
+
+    std::uint32_t collision_resolver::find_island(std::uint32_t body) {
+        // union-find with path halving
+        while(m_island_parent[body] != body) { // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // bodies are valid indices
+            m_island_parent[body] = m_island_parent[m_island_parent[body]]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // bodies are valid indices
+            body = m_island_parent[body]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // bodies are valid indices
+        }
+        return body;
+    }
+
+    void collision_resolver::build_constraints() {
+        m_constraints.clear();
+
+        // the corrections come grouped by pair, the first reaction's before the second's
+        for(std::size_t begin = 0; begin < m_corrections.size(); ) {
+            const std::uint32_t pair = m_corrections[begin].reaction.pair; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // begin < m_corrections.size()
+            std::size_t end = begin;
+            while(end < m_corrections.size() && m_corrections[end].reaction.pair == pair) // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // end < m_corrections.size()
+                end++;
+
+            // the partner of a reaction's movers is the first mover of the other reaction (the closest to the collider)
+            std::array<std::uint32_t, 2> first_movers = { no_body, no_body };
+            for(std::size_t i = begin; i < end; i++) {
+                const correction& c = m_corrections[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < end <= m_corrections.size()
+                std::uint32_t& first = first_movers[c.reaction.second ? 1 : 0]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // 0 or 1
+                if(first == no_body)
+                    first = body_index(c.mover);
+            }
+
+            for(std::size_t i = begin; i < end; i++) {
+                const correction& c = m_corrections[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < end <= m_corrections.size()
+                const float depth = glm::length(c.min_translation);
+                const std::uint32_t body = body_index(c.mover);
+                const std::uint32_t partner = first_movers[c.reaction.second ? 0 : 1]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // 0 or 1
+                // shallow collisions need no correction, and colliders moved by the same node cannot push it away
+                if(depth == 0.f || body == partner)
+                    continue;
+
+                m_constraints.push_back({ .body = body, .partner = partner, .normal = c.min_translation / depth, .depth = depth });
+                if(partner != no_body)
+                    m_island_parent[find_island(body)] = find_island(partner); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // bodies are valid indices
+            }
+            begin = end;
+        }
+    }
+
+    void collision_resolver::build_islands() {
+        // islands are numbered in the order of their first constraint, and keep their constraints in order (counting sort)
+        m_island_of_root.clear();
+        m_island_of_constraint.clear();
+        m_island_begin.clear();
+        for(const constraint& c : m_constraints) {
+            auto [it, inserted] = m_island_of_root.try_emplace(find_island(c.body), std::uint32_t(m_island_begin.size()));
+            if(inserted)
+                m_island_begin.push_back(0);
+            m_island_begin[it->second]++; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid island index
+            m_island_of_constraint.push_back(it->second);
+        }
+
+        std::uint32_t offset = 0;
+        for(std::uint32_t& begin : m_island_begin)
+            offset += std::exchange(begin, offset);
+        m_island_begin.push_back(offset);
+
+        m_island_constraints.resize(m_constraints.size());
+        m_island_next.assign(m_island_begin.begin(), m_island_begin.end());
+        for(std::uint32_t i = 0; i < m_constraints.size(); i++)
+            m_island_constraints[m_island_next[m_island_of_constraint[i]]++] = i; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid constraint and island indices
+    }
+
+    void collision_resolver::solve_island(std::size_t island) {
+        const std::uint32_t begin = m_island_begin[island], end = m_island_begin[island + 1]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // island + 1 < m_island_begin.size()
+
+        for(std::size_t iteration = 0; iteration < m_iterations; iteration++) {
+            bool changed = false;
+            for(std::uint32_t i = begin; i < end; i++) {
+                const constraint& c = m_constraints[m_island_constraints[i]]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid constraint indices
+                glm::vec3& body_correction = m_body_corrections[c.body]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid body index
+
+                // how much of the penetration the corrections so far leave
+                const glm::vec3 relative = c.partner != no_body ? body_correction - m_body_corrections[c.partner] : body_correction; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid body index
+                const float error = c.depth - glm::dot(relative, c.normal);
+                if(error <= 0.f)
+                    continue;
+
+                changed = true;
+                if(c.partner != no_body) {
+                    body_correction += c.normal * (error / 2.f);
+                    m_body_corrections[c.partner] -= c.normal * (error / 2.f); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid body index
+                } else {
+                    body_correction += c.normal * error;
+                }
+            }
+            if(!changed)
+                break;
+        }
+    }
+
+    void collision_resolver::solve_and_apply(thread_pool* pool) {
+        if(m_corrections.empty())
+            return;
+
+        m_body_of.clear();
+        m_bodies.clear();
+        m_body_corrections.clear();
+        m_island_parent.clear();
+
+        build_constraints();
+        build_islands();
+
+        // islands share no body, so each one only writes its own bodies' corrections
+        const std::size_t islands = m_island_begin.size() - 1;
+        auto solve = [&](std::size_t begin, std::size_t end) {
+            for(std::size_t i = begin; i < end; i++)
+                solve_island(i);
+        };
+        if(pool != nullptr)
+            pool->parallel_for(islands, 8, solve);
+        else
+            solve(0, islands);
+
+        // a single transform write per node; a father's translation does not change its linear part, which is all its
+        // children's corrections depend on
+        for(std::size_t i = 0; i < m_bodies.size(); i++) {
+            const glm::vec3 world_translation = m_body_corrections[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < m_bodies.size() == m_body_corrections.size()
+            if(world_translation == glm::vec3(0))
+                continue;
+
+            node& n = *m_bodies[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < m_bodies.size()
+            const node* father = n.get_father();
+            const glm::vec3 local_translation = father != nullptr ? glm::vec3(glm::inverse(father->get_global_transform()) * glm::vec4(world_translation, 0)) : world_translation;
+            n.set_transform(glm::translate(glm::mat4(1), local_translation) * n.transform());
+        }
+
+        m_corrections.clear();
+    }
+}
@@ -0,0 +1,163 @@
+#include <engine/scene/mutation_queue.hpp>
+#include <engine/resources_manager.hpp>
+#include <engine/utils/hash.hpp>
+#include <algorithm>
+#include <iterator>
+#include <slogga/log.hpp>
+#include <slogga/asserts.hpp>
+
+namespace engine {
+    void mutation_queue::spawn(node& father, std::unique_ptr<node> n) {
+        EXPECTS(n.get());
+        m_spawns.push_back({ &father, std::move(n) });
+    }
+
+    void mutation_queue::spawn(node& father, rc<const nodetree_blueprint> bp, std::optional<std::string> name, const glm::mat4& transform) {
+        m_blueprint_spawns.push_back({ &father, std::move(bp), std::move(name), transform });
+    }
+
+    void mutation_queue::destroy(node& n) {
+        m_destroys.push_back(&n);
+    }
+
+    void mutation_queue::reparent(node& n, node& new_father) {
+        m_reparents.push_back({ &n, &new_father });
+    }
+
+    void mutation_queue::swap_payload(node& n, node_payload_t payload) {
+        m_payload_swaps.push_back({ &n, std::move(payload) });
+    }
+
+    static std::size_t count_nodes(const node& root) {
+        std::size_t count = 0;
+        std::vector<const node*> stack = { &root };
+        while(!stack.empty()) {
+            const node* n = stack.back();
+            stack.pop_back();
+            count++;
+            for(const node& c : n->children())
+                stack.push_back(&c);
+        }
+        return count;
+    }
+
+    void mutation_queue::apply() {
+        // payload swaps
+        for(swap_payload_cmd& cmd : m_payload_swaps) {
+            node_payload_t old_payload = cmd.n->exchange_payload(std::move(cmd.payload));
+            if(m_defer_destruction)
+                m_deferred_payloads.push_back(std::move(old_payload));
+        }
+
+        // reparents: first resolve the final father of each node (checking for cycles as if the commands were applied one
+        // at a time), then detach all of them and attach them grouped by father, so each children vector is only sorted once
+        {
+            hashmap<node*, node*> pending_father; // nodes reparented so far in this batch -> their new father
+            auto effective_father = [&](node* n) {
+                auto it = pending_father.find(n);
+                return it != pending_father.end() ? it->second : n->get_father();
+            };
+
+            for(const reparent_cmd& cmd : m_reparents) {
+                bool creates_cycle = false;
+                for(node* cursor = cmd.new_father; cursor != nullptr; cursor = effective_father(cursor)) {
+                    if(cursor == cmd.n) {
+                        creates_cycle = true;
+                        break;
+                    }
+                }
+
+                if(creates_cycle) {
+                    slogga::stdout_log.warn("mutation_queue: ignoring request to reparent node '{}' to its own descendant '{}'", cmd.n->name(), cmd.new_father->name());
+                } else if(effective_father(cmd.n) == nullptr) {
+                    slogga::stdout_log.warn("mutation_queue: ignoring request to reparent node '{}', which has no father", cmd.n->name());
+                } else {
+                    pending_father[cmd.n] = cmd.new_father; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // hashmap [] does not fail
+                }
+            }
+
+            // detach, grouping by old father
+            hashmap<node*, std::vector<node*>> to_detach;
+            for(const auto& [n, new_father] : pending_father) {
+                to_detach[n->get_father()].push_back(n); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // hashmap [] does not fail
+            }
+            hashmap<node*, std::vector<std::unique_ptr<node>>> to_attach;
+            for(auto& [old_father, children] : to_detach) {
+                for(std::unique_ptr<node>& c : old_father->remove_children(children)) {
+                    node* new_father = pending_father.at(c.get());
+                    to_attach[new_father].push_back(std::move(c)); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // hashmap [] does not fail
+                }
+            }
+
+            // attach, grouping by new father
+            for(auto& [new_father, children] : to_attach) {
+                new_father->add_children(std::move(children));
+            }
+        }
+
+        // spawns: allocate the ecs ids of all blueprint copies at once, then attach all spawned nodes grouped by father
+        {
+            hashmap<node*, std::vector<std::unique_ptr<node>>> to_attach;
+
+            std::size_t nodes_to_copy = 0;
+            for(const spawn_from_blueprint_cmd& cmd : m_blueprint_spawns) {
+                nodes_to_copy += count_nodes(cmd.bp->root());
+            }
+            get_rm().ecs().reserve_ids((ecs_id_t)nodes_to_copy);
+
+            for(spawn_from_blueprint_cmd& cmd : m_blueprint_spawns) {
+                std::unique_ptr<node> n = node::deep_copy(std::move(cmd.bp), std::move(cmd.name));
+                n->set_transform(cmd.transform * n->transform());
+                to_attach[cmd.father].push_back(std::move(n)); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // hashmap [] does not fail
+            }
+            for(spawn_cmd& cmd : m_spawns) {
+                to_attach[cmd.father].push_back(std::move(cmd.n)); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // hashmap [] does not fail
+            }
+
+            for(auto& [father, children] : to_attach) {
+                father->add_children(std::move(children));
+            }
+        }
+
+        // destroys: skip duplicates and nodes which are destroyed anyway because one of their ancestors is, then detach the rest
+        // grouped by father
+        {
+            hashset<node*> destroy_set(m_destroys.begin(), m_destroys.end());
+            hashmap<node*, std::vector<node*>> to_detach;
+
+            for(node* n : destroy_set) {
+                bool ancestor_is_destroyed = false;
+                for(node* cursor = n->get_father(); cursor != nullptr; cursor = cursor->get_father()) {
+                    if(destroy_set.contains(cursor)) {
+                        ancestor_is_destroyed = true;
+                        break;
+                    }
+                }
+
+                if(n->get_father() == nullptr) {
+                    slogga::stdout_log.warn("mutation_queue: ignoring request to destroy node '{}', which has no father", n->name());
+                } else if(!ancestor_is_destroyed) {
+                    to_detach[n->get_father()].push_back(n); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // hashmap [] does not fail
+                }
+            }
+
+            for(auto& [father, children] : to_detach) {
+                std::vector<std::unique_ptr<node>> detached = father->remove_children(children);
+                if(m_defer_destruction)
+                    std::ranges::move(detached, std::back_inserter(m_deferred_nodes));
+                // otherwise the detached subtrees are destroyed here, along with detached
+            }
+        }
+
+        m_spawns.clear();
+        m_blueprint_spawns.clear();
+        m_destroys.clear();
+        m_reparents.clear();
+        m_payload_swaps.clear();
+    }
+
+    void mutation_queue::flush_deferred_destructions() {
+        m_deferred_nodes.clear();
+        m_deferred_payloads.clear();
+    }
+}
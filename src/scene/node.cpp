@@ -1,5 +1,7 @@
 #include <engine/scene/node.hpp>
+#include <engine/scene/broad_phase_collision.hpp>
 #include <engine/resources_manager.hpp>
+#include <engine/scene/script_profiler.hpp>
 #include <engine/utils/format_glm.hpp>
 #include <slogga/log.hpp>
 
@@ -17,7 +19,7 @@ namespace engine {
     node::node(std::string name, node_payload_t payload, const glm::mat4& transform, std::optional<stateless_script> script, const std::any& params)
         : m_father(nullptr),
           m_payload(std::move(payload)),
-          m_ecs_id(get_rm().ecs().make_new_id({"name", "father", "children", "transform", "transform_edits", "global_transform_cache"})) // TODO: unideal interface, make it better
+          m_ecs_id(get_rm().ecs().make_new_id({"name", "father", "children", "transform", "transform_edits", "global_transform_cache", "previous_global_transform"})) // TODO: unideal interface, make it better
     {
         set_transform(transform);
 
@@ -28,9 +30,72 @@ namespace engine {
     }
 
     node::~node() {
+        // the children unsubscribe themselves in their own destructors
+        if(m_bp_collision_detector != nullptr && has<collision_shape>())
+            m_bp_collision_detector->unsubscribe(this);
+
         get_rm().ecs().release_id(m_ecs_id);
     }
 
+    void node::set_bp_collision_detector(broad_phase_collision_detector* bpcd) {
+        // all nodes of a tree share the bpcd, so if this one already has it so does its subtree
+        if(m_bp_collision_detector == bpcd)
+            return;
+
+        if(has<collision_shape>()) {
+            if(m_bp_collision_detector != nullptr)
+                m_bp_collision_detector->unsubscribe(this);
+            if(bpcd != nullptr)
+                bpcd->subscribe(this);
+        }
+        m_bp_collision_detector = bpcd;
+
+        for(std::unique_ptr<node>& c : m_children)
+            c->set_bp_collision_detector(bpcd);
+    }
+
+    void node::update_collider_subscription(bool was_collider) {
+        if(m_bp_collision_detector == nullptr)
+            return;
+
+        const bool is_collider = has<collision_shape>();
+        if(was_collider)
+            m_bp_collision_detector->unsubscribe(this);
+        if(is_collider)
+            m_bp_collision_detector->subscribe(this);
+    }
+
+    static thread_local bool render_payloads_read_only_on_this_thread = false;
+
+    void node::set_render_payloads_read_only(bool read_only) { render_payloads_read_only_on_this_thread = read_only; }
+
+    bool node::render_payloads_read_only() { return render_payloads_read_only_on_this_thread; }
+
+    // whether replacing the payload would modify a mesh or viewport the render thread may be reading
+    static bool is_render_payload(const node_payload_t& p) { return std::holds_alternative<mesh>(p) || std::holds_alternative<viewport>(p); }
+
+    void node::set_payload(node_payload_t p) {
+        EXPECTS(!render_payloads_read_only() || !is_render_payload(m_payload));
+        const bool was_collider = has<collision_shape>();
+        m_payload = std::move(p);
+        update_collider_subscription(was_collider);
+    }
+
+    void node::set_payload(rc<collision_shape> p) {
+        EXPECTS(!render_payloads_read_only() || !is_render_payload(m_payload));
+        const bool was_collider = has<collision_shape>();
+        m_payload = std::move(p);
+        update_collider_subscription(was_collider);
+    }
+
+    node_payload_t node::exchange_payload(node_payload_t p) {
+        EXPECTS(!render_payloads_read_only() || !is_render_payload(m_payload));
+        const bool was_collider = has<collision_shape>();
+        node_payload_t ret = std::exchange(m_payload, std::move(p));
+        update_collider_subscription(was_collider);
+        return ret;
+    }
+
 
 
     std::unique_ptr<node> node::deep_copy(const node& o, std::optional<std::string> name) {
@@ -66,6 +131,8 @@ namespace engine {
 
     void node::add_child(std::unique_ptr<node> c) {
         c->m_father = this;
+        c->invalidate_global_transform_cache();
+        c->set_bp_collision_detector(m_bp_collision_detector);
 
         // do the same but for ecs components...
 
@@ -94,6 +161,88 @@ namespace engine {
         }
     }
 
+    void node::add_children(std::vector<std::unique_ptr<node>> cs) {
+        auto& ecs = get_rm().ecs();
+        auto& father_component = ecs.get_component<ecs_id_t>("father");
+        auto& children = ecs.get_component<children_vector>("children").get(m_ecs_id);
+
+        const std::size_t previous_size = m_children.size();
+        children.vector.reserve(children.vector.size() + cs.size());
+        m_children.reserve(m_children.size() + cs.size());
+
+        for(std::unique_ptr<node>& c : cs) {
+            c->m_father = this;
+            c->invalidate_global_transform_cache();
+            c->set_bp_collision_detector(m_bp_collision_detector);
+            father_component.set(c->m_ecs_id, m_ecs_id);
+
+            children.vector.push_back(c->m_ecs_id);
+            m_children.push_back(std::move(c));
+        }
+
+        if(children.is_sorted) {
+            // sort only the newly added children, then merge them with the (already sorted) previous ones;
+            // both sorts are stable, so the ecs children vector and m_children end up in the same order
+            const auto& name_component = ecs.get_component<std::string>("name");
+            auto compare_ids = [&](ecs_id_t a, ecs_id_t b) { return name_component.get_or(a, {}) < name_component.get_or(b, {}); };
+            auto ids_middle = children.vector.end() - (std::ptrdiff_t)cs.size();
+            std::stable_sort(ids_middle, children.vector.end(), compare_ids);
+            std::inplace_merge(children.vector.begin(), ids_middle, children.vector.end(), compare_ids);
+
+            auto compare_nodes = [](const std::unique_ptr<node>& a, const std::unique_ptr<node>& b) { return a->name() < b->name(); };
+            auto nodes_middle = m_children.begin() + (std::ptrdiff_t)previous_size;
+            std::stable_sort(nodes_middle, m_children.end(), compare_nodes);
+            std::inplace_merge(m_children.begin(), nodes_middle, m_children.end(), compare_nodes);
+        }
+    }
+
+    std::unique_ptr<node> node::remove_child(node& c) {
+        node* cs[] = { &c }; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+        std::vector<std::unique_ptr<node>> removed = remove_children(cs);
+        EXPECTS(removed.size() == 1);
+        return std::move(removed.front());
+    }
+
+    std::vector<std::unique_ptr<node>> node::remove_children(std::span<node* const> cs) {
+        hashset<const node*> to_remove(cs.begin(), cs.end());
+        hashset<ecs_id_t> ids_to_remove;
+        ids_to_remove.reserve(to_remove.size());
+
+        std::vector<std::unique_ptr<node>> ret;
+        ret.reserve(to_remove.size());
+
+        // erase from the legacy children vector, preserving order (and therefore sortedness): the children kept are
+        // compacted to the front as the removed ones are moved out
+        std::size_t kept = 0;
+        for(std::unique_ptr<node>& c : m_children) {
+            if(to_remove.contains(c.get())) {
+                ids_to_remove.insert(c->m_ecs_id);
+                ret.push_back(std::move(c));
+            } else {
+                if(&m_children[kept] != &c) // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // kept <= the index of c
+                    m_children[kept] = std::move(c); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // kept <= the index of c
+                kept++;
+            }
+        }
+        m_children.erase(m_children.begin() + std::ptrdiff_t(kept), m_children.end());
+        EXPECTS(ret.size() == to_remove.size()); // all nodes passed must be children of this node
+
+        // do the same for ecs components
+        auto& ecs = get_rm().ecs();
+        auto& children = ecs.get_component<children_vector>("children").get(m_ecs_id);
+        std::erase_if(children.vector, [&](ecs_id_t id) { return ids_to_remove.contains(id); });
+
+        auto& father_component = ecs.get_component<ecs_id_t>("father");
+        for(std::unique_ptr<node>& c : ret) {
+            father_component.set(c->m_ecs_id, null_ecs_id);
+            c->m_father = nullptr;
+            c->invalidate_global_transform_cache();
+            c->set_bp_collision_detector(nullptr);
+        }
+
+        return ret;
+    }
+
     node& node::get_child(std::string_view name) {
         if(get_children_sorting_preference()) {
             auto less_than = [](const std::unique_ptr<node>& n, const std::string_view& s) { return n->name() < s; };
@@ -145,6 +294,15 @@ namespace engine {
         get_rm().ecs().get_component<glm::mat4>("transform").set(m_ecs_id, m);
     }
 
+    bool node::is_sleeping() const {
+        return m_bp_collision_detector != nullptr && m_bp_collision_detector->is_asleep(this);
+    }
+
+    void node::wake_up() {
+        if(m_bp_collision_detector != nullptr)
+            m_bp_collision_detector->wake_up(this);
+    }
+
     const mat4& node::get_global_transform() const {
         optional_ref<glm::mat4> cache = get_rm().ecs().get_component<glm::mat4>("global_transform_cache").try_get(m_ecs_id);
         if(cache) {
@@ -159,12 +317,15 @@ namespace engine {
         }
     }
 
-    void node::react_to_collision(collision_result res, node& other) {
+    void node::react_to_collision(collision_result res, node& other, script_profiler* profiler, collision_resolver* resolver, collision_resolver::reaction_id reaction) {
         node* node_cursor = this;
         while(true) {
             const auto& col_behaviour = node_cursor->get_collision_behaviour();
 
-            if(col_behaviour.moves_away_on_collision) {
+            if(col_behaviour.moves_away_on_collision && resolver != nullptr) {
+                if(!res.is_shallow())
+                    resolver->add_correction(*node_cursor, reaction, res.get_min_translation());
+            } else if(col_behaviour.moves_away_on_collision) {
                 const node* father_p = node_cursor->get_father();
                 mat4 father_inverse_globtrans = father_p != nullptr ? glm::inverse(father_p->get_global_transform()) : mat4(1);
 
@@ -176,8 +337,14 @@ namespace engine {
                 EXPECTS(node_cursor->m_script.has_value());
 
                 // pass the collision event to the node's script
-                if(node_cursor->m_script)
-                    node_cursor->m_script->react_to_collision(*node_cursor, res, *this, other);
+                if(node_cursor->m_script) {
+                    script& s = *node_cursor->m_script;
+                    auto call = [&]() { s.react_to_collision(*node_cursor, res, *this, other); };
+                    if(profiler)
+                        profiler->measure(s.get_underlying_stateless_script(), script_profiler::call_kind::react_to_collision, call);
+                    else
+                        call();
+                }
             }
 
             //keep recursing up the node tree if the event needs to be passed to the father
@@ -191,6 +358,33 @@ namespace engine {
         }
     }
 
+    void node::react_to_trigger(trigger_event event, node& other, script_profiler* profiler) {
+        node* node_cursor = this;
+        while(true) {
+            const auto& col_behaviour = node_cursor->get_collision_behaviour();
+
+            if(col_behaviour.passes_events_to_script) {
+                EXPECTS(node_cursor->m_script.has_value());
+
+                // pass the trigger event to the node's script; its time is accounted along with collision events
+                if(node_cursor->m_script) {
+                    script& s = *node_cursor->m_script;
+                    auto call = [&]() { s.react_to_trigger(*node_cursor, event, *this, other); };
+                    if(profiler)
+                        profiler->measure(s.get_underlying_stateless_script(), script_profiler::call_kind::react_to_collision, call);
+                    else
+                        call();
+                }
+            }
+
+            //keep recursing up the node tree if the event needs to be passed to the father
+            node* father = node_cursor->get_father();
+            if(!col_behaviour.passes_events_to_father || father == nullptr)
+                break;
+            node_cursor = father;
+        }
+    }
+
     void node::attach_script(stateless_script sc, const std::any& params) {
         m_script = script(std::move(sc), *this, params);
     }
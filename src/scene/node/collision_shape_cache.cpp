@@ -0,0 +1,260 @@
+#include <engine/scene/node/collision_shape_cache.hpp>
+#include <slogga/asserts.hpp>
+#include <slogga/log.hpp>
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <type_traits>
+
+namespace engine {
+    /* File layout (native-endian):
+     * - header: magic, format version, endianness marker, number of entries;
+     * - the index: key, offset (from the start of the file) and size of each entry;
+     * - the entries: the number of shapes, then each shape's fields (see write_shape).
+     */
+    static constexpr std::array<char, 8> magic = { 'E', 'N', 'G', 'C', 'O', 'L', 'S', 'H' };
+    static constexpr std::uint32_t format_version = 1;
+    static constexpr std::uint32_t endianness_marker = 0x01020304;
+
+    namespace {
+        struct file_header {
+            std::array<char, 8> magic;
+            std::uint32_t format_version;
+            std::uint32_t endianness_marker;
+            std::uint64_t entry_count;
+        };
+        struct index_entry {
+            std::uint64_t key;
+            std::uint64_t offset;
+            std::uint64_t size;
+        };
+
+        class byte_writer {
+            std::vector<std::byte>& m_out;
+        public:
+            explicit byte_writer(std::vector<std::byte>& out) : m_out(out) {}
+
+            void put_bytes(const void* data, std::size_t size) {
+                const auto* bytes = static_cast<const std::byte*>(data);
+                m_out.insert(m_out.end(), bytes, bytes + size); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // size bytes from data
+            }
+            template<typename T> void put(const T& v) {
+                static_assert(std::is_trivially_copyable_v<T>);
+                put_bytes(&v, sizeof(T));
+            }
+            template<typename T> void put_array(std::span<const T> v) {
+                put(std::uint32_t(v.size()));
+                put_bytes(v.data(), v.size() * sizeof(T));
+            }
+        };
+
+        // reads stop (and fail) at the end of the bytes; the bytes may be unaligned, since they come from a file
+        class byte_reader {
+            std::span<const std::byte> m_bytes;
+            bool m_ok = true;
+        public:
+            explicit byte_reader(std::span<const std::byte> bytes) : m_bytes(bytes) {}
+
+            bool ok() const { return m_ok; }
+            std::size_t remaining() const { return m_bytes.size(); }
+            void fail() {
+                m_ok = false;
+                m_bytes = {};
+            }
+
+            void get_bytes(void* data, std::size_t size) {
+                if(size > m_bytes.size()) {
+                    fail();
+                    return;
+                }
+                std::memcpy(data, m_bytes.data(), size);
+                m_bytes = m_bytes.subspan(size);
+            }
+            template<typename T> T get() {
+                static_assert(std::is_trivially_copyable_v<T>);
+                T v{};
+                get_bytes(&v, sizeof(T));
+                return v;
+            }
+            template<typename T> void get_array(std::vector<T>& v) {
+                const std::uint32_t size = get<std::uint32_t>();
+                if(std::size_t(size) * sizeof(T) > m_bytes.size()) {
+                    fail();
+                    return;
+                }
+                v.resize(size);
+                get_bytes(v.data(), v.size() * sizeof(T));
+            }
+        };
+    }
+
+    static void write_shape(byte_writer& w, const collision_shape& s) {
+        w.put(std::uint8_t(s.primitive.index()));
+        std::visit([&](const auto& primitive) { w.put(primitive); }, s.primitive);
+        w.put(s.is_layers);
+        w.put(s.sees_layers);
+        w.put(s.polytope.get_layout());
+        w.put_array(s.polytope.data());
+        w.put(s.local_aabb);
+        w.put(s.bounding_sphere_center);
+        w.put(s.bounding_sphere_radius);
+    }
+
+    static collision_shape read_shape(byte_reader& r) {
+        collision_shape s;
+        switch(r.get<std::uint8_t>()) {
+            case 0: s.primitive = r.get<std::monostate>(); break;
+            case 1: s.primitive = r.get<sphere_primitive>(); break;
+            case 2: s.primitive = r.get<capsule_primitive>(); break;
+            case 3: s.primitive = r.get<box_primitive>(); break;
+            default: r.fail();
+        }
+        s.is_layers = r.get<collision_layers_bitmask>();
+        s.sees_layers = r.get<collision_layers_bitmask>();
+        const packed_polytope::layout layout = r.get<packed_polytope::layout>();
+        std::vector<std::int16_t> polytope_data;
+        r.get_array(polytope_data);
+        if(std::optional<packed_polytope> polytope = packed_polytope::from_data(layout, polytope_data))
+            s.polytope = std::move(*polytope);
+        else
+            r.fail();
+        s.local_aabb = r.get<aabb>();
+        s.bounding_sphere_center = r.get<glm::vec3>();
+        s.bounding_sphere_radius = r.get<float>();
+        return s;
+    }
+
+    collision_shape_cache::collision_shape_cache(std::string path) : m_path(std::move(path)) {
+        open();
+    }
+
+    void collision_shape_cache::open() {
+        m_file = mapped_file::open(m_path);
+        if(!m_file)
+            return;
+
+        byte_reader r(m_file->bytes());
+        const file_header header = r.get<file_header>();
+        if(!r.ok() || header.magic != magic || header.format_version != format_version || header.endianness_marker != endianness_marker) {
+            slogga::stdout_log.warn("ignoring collision shape cache \"{}\": it is not a cache of this format", m_path);
+            m_file.reset();
+            return;
+        }
+
+        const std::span<const std::byte> bytes = m_file->bytes();
+        if(header.entry_count > (bytes.size() - sizeof(file_header)) / sizeof(index_entry)) { // checked before reserving for it
+            slogga::stdout_log.warn("ignoring collision shape cache \"{}\": it is truncated", m_path);
+            m_file.reset();
+            return;
+        }
+        m_entries.reserve(header.entry_count);
+        for(std::uint64_t i = 0; i < header.entry_count; i++) {
+            const index_entry entry = r.get<index_entry>();
+            if(!r.ok() || entry.offset > bytes.size() || entry.size > bytes.size() - entry.offset) {
+                slogga::stdout_log.warn("ignoring collision shape cache \"{}\": it is truncated", m_path);
+                m_entries.clear();
+                m_file.reset();
+                return;
+            }
+            m_entries.emplace(entry.key, bytes.subspan(entry.offset, entry.size));
+        }
+    }
+
+    std::uint64_t collision_shape_cache::make_key(std::initializer_list<std::span<const std::byte>> sources) {
+        const ankerl::unordered_dense::hash<std::string_view> hash;
+        std::array<std::uint64_t, 2> state = { builder_version, 0 };
+        for(std::span<const std::byte> source : sources) {
+            state[1] = hash(std::string_view(reinterpret_cast<const char*>(source.data()), source.size())); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast, cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // hashing the bytes; 1 < state.size()
+            state[0] = hash(std::string_view(reinterpret_cast<const char*>(state.data()), sizeof(state))); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast, cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // hashing the bytes; 0 < state.size()
+        }
+        return state[0]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // 0 < state.size()
+    }
+
+    std::optional<std::vector<collision_shape>> collision_shape_cache::find(std::uint64_t key) {
+        const auto it = m_entries.find(key);
+        if(it == m_entries.end())
+            return std::nullopt;
+
+        byte_reader r(it->second);
+        const std::uint32_t count = r.get<std::uint32_t>();
+        std::vector<collision_shape> shapes;
+        if(count > r.remaining()) // each shape takes more than a byte: the count is corrupt
+            r.fail();
+        else
+            shapes.reserve(count);
+        for(std::uint32_t i = 0; i < count && r.ok(); i++)
+            shapes.push_back(read_shape(r));
+        if(!r.ok()) {
+            slogga::stdout_log.warn("ignoring corrupt entry of collision shape cache \"{}\"", m_path);
+            m_entries.erase(it);
+            return std::nullopt;
+        }
+        m_found.insert(key);
+        return shapes;
+    }
+
+    void collision_shape_cache::insert(std::uint64_t key, std::span<const collision_shape> shapes) {
+        std::vector<std::byte> bytes;
+        byte_writer w(bytes);
+        w.put(std::uint32_t(shapes.size()));
+        for(const collision_shape& s : shapes)
+            write_shape(w, s);
+        m_inserted.insert_or_assign(key, std::move(bytes));
+    }
+
+    bool collision_shape_cache::save() {
+        if(m_inserted.empty())
+            return true;
+
+        // the found entries are copied straight out of the mapped file (an inserted entry replaces a found one)
+        std::vector<std::pair<std::uint64_t, std::span<const std::byte>>> entries;
+        entries.reserve(m_found.size() + m_inserted.size());
+        for(std::uint64_t key : m_found)
+            if(const auto it = m_entries.find(key); it != m_entries.end() && !m_inserted.contains(key))
+                entries.emplace_back(key, it->second);
+        for(const auto& [key, bytes] : m_inserted)
+            entries.emplace_back(key, bytes);
+
+        std::vector<std::byte> out;
+        byte_writer w(out);
+        w.put(file_header { .magic = magic, .format_version = format_version, .endianness_marker = endianness_marker, .entry_count = entries.size() });
+        std::uint64_t offset = sizeof(file_header) + entries.size() * sizeof(index_entry);
+        for(const auto& [key, bytes] : entries) {
+            w.put(index_entry { .key = key, .offset = offset, .size = bytes.size() });
+            offset += bytes.size();
+        }
+        for(const auto& [key, bytes] : entries)
+            w.put_bytes(bytes.data(), bytes.size());
+
+        // the old file must not be mapped while it is replaced; it is written aside first, so that a failed write
+        // leaves it as it was
+        entries.clear();
+        m_entries.clear();
+        m_file.reset();
+        const std::filesystem::path path = m_path, tmp_path = m_path + ".tmp";
+        {
+            std::ofstream f(tmp_path, std::ios::binary | std::ios::trunc);
+            f.write(reinterpret_cast<const char*>(out.data()), std::streamsize(out.size())); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast) // writing the bytes
+            if(!f) {
+                open();
+                return false;
+            }
+        }
+        std::error_code err;
+        std::filesystem::rename(tmp_path, path, err);
+        if(err) {
+            std::filesystem::remove(tmp_path, err);
+            open();
+            return false;
+        }
+        m_found.clear();
+        m_inserted.clear();
+        open();
+        for(const auto& [key, bytes] : m_entries)
+            m_found.insert(key);
+        return true;
+    }
+}
@@ -1,4 +1,5 @@
 #include <engine/scene/node/gltf_loader.hpp>
+#include <engine/scene/node/collision_shape_cache.hpp>
 #include <engine/scene/renderer/mesh/material/materials.hpp>
 #include <engine/resources_manager.hpp>
 #include <engine/utils/hash.hpp>
@@ -248,10 +249,89 @@ namespace engine {
         return ret;
     }
 
+    static uint32_t load_u32_from_gltf_extras(const tinygltf::Value& extras, const char* attrib_name) {
+        if(extras.Has(attrib_name)) {
+            tinygltf::Value attrib = extras.Get(attrib_name);
+            if(!attrib.IsInt() || attrib.GetNumberAsInt() < 0) {
+                slogga::stdout_log.warn("invalid usage of gltf extra attribute '{}': must be a non negative integer", attrib_name);
+                return 0;
+            }
+            return (uint32_t)attrib.GetNumberAsInt();
+        }
+        return 0;
+    }
+
+    // the extra "collision_primitive" ("sphere", "capsule" or "box") replaces the mesh with the primitive inscribed in its aabb,
+    // so that e.g. a sphere mesh becomes the same sphere; capsules are along y
+    static std::optional<collision_shape> load_primitive_collision_shape(stride_span<const glm::vec3> verts_span, const tinygltf::Value& extras, collision_layers_bitmask is_layers, collision_layers_bitmask sees_layers) {
+        if(!extras.Has("collision_primitive"))
+            return std::nullopt;
+        tinygltf::Value attrib = extras.Get("collision_primitive");
+        const std::string type = attrib.IsString() ? attrib.Get<std::string>() : std::string();
+
+        aabb box;
+        for(size_t i = 0; i < verts_span.size(); i++)
+            box = box.merge({ .min = verts_span.at(i), .max = verts_span.at(i) });
+        if(box.is_empty())
+            return std::nullopt;
+        const glm::vec3 center = (box.min + box.max) * .5f;
+        const glm::vec3 half_extents = box.extent() * .5f;
+
+        if(type == "sphere") {
+            return collision_shape::sphere({ .radius = std::max({ half_extents.x, half_extents.y, half_extents.z }), .center = center }, is_layers, sees_layers);
+        } else if(type == "capsule") {
+            const float radius = std::max(half_extents.x, half_extents.z);
+            return collision_shape::capsule({ .radius = radius, .half_height = std::max(half_extents.y - radius, 0.f), .center = center }, is_layers, sees_layers);
+        } else if(type == "box") {
+            return collision_shape::box({ .half_extents = half_extents, .center = center }, is_layers, sees_layers);
+        }
+        slogga::stdout_log.warn("invalid usage of gltf extra attribute 'collision_primitive': must be one of \"sphere\", \"capsule\" or \"box\"; loading the mesh instead");
+        return std::nullopt;
+    }
+
+    // the extras "convex_hull" and "convex_decomposition" replace the mesh with its hull or with the hulls of its convex parts;
+    // the limits "hull_max_verts", "hull_max_faces" and "max_hulls" are optional.
+    // Shapes built from the mesh are looked up in cache first, by source_key (the hash of the mesh's buffers) and the options
+    template<typename T>
+    static std::vector<collision_shape> make_collision_shapes(stride_span<const glm::vec3> verts_span, std::span<const T> indices_span, const tinygltf::Value& extras, collision_shape_cache& cache, std::uint64_t source_key) {
+        collision_layers_bitmask is_layers = load_u64_from_hex_string_from_gltf_extras(extras, "is_layers");
+        collision_layers_bitmask sees_layers = load_u64_from_hex_string_from_gltf_extras(extras, "sees_layers");
+
+        if(std::optional<collision_shape> primitive = load_primitive_collision_shape(verts_span, extras, is_layers, sees_layers))
+            return { std::move(*primitive) };
+
+        convex_hull_options hull_options;
+        hull_options.max_verts = load_u32_from_gltf_extras(extras, "hull_max_verts");
+        hull_options.max_faces = load_u32_from_gltf_extras(extras, "hull_max_faces");
+
+        const bool decompose = load_bool_from_gltf_extras(extras, "convex_decomposition");
+        const bool hull = load_bool_from_gltf_extras(extras, "convex_hull");
+        convex_decomposition_options options;
+        options.hull = hull_options;
+        if(uint32_t max_hulls = load_u32_from_gltf_extras(extras, "max_hulls"); max_hulls != 0)
+            options.max_hulls = max_hulls;
+
+        const std::array<std::uint64_t, 9> build_params = {
+            source_key, is_layers, sees_layers, decompose, hull, hull_options.max_verts, hull_options.max_faces, options.max_hulls, sizeof(T),
+        };
+        const std::uint64_t key = collision_shape_cache::make_key({ std::as_bytes(std::span(build_params)) });
+        if(std::optional<std::vector<collision_shape>> cooked = cache.find(key))
+            return std::move(*cooked);
+
+        std::vector<collision_shape> shapes;
+        if(decompose)
+            shapes = collision_shape::from_mesh_convex_decomposition(verts_span, indices_span, is_layers, sees_layers, options);
+        else if(hull)
+            shapes.push_back(collision_shape::from_mesh_convex_hull(verts_span, indices_span, is_layers, sees_layers, hull_options));
+        else
+            shapes.push_back(collision_shape::from_mesh(verts_span, indices_span, is_layers, sees_layers));
+        cache.insert(key, shapes);
+        return shapes;
+    }
 
     enum class colshape_load_error { NO_POSITION_ACCESSOR, POSITION_IS_NOT_VEC3 };
-    using colshape_or_error = std::variant<collision_shape, colshape_load_error>;
-    static colshape_or_error load_mesh_as_collision_shape(const tinygltf::Model& model, const tinygltf::Mesh& mesh, const tinygltf::Value& extras) {
+    using colshape_or_error = std::variant<std::vector<collision_shape>, colshape_load_error>;
+    static colshape_or_error load_mesh_as_collision_shapes(const tinygltf::Model& model, const tinygltf::Mesh& mesh, const tinygltf::Value& extras, collision_shape_cache& cache) {
         //TODO: multiple collision_shape primitives are currently unsupported
         UNIMPLEMENTED(mesh.primitives.size() == 1);
         const tinygltf::Primitive& primitive = mesh.primitives[0];
@@ -265,9 +345,6 @@ namespace engine {
         UNIMPLEMENTED(indices_accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT
                    || indices_accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT);
 
-        collision_layers_bitmask is_layers = load_u64_from_hex_string_from_gltf_extras(extras, "is_layers");
-        collision_layers_bitmask sees_layers = load_u64_from_hex_string_from_gltf_extras(extras, "sees_layers");
-
         int position_accessor_idx = -1;
         for (const auto& [attrib_name, accessor_idx] : primitive.attributes) {
             // the only relevant attribute for collision_shape is the position
@@ -305,12 +382,17 @@ namespace engine {
         const auto& indices_buf = model.buffers[indices_bufview.buffer];
 
         const unsigned char* base = &indices_buf.data[indices_bufview.byteOffset];
+        const std::uint64_t source_key = collision_shape_cache::make_key({
+            std::as_bytes(std::span(&position_buf.data[position_bufview.byteOffset], position_bufview.byteLength)),
+            std::as_bytes(std::span(base, indices_bufview.byteLength)),
+            std::as_bytes(std::span(&verts_stride, 1)),
+        });
         if(indices_accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT) {
             std::span<const glm::uvec3> indices_span(reinterpret_cast<const glm::uvec3*>(base), indices_bufview.byteLength / sizeof(glm::uvec3));
-            return engine::collision_shape::from_mesh(verts_span, indices_span, is_layers, sees_layers);
+            return make_collision_shapes(verts_span, indices_span, extras, cache, source_key);
         } else if (indices_accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT){
             std::span<const glm::u16vec3> indices_span(reinterpret_cast<const glm::u16vec3*>(base), indices_bufview.byteLength / sizeof(glm::u16vec3));
-            return engine::collision_shape::from_mesh(verts_span, indices_span, is_layers, sees_layers);
+            return make_collision_shapes(verts_span, indices_span, extras, cache, source_key);
         }
         throw std::runtime_error("given prior assertions this should be unreachable");
     }
@@ -326,15 +408,20 @@ namespace engine {
         return translation_mat * scale_mat * rotation_mat * raw_mat;
     }
 
-    static node_payload_t load_node_data(const tinygltf::Model& model, const tinygltf::Node& node, const rc<const shader>& shader) {
+    // a collision mesh decomposed in several convex parts has no payload: its parts are returned in decomposition_parts instead
+    static node_payload_t load_node_data(const tinygltf::Model& model, const tinygltf::Node& node, const rc<const shader>& shader, std::vector<collision_shape>& decomposition_parts, collision_shape_cache& cache) {
         if(node.mesh == -1)
             return std::monostate();
         const tinygltf::Mesh& mesh = model.meshes[node.mesh];
 
         if(node.name.ends_with("-col")) {
-            auto colshape_or_err = load_mesh_as_collision_shape(model, mesh, node.extras);
-            if(std::holds_alternative<collision_shape>(colshape_or_err)) {
-                return get_rm().new_from(std::move(std::get<collision_shape>(colshape_or_err)));
+            auto colshape_or_err = load_mesh_as_collision_shapes(model, mesh, node.extras, cache);
+            if(std::holds_alternative<std::vector<collision_shape>>(colshape_or_err)) {
+                std::vector<collision_shape>& shapes = std::get<std::vector<collision_shape>>(colshape_or_err);
+                if(shapes.size() == 1)
+                    return get_rm().new_from(std::move(shapes.front()));
+                decomposition_parts = std::move(shapes);
+                return std::monostate();
             } else {
                 auto err = std::get<colshape_load_error>(colshape_or_err);
                 std::string_view errstr;
@@ -355,22 +442,34 @@ namespace engine {
         }
     }
 
-    static std::unique_ptr<node> load_node_subtree(const tinygltf::Model& model, int idx, const rc<const shader>& shader) {
+    static std::unique_ptr<node> load_node_subtree(const tinygltf::Model& model, int idx, const rc<const shader>& shader, collision_shape_cache& cache) {
         const tinygltf::Node& gltf_node = model.nodes[idx];
 
-        node_payload_t node_data_variant = load_node_data(model, gltf_node, shader);
+        std::vector<collision_shape> decomposition_parts;
+        node_payload_t node_data_variant = load_node_data(model, gltf_node, shader, decomposition_parts, cache);
 
         glm::mat4 transform = get_node_transform(gltf_node);
         auto root = node::make(gltf_node.name, std::move(node_data_variant), transform);
+        const bool can_sleep = load_bool_from_gltf_extras(gltf_node.extras, "can_sleep");
+        const bool is_trigger = load_bool_from_gltf_extras(gltf_node.extras, "is_trigger");
+        const bool is_continuous = load_bool_from_gltf_extras(gltf_node.extras, "is_continuous");
         root->set_collision_behaviour(node_collision_behaviour {
             .moves_away_on_collision = load_bool_from_gltf_extras(gltf_node.extras, "moves_away_on_collision"),
             .passes_events_to_script = load_bool_from_gltf_extras(gltf_node.extras, "pass_collision_event_to_script"),
             .passes_events_to_father = load_bool_from_gltf_extras(gltf_node.extras, "pass_collision_event_to_father"),
+            .can_sleep = can_sleep,
+            .is_trigger = is_trigger,
+            .is_continuous = is_continuous,
         });
 
+        for(size_t i = 0; i < decomposition_parts.size(); i++) {
+            auto part = node::make(std::format("{}-part{}", gltf_node.name, i), get_rm().new_from(std::move(decomposition_parts[i])));
+            part->set_collision_behaviour(node_collision_behaviour { .passes_events_to_father = true, .can_sleep = can_sleep, .is_trigger = is_trigger, .is_continuous = is_continuous });
+            root->add_child(std::move(part));
+        }
 
         for(int child_idx : gltf_node.children) {
-            root->add_child(load_node_subtree(model, child_idx, shader));
+            root->add_child(load_node_subtree(model, child_idx, shader, cache));
         }
 
         return root;
@@ -387,10 +486,16 @@ namespace engine {
 
         auto root = node::make(filepath);
 
+        // the collision shapes cooked the last time the file was loaded; the ones built this time are added to it
+        collision_shape_cache colshape_cache(filepath + ".colshapes");
+
         const tinygltf::Scene& scene = model.scenes.at(0);
         list<int> node_idx_queue;
         for (int node_idx : scene.nodes)
-            root->add_child(load_node_subtree(model, node_idx, shader));
+            root->add_child(load_node_subtree(model, node_idx, shader, colshape_cache));
+
+        if(!colshape_cache.save())
+            slogga::stdout_log.warn("could not write the collision shape cache of {}", filepath);
 
         return engine::nodetree_blueprint(std::move(root), nonempty_node_name);
     }
@@ -1,8 +1,14 @@
 #include <engine/scene/node/narrow_phase_collision.hpp>
 #include <engine/scene/node.hpp>
 #include <slogga/asserts.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <climits> // CHAR_BIT
+#include <utility>
 #include <engine/utils/format_glm.hpp>
+#include <engine/utils/meta.hpp>
+#include <glm/gtc/matrix_access.hpp> // glm::row
 #include <slogga/log.hpp>
 
 namespace engine {
@@ -26,25 +32,9 @@ namespace engine {
         return ret;
     }
 
-    static std::optional<float> proj_on_axis_and_find_collision(const vec3& axis, const std::vector<vec3>& a_verts, const std::vector<vec3>& b_verts, mat4 b_to_a_space_trans) {
-        float min_a_proj = std::numeric_limits<float>::max();
-        float max_a_proj = std::numeric_limits<float>::lowest();
-        for(const vec3& v : a_verts) {
-            float proj = glm::dot(axis, v);
-
-            min_a_proj = std::min(min_a_proj, proj);
-            max_a_proj = std::max(max_a_proj, proj);
-        }
-
-        float min_b_proj = std::numeric_limits<float>::max();
-        float max_b_proj = std::numeric_limits<float>::lowest();
-        for(const vec3& v_b_space : b_verts) {
-            vec3 v = b_to_a_space_trans * vec4(v_b_space, 1);
-
-            float proj = glm::dot(axis, v);
-            min_b_proj = std::min(min_b_proj, proj);
-            max_b_proj = std::max(max_b_proj, proj);
-        }
+    static std::optional<float> find_collision(vec2 a_proj, vec2 b_proj) {
+        const auto [min_a_proj, max_a_proj] = std::pair(a_proj.x, a_proj.y);
+        const auto [min_b_proj, max_b_proj] = std::pair(b_proj.x, b_proj.y);
 
         if (min_a_proj <= max_b_proj && min_b_proj <= max_a_proj) {
             //collision!
@@ -63,15 +53,12 @@ namespace engine {
         }
     }
 
-    static bool project_and_update_min(const vec3& ax, const std::vector<vec3>& a_v, const std::vector<vec3> b_v, mat4 b_to_a, hashset<vec3>& dont_repeat, float& min_coll, vec3& min_coll_vec, mat4 trans_b4_saving) {
-        if(dont_repeat.contains(ax))
-            return true;
-        dont_repeat.insert(ax);
-
-        std::optional<float> coll = proj_on_axis_and_find_collision(ax, a_v, b_v, b_to_a);
+    static bool update_min(const vec3& ax, vec2 a_proj, vec2 b_proj, float& min_coll, vec3& min_coll_vec, vec3& min_coll_axis, const mat4& trans_b4_saving) {
+        std::optional<float> coll = find_collision(a_proj, b_proj);
         if(coll) {
             if(std::abs(*coll) < std::abs(min_coll)) {
                 min_coll_vec = trans_b4_saving * vec4(ax, 0);
+                min_coll_axis = ax;
                 min_coll = *coll;
             }
             return true;
@@ -79,72 +66,811 @@ namespace engine {
         return false;
     }
 
-    collision_result check_collision(const collision_shape& a, mat4 a_trans, const collision_shape& b, mat4 b_trans) {
-        hashset<vec3> dont_repeat;
+    // the largest factor by which trans scales lengths
+    static float max_scale(const mat4& trans) {
+        return std::sqrt(std::max({ glm::dot(vec3(trans[0]), vec3(trans[0])), glm::dot(vec3(trans[1]), vec3(trans[1])), glm::dot(vec3(trans[2]), vec3(trans[2])) }));
+    }
+
+    // whether linear is a rotation and/or reflection times a uniform scale, i.e. transpose(linear) * linear == scale^2 * I; if so returns scale^2
+    static std::optional<float> similarity_squared_scale(const mat3& linear) {
+        const mat3 m = glm::transpose(linear) * linear;
+        const float c = m[0][0];
+        constexpr float eps = 1e-4f;
+        const float tolerance = eps * std::max(c, std::numeric_limits<float>::min());
+        for(int i = 0; i < 3; i++) {
+            for(int j = 0; j < 3; j++) {
+                if(std::abs(m[i][j] - (i == j ? c : 0.f)) > tolerance) //NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access)
+                    return std::nullopt;
+            }
+        }
+        return c;
+    }
+
+    /* The set of axes check_collision has already tested, so that parallel axes are only tested once: an open addressing
+     * table whose slots are stamped with the generation (i.e. the call to clear) they were filled in, so that clearing it
+     * is O(1) and, once it has grown to the size the largest shapes need, inserting never allocates.
+     */
+    class axis_set {
+        struct slot {
+            vec3 axis;
+            std::uint32_t generation = 0;
+        };
+        std::vector<slot> m_slots;
+        std::uint32_t m_generation = 1; // slots stamped with any other generation are empty
+        std::size_t m_size = 0;
+
+        static std::size_t hash(vec3 axis) {
+            std::uint64_t h = std::bit_cast<std::uint32_t>(axis.x);
+            h = h * 0x9e3779b97f4a7c15ull ^ std::bit_cast<std::uint32_t>(axis.y);
+            h = h * 0x9e3779b97f4a7c15ull ^ std::bit_cast<std::uint32_t>(axis.z);
+            return std::size_t(h ^ (h >> 29));
+        }
+
+        // returns the slot holding axis, or the empty one where it should be inserted
+        slot& find(vec3 axis) {
+            const std::size_t mask = m_slots.size() - 1;
+            for(std::size_t i = hash(axis) & mask; ; i = (i + 1) & mask) {
+                slot& s = m_slots[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i <= mask < m_slots.size()
+                if(s.generation != m_generation || s.axis == axis)
+                    return s;
+            }
+        }
+
+        void grow() {
+            std::vector<slot> old = std::exchange(m_slots, std::vector<slot>(std::max<std::size_t>(64, 2 * m_slots.size())));
+            for(const slot& s : old) {
+                if(s.generation == m_generation)
+                    find(s.axis) = s;
+            }
+        }
+    public:
+        void clear() {
+            m_size = 0;
+            if(++m_generation == 0) {
+                // the stamps wrapped around: old slots could be mistaken for current ones
+                for(slot& s : m_slots)
+                    s.generation = 0;
+                m_generation = 1;
+            }
+        }
+
+        // returns false if axis was already in the set
+        bool insert(vec3 axis) {
+            axis += vec3(0.f); // -0 becomes +0, so that axes comparing equal have the same bits and hash
+            if(2 * (m_size + 1) > m_slots.size())
+                grow(); // keep the table at most half full
+
+            slot& s = find(axis);
+            if(s.generation == m_generation)
+                return false;
+
+            s = { .axis = axis, .generation = m_generation };
+            m_size++;
+            return true;
+        }
+    };
+
+    /* A convex shape as gjk and epa see it: through its support function, the point of the shape (in world space) farthest
+     * along a direction. For a shape S transformed by T(x) = M x + t, support(d) = T(support_S(M^T d)), so this works with
+     * any affine transform, shears and non uniform scales included.
+     */
+    class support_shape {
+        const collision_shape& m_shape;
+        const mat4& m_trans;
+        mat3 m_linear_transposed;
+
+        vec3 local_support(vec3 d) const {
+            const float len = glm::length(d);
+            const vec3 unit = len > 0.f ? d / len : vec3(0, 1, 0);
+            return std::visit(merge_callables {
+                [&](std::monostate) { return m_shape.polytope.support(d); },
+                [&](const sphere_primitive& s) { return s.center + s.radius * unit; },
+                [&](const capsule_primitive& c) { return c.center + vec3(0, d.y < 0.f ? -c.half_height : c.half_height, 0) + c.radius * unit; },
+                [&](const box_primitive& b) { return b.center + glm::mix(b.half_extents, -b.half_extents, glm::lessThan(d, vec3(0))); },
+            }, m_shape.primitive);
+        }
+    public:
+        support_shape(const collision_shape& shape, const mat4& trans) : m_shape(shape), m_trans(trans), m_linear_transposed(glm::transpose(mat3(trans))) {}
+
+        vec3 support(vec3 dir) const { return vec3(m_trans * vec4(local_support(m_linear_transposed * dir), 1)); }
+        vec3 center() const { return vec3(m_trans * vec4(m_shape.bounding_sphere_center, 1)); }
+    };
+
+    // a point of the minkowski difference a - b, with the points of a and b it comes from
+    struct minkowski_point {
+        vec3 w;
+        vec3 a;
+        vec3 b;
+
+        static minkowski_point support(const support_shape& a, const support_shape& b, vec3 dir) {
+            const vec3 a_point = a.support(dir), b_point = b.support(-dir);
+            return { .w = a_point - b_point, .a = a_point, .b = b_point };
+        }
+    };
+
+    // barycentric coordinates of the point of segment ab closest to the origin
+    static vec2 segment_closest_to_origin(vec3 a, vec3 b) {
+        const vec3 ab = b - a;
+        const float len2 = glm::dot(ab, ab);
+        const float t = len2 > 0.f ? std::clamp(-glm::dot(a, ab) / len2, 0.f, 1.f) : 0.f;
+        return { 1.f - t, t };
+    }
+
+    // barycentric coordinates of the point of triangle abc closest to the origin (from Ericson's Real-Time Collision Detection, 5.1.5)
+    static vec3 triangle_closest_to_origin(vec3 a, vec3 b, vec3 c) {
+        const vec3 ab = b - a, ac = c - a;
+        const float d1 = glm::dot(ab, -a), d2 = glm::dot(ac, -a);
+        if(d1 <= 0.f && d2 <= 0.f)
+            return { 1, 0, 0 };
+        const float d3 = glm::dot(ab, -b), d4 = glm::dot(ac, -b);
+        if(d3 >= 0.f && d4 <= d3)
+            return { 0, 1, 0 };
+        const float vc = d1 * d4 - d3 * d2;
+        if(vc <= 0.f && d1 >= 0.f && d3 <= 0.f)
+            return { 1.f - d1 / (d1 - d3), d1 / (d1 - d3), 0 };
+        const float d5 = glm::dot(ab, -c), d6 = glm::dot(ac, -c);
+        if(d6 >= 0.f && d5 <= d6)
+            return { 0, 0, 1 };
+        const float vb = d5 * d2 - d1 * d6;
+        if(vb <= 0.f && d2 >= 0.f && d6 <= 0.f)
+            return { 1.f - d2 / (d2 - d6), 0, d2 / (d2 - d6) };
+        const float va = d3 * d6 - d5 * d4;
+        if(va <= 0.f && d4 - d3 >= 0.f && d5 - d6 >= 0.f) {
+            const float t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+            return { 0, 1.f - t, t };
+        }
+        if(va + vb + vc <= 0.f) {
+            // degenerate (collinear) triangle: its closest point is on one of its edges
+            const vec2 ab_t = segment_closest_to_origin(a, b), ac_t = segment_closest_to_origin(a, c), bc_t = segment_closest_to_origin(b, c);
+            const std::array<vec3, 3> candidates = {{ { ab_t, 0 }, { ac_t.x, 0, ac_t.y }, { 0, bc_t } }};
+            return *std::ranges::min_element(candidates, {}, [&](vec3 bary) { const vec3 p = bary.x * a + bary.y * b + bary.z * c; return glm::dot(p, p); });
+        }
+        const float denom = 1.f / (va + vb + vc);
+        return { 1.f - (vb + vc) * denom, vb * denom, vc * denom };
+    }
+
+    /* Gjk's simplex: at most 4 points of the minkowski difference and the barycentric coordinates of the point of their hull
+     * closest to the origin; reduce() finds that point and drops the points it does not depend on.
+     */
+    class gjk_simplex {
+        std::array<minkowski_point, 4> m_points{};
+        std::array<float, 4> m_bary{};
+        std::uint32_t m_size = 0;
+
+        // keeps the points with nonzero coordinates among the given ones
+        template<std::size_t N>
+        void keep(const std::array<std::uint32_t, N>& indices, const std::array<float, N>& bary) {
+            const std::array<minkowski_point, 4> points = m_points;
+            m_size = 0;
+            for(std::size_t i = 0; i < N; i++) {
+                if(bary[i] > 0.f) { //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index) // i < N
+                    m_points[m_size] = points[indices[i]]; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index) // m_size <= i < N <= 4, valid indices
+                    m_bary[m_size] = bary[i]; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index) // m_size <= i < N <= 4
+                    m_size++;
+                }
+            }
+        }
+
+        const vec3& w(std::uint32_t i) const { return m_points[i].w; } //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index) // only called with i < m_size
+
+        void reduce_triangle(std::uint32_t i, std::uint32_t j, std::uint32_t k) {
+            const vec3 bary = triangle_closest_to_origin(w(i), w(j), w(k));
+            keep<3>({ i, j, k }, { bary.x, bary.y, bary.z });
+        }
+    public:
+        std::uint32_t size() const { return m_size; }
+        std::span<const minkowski_point> points() const { return std::span(m_points).first(m_size); }
+
+        void clear() { m_size = 0; }
+        void push(const minkowski_point& p) {
+            EXPECTS(m_size < 4);
+            m_points[m_size] = p; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index) // m_size < 4
+            m_bary[m_size] = 0.f; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index) // m_size < 4
+            m_size++;
+        }
+        bool contains(vec3 w) const {
+            return std::ranges::any_of(points(), [&](const minkowski_point& p) { return p.w == w; });
+        }
+
+        // the closest point to the origin, and the points of a and b it comes from
+        minkowski_point closest() const {
+            minkowski_point ret { .w = vec3(0), .a = vec3(0), .b = vec3(0) };
+            for(std::uint32_t i = 0; i < m_size; i++) {
+                const minkowski_point& p = m_points[i]; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index) // i < m_size <= 4
+                const float bary = m_bary[i]; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index) // i < m_size <= 4
+                ret.w += bary * p.w;
+                ret.a += bary * p.a;
+                ret.b += bary * p.b;
+            }
+            return ret;
+        }
+
+        // returns true if the origin is inside the simplex (which is then a tetrahedron)
+        bool reduce() {
+            switch(m_size) {
+            case 1:
+                m_bary[0] = 1.f;
+                return false;
+            case 2: {
+                const vec2 bary = segment_closest_to_origin(w(0), w(1));
+                keep<2>({ 0, 1 }, { bary.x, bary.y });
+                return false;
+            }
+            case 3:
+                reduce_triangle(0, 1, 2);
+                return false;
+            default: {
+                ASSERTS(m_size == 4);
+                // the origin is inside unless it is beyond some face; then the closest point is on one of those faces. if the
+                // tetrahedron is (almost) flat, the sides of the origin are down to rounding: then the origin is beyond them all
+                const vec3 e1 = w(1) - w(0), e2 = w(2) - w(0), e3 = w(3) - w(0);
+                const bool flat = std::abs(glm::dot(glm::cross(e1, e2), e3)) <= 1e-5f * glm::length(e1) * glm::length(e2) * glm::length(e3);
+                constexpr std::array<std::array<std::uint32_t, 4>, 4> faces = {{ { 0, 1, 2, 3 }, { 0, 1, 3, 2 }, { 0, 2, 3, 1 }, { 1, 2, 3, 0 } }};
+                float best_dist = std::numeric_limits<float>::max();
+                std::optional<std::array<std::uint32_t, 3>> best_face;
+                for(const auto& [i, j, k, opposite] : faces) {
+                    const vec3 n = glm::cross(w(j) - w(i), w(k) - w(i));
+                    const float origin_side = glm::dot(n, -w(i)), opposite_side = glm::dot(n, w(opposite) - w(i));
+                    if(!flat && origin_side * opposite_side >= 0.f)
+                        continue; // the origin is on the same side of the face as the rest of the tetrahedron
+
+                    const vec3 bary = triangle_closest_to_origin(w(i), w(j), w(k));
+                    const vec3 p = bary.x * w(i) + bary.y * w(j) + bary.z * w(k);
+                    if(glm::dot(p, p) < best_dist) {
+                        best_dist = glm::dot(p, p);
+                        best_face = { i, j, k };
+                    }
+                }
+                if(!best_face)
+                    return true;
+                reduce_triangle((*best_face)[0], (*best_face)[1], (*best_face)[2]);
+                return false;
+            }
+            }
+        }
+    };
+
+    /* Gjk: searches the point of the minkowski difference a - b closest to the origin, i.e. the shapes' closest points.
+     * Returns false if the shapes intersect (or are closer than tolerance), leaving in simplex points of a - b around the
+     * origin for epa.
+     */
+    static bool gjk(const support_shape& a, const support_shape& b, float tolerance, gjk_simplex& simplex) {
+        constexpr int max_iterations = 64;
+        constexpr float relative_convergence = 1e-6f;
+
+        vec3 dir = a.center() - b.center();
+        if(dir == vec3(0))
+            dir = vec3(1, 0, 0);
+
+        simplex.clear();
+        simplex.push(minkowski_point::support(a, b, dir));
+        simplex.reduce();
+        vec3 v = simplex.closest().w;
+
+        for(int i = 0; i < max_iterations; i++) {
+            const float v2 = glm::dot(v, v);
+            if(v2 <= tolerance * tolerance)
+                return false;
+
+            const minkowski_point p = minkowski_point::support(a, b, -v);
+            // no point of a - b is (significantly) closer to the origin along v than the closest point found so far
+            const float progress = v2 - glm::dot(v, p.w);
+            if(progress <= relative_convergence * v2 || progress <= tolerance * std::sqrt(v2) || simplex.contains(p.w))
+                return true;
+
+            simplex.push(p);
+            if(simplex.reduce())
+                return false;
+
+            const vec3 next_v = simplex.closest().w;
+            if(glm::dot(next_v, next_v) >= v2)
+                return true; // no progress: rounding errors dominate
+            v = next_v;
+        }
+        return true;
+    }
+
+    // epa's polytope face: indices into the points, counterclockwise seen from outside, and its plane
+    struct epa_face {
+        std::array<std::uint32_t, 3> indices;
+        vec3 normal;
+        float distance;
+    };
+
+    // check_collision's scratch buffers, kept across calls so that it does not allocate once they have grown enough
+    struct narrow_phase_scratch {
+        soa_points b_verts;
+        axis_set dont_repeat;
+        // epa's polytope
+        std::vector<minkowski_point> epa_points;
+        std::vector<epa_face> epa_faces;
+        std::vector<std::array<std::uint32_t, 2>> epa_horizon;
+    };
+
+    static narrow_phase_scratch& get_scratch() {
+        thread_local narrow_phase_scratch scratch;
+        return scratch;
+    }
+
+    // grows gjk's simplex, which contains the origin (possibly on its boundary), to a tetrahedron; false if a - b is flat
+    static bool complete_simplex(const support_shape& a, const support_shape& b, float tolerance, gjk_simplex& simplex) {
+        constexpr std::array<vec3, 6> axes = {{ { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } }};
+
+        if(simplex.size() == 1) {
+            for(vec3 axis : axes) {
+                const minkowski_point p = minkowski_point::support(a, b, axis);
+                if(glm::distance(p.w, simplex.points()[0].w) > tolerance) {
+                    simplex.push(p);
+                    break;
+                }
+            }
+        }
+        if(simplex.size() == 2) {
+            const vec3 line = simplex.points()[1].w - simplex.points()[0].w;
+            for(vec3 axis : axes) {
+                const vec3 dir = glm::cross(line, axis);
+                if(glm::dot(dir, dir) == 0.f)
+                    continue;
+                const minkowski_point p = minkowski_point::support(a, b, dir);
+                if(glm::length(glm::cross(p.w - simplex.points()[0].w, line)) > tolerance * glm::length(line)) {
+                    simplex.push(p);
+                    break;
+                }
+            }
+        }
+        if(simplex.size() == 3) {
+            const std::span<const minkowski_point> points = simplex.points();
+            const vec3 normal = glm::cross(points[1].w - points[0].w, points[2].w - points[0].w);
+            const float len = glm::length(normal);
+            if(len == 0.f)
+                return false;
+            for(float sign : { 1.f, -1.f }) {
+                const minkowski_point p = minkowski_point::support(a, b, sign * normal);
+                if(std::abs(glm::dot(p.w - points[0].w, normal / len)) > tolerance) {
+                    simplex.push(p);
+                    break;
+                }
+            }
+        }
+        return simplex.size() == 4;
+    }
+
+    /* Epa: expands a polytope inside a - b, starting from gjk's simplex, towards the face of a - b closest to the origin; its
+     * distance is the penetration depth and its normal the direction a should move away from (b's direction from a).
+     */
+    static collision_result epa(const support_shape& a, const support_shape& b, float tolerance, gjk_simplex& simplex) {
+        constexpr int max_iterations = 128;
+        constexpr std::size_t max_faces = 1024;
+
+        if(!complete_simplex(a, b, tolerance, simplex)) {
+            // a - b is flat and contains the origin: the shapes touch without overlapping
+            const vec3 dir = b.center() - a.center();
+            return { dir != vec3(0) ? glm::normalize(dir) : vec3(0, 1, 0), 0.f };
+        }
+
+        narrow_phase_scratch& scratch = get_scratch();
+        std::vector<minkowski_point>& points = scratch.epa_points;
+        std::vector<epa_face>& faces = scratch.epa_faces;
+        std::vector<std::array<std::uint32_t, 2>>& horizon = scratch.epa_horizon;
+        points.assign(simplex.points().begin(), simplex.points().end());
+        faces.clear();
+
+        const vec3 inside = (points[0].w + points[1].w + points[2].w + points[3].w) * .25f; //NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // the simplex is a tetrahedron
+        auto add_face = [&](std::uint32_t i, std::uint32_t j, std::uint32_t k) {
+            const vec3& p0 = points[i].w; //NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid indices
+            vec3 normal = glm::cross(points[j].w - p0, points[k].w - p0); //NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid indices
+            const float len = glm::length(normal);
+            if(len == 0.f)
+                return;
+            normal /= len;
+            if(glm::dot(normal, p0 - inside) < 0.f) {
+                normal = -normal;
+                std::swap(j, k);
+            }
+            faces.push_back({ .indices = { i, j, k }, .normal = normal, .distance = glm::dot(normal, p0) });
+        };
+        add_face(0, 1, 2);
+        add_face(0, 3, 1);
+        add_face(0, 2, 3);
+        add_face(1, 3, 2);
+
+        for(int iteration = 0; iteration < max_iterations && faces.size() < max_faces; iteration++) {
+            if(faces.empty())
+                break;
+            const epa_face closest = *std::ranges::min_element(faces, {}, &epa_face::distance);
+
+            const minkowski_point p = minkowski_point::support(a, b, closest.normal);
+            if(glm::dot(p.w, closest.normal) - closest.distance <= tolerance)
+                break;
+
+            // remove the faces p sees, keeping the edges between them and the others (each edge is shared by two faces,
+            // walked in opposite directions: edges walked once are on the horizon)
+            horizon.clear();
+            for(std::size_t f = 0; f < faces.size(); ) {
+                const epa_face& face = faces[f]; //NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // f < faces.size()
+                if(glm::dot(face.normal, p.w - points[face.indices[0]].w) <= 0.f) { //NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid index
+                    f++;
+                    continue;
+                }
+                for(std::size_t e = 0; e < 3; e++) {
+                    const std::array<std::uint32_t, 2> edge = { face.indices[e], face.indices[(e + 1) % 3] }; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index) // e < 3
+                    auto reverse = std::ranges::find(horizon, std::array<std::uint32_t, 2>{ edge[1], edge[0] });
+                    if(reverse != horizon.end()) {
+                        *reverse = horizon.back();
+                        horizon.pop_back();
+                    } else {
+                        horizon.push_back(edge);
+                    }
+                }
+                faces[f] = faces.back(); //NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // f < faces.size()
+                faces.pop_back();
+            }
+
+            const std::uint32_t new_point = (std::uint32_t)points.size();
+            points.push_back(p);
+            for(const auto& [from, to] : horizon)
+                add_face(from, to, new_point);
+        }
+
+        if(faces.empty())
+            return { vec3(0, 1, 0), 0.f }; // only reachable with degenerate (e.g. nan) inputs
+        const epa_face& closest = *std::ranges::min_element(faces, {}, &epa_face::distance);
+        return { closest.normal, std::max(closest.distance, 0.f) };
+    }
+
+    // the segment and radius of a sphere (whose segment is a point) or capsule, in world space
+    struct world_capsule {
+        vec3 p;
+        vec3 q;
+        float radius;
+    };
+    static world_capsule to_world_capsule(const collision_shape& shape, const mat4& trans, float scale) {
+        if(const auto* s = std::get_if<sphere_primitive>(&shape.primitive)) {
+            const vec3 center = trans * vec4(s->center, 1);
+            return { .p = center, .q = center, .radius = s->radius * scale };
+        }
+        const auto& c = std::get<capsule_primitive>(shape.primitive);
+        return { .p = trans * vec4(c.center - vec3(0, c.half_height, 0), 1), .q = trans * vec4(c.center + vec3(0, c.half_height, 0), 1), .radius = c.radius * scale };
+    }
+
+    // the closest points of segments p1q1 and p2q2 (from Ericson's Real-Time Collision Detection, 5.1.9)
+    static std::pair<vec3, vec3> closest_points_of_segments(vec3 p1, vec3 q1, vec3 p2, vec3 q2) {
+        const vec3 d1 = q1 - p1, d2 = q2 - p2, r = p1 - p2;
+        const float a = glm::dot(d1, d1), e = glm::dot(d2, d2), f = glm::dot(d2, r);
+        float s = 0.f, t = 0.f;
+        if(a == 0.f && e == 0.f)
+            return { p1, p2 };
+        if(a == 0.f) {
+            t = std::clamp(f / e, 0.f, 1.f);
+        } else {
+            const float c = glm::dot(d1, r);
+            if(e == 0.f) {
+                s = std::clamp(-c / a, 0.f, 1.f);
+            } else {
+                const float b = glm::dot(d1, d2);
+                const float denom = a * e - b * b;
+                s = denom != 0.f ? std::clamp((b * f - c * e) / denom, 0.f, 1.f) : 0.f;
+                t = (b * s + f) / e;
+                if(t < 0.f) {
+                    t = 0.f;
+                    s = std::clamp(-c / a, 0.f, 1.f);
+                } else if(t > 1.f) {
+                    t = 1.f;
+                    s = std::clamp((b - c) / a, 0.f, 1.f);
+                }
+            }
+        }
+        return { p1 + d1 * s, p2 + d2 * t };
+    }
+
+    // sphere-sphere, sphere-capsule and capsule-capsule: their distance is their segments' minus their radii
+    static collision_result check_round_collision(const world_capsule& a, const world_capsule& b) {
+        const auto [a_point, b_point] = closest_points_of_segments(a.p, a.q, b.p, b.q);
+        const vec3 d = b_point - a_point;
+        const float radii = a.radius + b.radius;
+        if(glm::dot(d, d) > radii * radii)
+            return collision_result::null();
+
+        const float dist = glm::length(d);
+        if(dist > 0.f)
+            return { d / dist, radii - dist };
+
+        // the segments cross: push apart perpendicularly to both, towards b's center
+        const vec3 a_dir = a.q - a.p, b_dir = b.q - b.p;
+        vec3 versor = glm::cross(a_dir, b_dir);
+        for(vec3 axis : { vec3(1, 0, 0), vec3(0, 1, 0), vec3(0, 0, 1) }) {
+            if(glm::dot(versor, versor) != 0.f)
+                break;
+            versor = glm::cross(a_dir + b_dir, axis); // parallel segments
+        }
+        versor = glm::dot(versor, versor) != 0.f ? glm::normalize(versor) : vec3(0, 1, 0); // concentric spheres
+        if(glm::dot(versor, b.p + b.q - a.p - a.q) < 0.f)
+            versor = -versor;
+        return { versor, radii };
+    }
+
+    // sphere against box, in the box's space; the result is the sphere's
+    static collision_result check_sphere_box_collision(const sphere_primitive& sphere, const mat4& sphere_trans, float sphere_scale, const box_primitive& box, const mat4& box_trans, float box_scale) {
+        const vec3 center = vec3(glm::inverse(box_trans) * sphere_trans * vec4(sphere.center, 1)) - box.center;
+        const float radius = sphere.radius * sphere_scale / box_scale;
+
+        const vec3 closest = glm::clamp(center, -box.half_extents, box.half_extents);
+        const vec3 d = center - closest;
+        const float dist2 = glm::dot(d, d);
+        if(dist2 > radius * radius)
+            return collision_result::null();
+
+        vec3 normal; // from the box to the sphere
+        float depth;
+        if(dist2 > 0.f) {
+            const float dist = std::sqrt(dist2);
+            normal = d / dist;
+            depth = radius - dist;
+        } else {
+            // the center is inside the box: push it out through the closest face
+            const vec3 face_dist = box.half_extents - glm::abs(center);
+            const int axis = face_dist.x <= face_dist.y && face_dist.x <= face_dist.z ? 0 : face_dist.y <= face_dist.z ? 1 : 2;
+            normal = vec3(0);
+            normal[axis] = center[axis] < 0.f ? -1.f : 1.f; //NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // axis < 3
+            depth = radius + face_dist[axis]; //NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // axis < 3
+        }
+        return { -glm::normalize(mat3(box_trans) * normal), depth * box_scale };
+    }
+
+    // the closed forms for pairs involving a sphere or a capsule, if the pair has one: when both transforms are similarities
+    // (so spheres stay spheres), for sphere/capsule pairs and sphere-box
+    static std::optional<collision_result> check_closed_form_collision(const collision_shape& a, const mat4& a_trans, const collision_shape& b, const mat4& b_trans) {
+        const std::optional<float> a_squared_scale = similarity_squared_scale(mat3(a_trans));
+        const std::optional<float> b_squared_scale = similarity_squared_scale(mat3(b_trans));
+        if(!a_squared_scale || !b_squared_scale)
+            return std::nullopt;
+
+        const float a_scale = std::sqrt(*a_squared_scale), b_scale = std::sqrt(*b_squared_scale);
+        auto is_round = [](const collision_shape& s) { return std::holds_alternative<sphere_primitive>(s.primitive) || std::holds_alternative<capsule_primitive>(s.primitive); };
+
+        if(is_round(a) && is_round(b))
+            return check_round_collision(to_world_capsule(a, a_trans, a_scale), to_world_capsule(b, b_trans, b_scale));
+
+        const auto* a_sphere = std::get_if<sphere_primitive>(&a.primitive);
+        const auto* b_sphere = std::get_if<sphere_primitive>(&b.primitive);
+        const auto* a_box = std::get_if<box_primitive>(&a.primitive);
+        const auto* b_box = std::get_if<box_primitive>(&b.primitive);
+        if(a_sphere && b_box)
+            return check_sphere_box_collision(*a_sphere, a_trans, a_scale, *b_box, b_trans, b_scale);
+        if(a_box && b_sphere)
+            return -check_sphere_box_collision(*b_sphere, b_trans, b_scale, *a_box, a_trans, a_scale);
+        return std::nullopt;
+    }
+
+    // pairs involving a sphere or a capsule: closed forms when possible, gjk and epa otherwise
+    static collision_result check_primitive_collision(const collision_shape& a, const mat4& a_trans, const collision_shape& b, const mat4& b_trans, float size) {
+        if(const std::optional<collision_result> res = check_closed_form_collision(a, a_trans, b, b_trans))
+            return *res;
+
+        const support_shape a_support(a, a_trans), b_support(b, b_trans);
+        const float tolerance = 1e-5f * size;
+        gjk_simplex simplex;
+        if(gjk(a_support, b_support, tolerance, simplex))
+            return collision_result::null();
+        return epa(a_support, b_support, 10.f * tolerance, simplex);
+    }
+
+    // whether check_collision can test the shape with sat
+    static bool is_polytope(const collision_shape& shape) {
+        return std::holds_alternative<std::monostate>(shape.primitive) || std::holds_alternative<box_primitive>(shape.primitive);
+    }
+
+    static collision_result check_collision_impl(const collision_shape& a, const mat4& a_trans, const collision_shape& b, const mat4& b_trans, collision_axis_hint* hint) {
+        if(hint != nullptr)
+            hint->separated_early = false;
+
+        // early rejection: bounding spheres, in world space
+        const float radii = a.bounding_sphere_radius * max_scale(a_trans) + b.bounding_sphere_radius * max_scale(b_trans);
+        {
+            const vec3 a_center = a_trans * vec4(a.bounding_sphere_center, 1);
+            const vec3 b_center = b_trans * vec4(b.bounding_sphere_center, 1);
+            const vec3 d = a_center - b_center;
+            if(glm::dot(d, d) > radii * radii)
+                return collision_result::null();
+        }
 
-        mat4 b_to_a_space_trans = inverse(a_trans) * b_trans;
+        if(!is_polytope(a) || !is_polytope(b))
+            return check_primitive_collision(a, a_trans, b, b_trans, radii);
+
+        const mat4 b_to_a_space_trans = inverse(a_trans) * b_trans;
+
+        // early rejection: local aabbs, in a's space
+        if(!a.local_aabb.overlaps(b.local_aabb.transform(b_to_a_space_trans)))
+            return collision_result::null();
+
+        narrow_phase_scratch& scratch = get_scratch();
+
+        // b's verts are transformed to a's space once, instead of once per axis
+        soa_points& b_verts = scratch.b_verts;
+        b.polytope.transform_verts(b_to_a_space_trans, b_verts);
+
+        // the axis which separated the shapes last time is the likeliest to separate them now
+        if(hint != nullptr && hint->axis != vec3(0) && !find_collision(a.polytope.project(hint->axis), b_verts.project(hint->axis))) {
+            hint->separated_early = true;
+            return collision_result::null();
+        }
+
+        axis_set& dont_repeat = scratch.dont_repeat;
+        dont_repeat.clear();
 
         float min_col = std::numeric_limits<float>::max();
         vec3 min_col_dir;
+        vec3 min_col_axis = vec3(0);
+        // the hint remembers the axis which ended the test: a separating one, or the one of least overlap
+        auto separated_by = [&](vec3 axis) {
+            if(hint != nullptr)
+                hint->axis = axis;
+            return collision_result::null();
+        };
+        auto collided = [&]() {
+            if(hint != nullptr)
+                hint->axis = min_col_axis;
+            return collision_result{ min_col_dir, min_col };
+        };
 
-        for(vec3 face_normal : a.face_normals) {
-            if(!project_and_update_min(face_normal, a.verts, b.verts, b_to_a_space_trans, dont_repeat, min_col, min_col_dir, a_trans))
-                return collision_result::null();
+        // on a's face normals, a's projections are precomputed
+        for(std::size_t i = 0; i < a.polytope.face_count(); i++) {
+            const vec3 face_normal = a.polytope.face_normal(i);
+            if(!dont_repeat.insert(face_normal))
+                continue;
+
+            const vec2 a_proj = a.polytope.face_normal_extents(i);
+            if(!update_min(face_normal, a_proj, b_verts.project(face_normal), min_col, min_col_dir, min_col_axis, a_trans))
+                return separated_by(face_normal);
 
             if(min_col == 0.f)
-                return collision_result{ min_col_dir, min_col };
+                return collided();
         }
 
-        for(vec3 face_normal_b_space : b.face_normals) {
-            vec3 face_normal = b_to_a_space_trans * vec4(face_normal_b_space, 0.0);
-            face_normal = normalize_without_verse(face_normal);
+        // on b's face normals, so are b's if b_to_a_space_trans preserves angles (no shear nor non-uniform scaling): then for
+        // axis = s * M n / |M n| (with s = +-1, M the linear part of the transform and t its translation),
+        // dot(axis, M v + t) = s * scale^2 / |M n| * dot(n, v) + dot(axis, t)
+        const mat3 b_to_a_linear = mat3(b_to_a_space_trans);
+        const vec3 b_to_a_translation = vec3(b_to_a_space_trans[3]);
+        const std::optional<float> b_to_a_squared_scale = similarity_squared_scale(b_to_a_linear);
 
-            if(!project_and_update_min(face_normal, a.verts, b.verts, b_to_a_space_trans, dont_repeat, min_col, min_col_dir, a_trans))
-                return collision_result::null();
+        for(std::size_t i = 0; i < b.polytope.face_count(); i++) {
+            const vec3 transformed_normal = b_to_a_linear * b.polytope.face_normal(i);
+            const vec3 face_normal = normalize_without_verse(transformed_normal);
+            if(!dont_repeat.insert(face_normal))
+                continue;
+
+            vec2 b_proj;
+            if(b_to_a_squared_scale && face_normal != vec3(0)) {
+                const float sign = glm::dot(face_normal, transformed_normal) > 0.f ? 1.f : -1.f;
+                const float k = sign * *b_to_a_squared_scale / glm::length(transformed_normal);
+                const vec2 ext = b.polytope.face_normal_extents(i) * k;
+                b_proj = vec2(std::min(ext.x, ext.y), std::max(ext.x, ext.y)) + glm::dot(face_normal, b_to_a_translation);
+            } else {
+                b_proj = b_verts.project(face_normal);
+            }
+
+            if(!update_min(face_normal, a.polytope.project(face_normal), b_proj, min_col, min_col_dir, min_col_axis, a_trans))
+                return separated_by(face_normal);
 
             if(min_col == 0.f)
-                return collision_result{ min_col_dir, min_col };
+                return collided();
         }
 
 
-        for(vec3 b_edge_b_space : b.edges) {
-            vec3 b_edge = b_to_a_space_trans * vec4(b_edge_b_space, 0.0);
+        for(std::size_t i = 0; i < b.polytope.edge_count(); i++) {
+            vec3 b_edge = b_to_a_space_trans * vec4(b.polytope.edge(i), 0.0);
 
-            for(vec3 a_edge : a.edges) {
+            for(std::size_t j = 0; j < a.polytope.edge_count(); j++) {
+                const vec3 a_edge = a.polytope.edge(j);
                 if(min_col == 0.f)
-                    return collision_result { min_col_dir, min_col };
+                    return collided();
 
                 vec3 axis = normalize_without_verse(glm::cross(vec3(a_edge), vec3(b_edge)));
                 if (axis == vec3(0)) { continue; }
+                if(!dont_repeat.insert(axis))
+                    continue;
 
-                if(!project_and_update_min(axis, a.verts, b.verts, b_to_a_space_trans, dont_repeat, min_col, min_col_dir, a_trans)) {
-                    return collision_result::null();
+                if(!update_min(axis, a.polytope.project(axis), b_verts.project(axis), min_col, min_col_dir, min_col_axis, a_trans)) {
+                    return separated_by(axis);
                 }
             }
         }
 
-        return collision_result{ min_col_dir, min_col };
+        return collided();
+    }
+
+    collision_result check_collision(const collision_shape& a, const mat4& a_trans, const collision_shape& b, const mat4& b_trans) {
+        return check_collision_impl(a, a_trans, b, b_trans, nullptr);
+    }
+
+    bool check_overlap(const collision_shape& a, const mat4& a_trans, const collision_shape& b, const mat4& b_trans, collision_axis_hint& hint) {
+        hint.separated_early = false;
+
+        const float radii = a.bounding_sphere_radius * max_scale(a_trans) + b.bounding_sphere_radius * max_scale(b_trans);
+        {
+            const vec3 d = vec3(a_trans * vec4(a.bounding_sphere_center, 1)) - vec3(b_trans * vec4(b.bounding_sphere_center, 1));
+            if(glm::dot(d, d) > radii * radii)
+                return false;
+        }
+
+        // the closed forms are cheaper than gjk, and agree with check_collision on touching shapes
+        const bool polytopes = is_polytope(a) && is_polytope(b);
+        if(!polytopes) {
+            if(const std::optional<collision_result> res = check_closed_form_collision(a, a_trans, b, b_trans))
+                return bool(*res);
+        } else {
+            const mat4 b_to_a_space_trans = inverse(a_trans) * b_trans;
+            if(!a.local_aabb.overlaps(b.local_aabb.transform(b_to_a_space_trans)))
+                return false;
+
+            if(hint.axis != vec3(0)) {
+                soa_points& b_verts = get_scratch().b_verts;
+                b.polytope.transform_verts(b_to_a_space_trans, b_verts);
+                if(!find_collision(a.polytope.project(hint.axis), b_verts.project(hint.axis))) {
+                    hint.separated_early = true;
+                    return false;
+                }
+            }
+        }
+
+        const support_shape a_support(a, a_trans), b_support(b, b_trans);
+        gjk_simplex simplex;
+        if(!gjk(a_support, b_support, 1e-5f * radii, simplex))
+            return true;
+
+        // a - b's point closest to the origin is a separating direction; dot(w, a_trans * x) = dot(transpose(a_trans) * w, x) + c,
+        // so in a's space it is transpose(a_trans) * w
+        if(polytopes)
+            hint.axis = glm::normalize(glm::transpose(mat3(a_trans)) * simplex.closest().w);
+        return false;
+    }
+
+    collision_result check_collision(const collision_shape& a, const mat4& a_trans, const collision_shape& b, const mat4& b_trans, collision_axis_hint& hint) {
+        return check_collision_impl(a, a_trans, b, b_trans, &hint);
+    }
+
+
+
+
+    static vec3 prepare_for_hashtable(vec3 v) {
+        // normalize_without_verse ensures 2 parallel vectors are considered the same (for our purposes they are)
+        // fractional_round ensures 2 almost (but not quite) identical vectors are considered the same
+        // these two functions should allow us to dramatically decrease the number of stored edges and normals
+
+        // Note: although the output will have len=~1.0, it is NOT normalized, since fractional_round does not
+        // preserve normalization. glm::normalize should be reapplied to the output if normalization is necessary,
+        // but it was not deemed to be.
+        constexpr float round_precision = 128; // this precision is deemed sufficient
+        return fractional_round(normalize_without_verse(v), round_precision);
     }
 
+    static collision_shape make_shape(const hashset<vec3>& verts, const hashset<vec3>& normals, const hashset<vec3>& edges, collision_layers_bitmask is_layers, collision_layers_bitmask sees_layers) {
+        collision_shape ret;
+        ret.is_layers = is_layers;
+        ret.sees_layers = sees_layers;
+
+        // packing quantizes the vertices and precomputes what check_collision can reuse across calls
+        const std::vector<vec3> verts_vec(verts.begin(), verts.end()), normals_vec(normals.begin(), normals.end()), edges_vec(edges.begin(), edges.end());
+        ret.polytope = packed_polytope(verts_vec, normals_vec, edges_vec);
 
+        // the bounding volumes must contain the quantized vertices, which are the ones sat tests
+        std::vector<vec3> quantized_verts;
+        quantized_verts.reserve(ret.polytope.vert_count());
+        for(std::size_t i = 0; i < ret.polytope.vert_count(); i++)
+            quantized_verts.push_back(ret.polytope.vert(i));
+        ret.local_aabb = aabb::from_points(quantized_verts, mat4(1));
+        ret.bounding_sphere_center = quantized_verts.empty() ? vec3(0) : (ret.local_aabb.min + ret.local_aabb.max) * .5f;
+        for(const vec3& v : quantized_verts)
+            ret.bounding_sphere_radius = std::max(ret.bounding_sphere_radius, glm::distance(v, ret.bounding_sphere_center));
 
+        return ret;
+    }
 
     template<AnyOneOf<uvec3, u16vec3> T>
     inline collision_shape from_mesh_impl(stride_span<const vec3> mesh_verts, std::span<const T> mesh_indices, collision_layers_bitmask is_layers, collision_layers_bitmask sees_layers) {
         using namespace glm;
 
-        auto prepare_for_hashtable = [](glm::vec3 v) {
-            // normalize_without_verse ensures 2 parallel vectors are considered the same (for our purposes they are)
-            // fractional_round ensures 2 almost (but not quite) identical vectors are considered the same
-            // these two functions should allow us to dramatically decrease the number of stored edges and normals
-
-            // Note: although the output will have len=~1.0, it is NOT normalized, since fractional_round does not
-            // preserve normalization. glm::normalize should be reapplied to the output if normalization is necessary,
-            // but it was not deemed to be.
-            constexpr float round_precision = 128; // this precision is deemed sufficient
-            return fractional_round(normalize_without_verse(v), round_precision);
-        };
-
         hashset<vec3> verts;
         hashset<vec3> normals;
         hashset<vec3> edges;
@@ -168,18 +894,51 @@ namespace engine {
             edges.insert(prepare_for_hashtable(edge_2));
             edges.insert(prepare_for_hashtable(edge_3));
         }
-        // TODO: possible optimization: precalculate min&max for each axis of the shape itself so we don't need to do it every time (but only need it for the other shape's axes
-        // TODO: add support for AABB optimization, possibly skipping edge-edge collisions
 
-        collision_shape ret;
-        //copy the hashsets into the collision_shape's vectors
-        ret.verts.insert(ret.verts.begin(), verts.begin(), verts.end());
-        ret.face_normals.insert(ret.face_normals.begin(), normals.begin(), normals.end());
-        ret.edges.insert(ret.edges.begin(), edges.begin(), edges.end());
-        ret.is_layers = is_layers;
-        ret.sees_layers = sees_layers;
+        return make_shape(verts, normals, edges, is_layers, sees_layers);
+    }
 
+    // unlike a mesh's, a hull's edges between coplanar triangles are not edges of the shape
+    static collision_shape from_convex_hull(const convex_hull& hull, collision_layers_bitmask is_layers, collision_layers_bitmask sees_layers) {
+        hashset<vec3> verts(hull.verts.begin(), hull.verts.end());
+        hashset<vec3> normals;
+        hashset<vec3> edges;
 
+        for(const vec3& normal : hull.face_normals)
+            normals.insert(prepare_for_hashtable(normal));
+        for(const uvec2& edge : hull.edges)
+            edges.insert(prepare_for_hashtable(hull.verts.at(edge.y) - hull.verts.at(edge.x)));
+
+        return make_shape(verts, normals, edges, is_layers, sees_layers);
+    }
+
+    template<AnyOneOf<uvec3, u16vec3> T>
+    inline collision_shape from_mesh_convex_hull_impl(stride_span<const vec3> mesh_verts, std::span<const T> mesh_indices, collision_layers_bitmask is_layers, collision_layers_bitmask sees_layers, const convex_hull_options& options) {
+        // only the vertices used by some triangle are part of the mesh
+        std::vector<vec3> verts;
+        verts.reserve(mesh_indices.size() * 3);
+        for(T indices : mesh_indices)
+            verts.insert(verts.end(), { mesh_verts.at(indices.x), mesh_verts.at(indices.y), mesh_verts.at(indices.z) });
+
+        if(std::optional<convex_hull> hull = quickhull(verts, options))
+            return from_convex_hull(*hull, is_layers, sees_layers);
+        return from_mesh_impl<T>(mesh_verts, mesh_indices, is_layers, sees_layers); // flat meshes have no hull
+    }
+
+    template<AnyOneOf<uvec3, u16vec3> T>
+    inline std::vector<collision_shape> from_mesh_convex_decomposition_impl(stride_span<const vec3> mesh_verts, std::span<const T> mesh_indices, collision_layers_bitmask is_layers, collision_layers_bitmask sees_layers, const convex_decomposition_options& options) {
+        std::vector<vec3> verts;
+        verts.reserve(mesh_verts.size());
+        for(std::size_t i = 0; i < mesh_verts.size(); i++)
+            verts.push_back(mesh_verts.at(i));
+        const std::vector<uvec3> triangles(mesh_indices.begin(), mesh_indices.end());
+
+        std::vector<collision_shape> ret;
+        for(const convex_hull& hull : convex_decomposition(verts, triangles, options))
+            ret.push_back(from_convex_hull(hull, is_layers, sees_layers));
+
+        if(ret.empty()) // flat meshes have no hull
+            ret.push_back(from_mesh_impl<T>(mesh_verts, mesh_indices, is_layers, sees_layers));
         return ret;
     }
 
@@ -190,6 +949,256 @@ namespace engine {
         return from_mesh_impl<glm::u16vec3>(mesh_verts, mesh_indices, is_layers, sees_layers);
     }
 
+    collision_shape collision_shape::from_mesh_convex_hull(stride_span<const glm::vec3> mesh_verts, std::span<const glm::uvec3> mesh_indices, collision_layers_bitmask is_layers, collision_layers_bitmask sees_layers, const convex_hull_options& options) {
+        return from_mesh_convex_hull_impl<glm::uvec3>(mesh_verts, mesh_indices, is_layers, sees_layers, options);
+    }
+    collision_shape collision_shape::from_mesh_convex_hull(stride_span<const glm::vec3> mesh_verts, std::span<const glm::u16vec3> mesh_indices, collision_layers_bitmask is_layers, collision_layers_bitmask sees_layers, const convex_hull_options& options) {
+        return from_mesh_convex_hull_impl<glm::u16vec3>(mesh_verts, mesh_indices, is_layers, sees_layers, options);
+    }
+
+    std::vector<collision_shape> collision_shape::from_mesh_convex_decomposition(stride_span<const glm::vec3> mesh_verts, std::span<const glm::uvec3> mesh_indices, collision_layers_bitmask is_layers, collision_layers_bitmask sees_layers, const convex_decomposition_options& options) {
+        return from_mesh_convex_decomposition_impl<glm::uvec3>(mesh_verts, mesh_indices, is_layers, sees_layers, options);
+    }
+    std::vector<collision_shape> collision_shape::from_mesh_convex_decomposition(stride_span<const glm::vec3> mesh_verts, std::span<const glm::u16vec3> mesh_indices, collision_layers_bitmask is_layers, collision_layers_bitmask sees_layers, const convex_decomposition_options& options) {
+        return from_mesh_convex_decomposition_impl<glm::u16vec3>(mesh_verts, mesh_indices, is_layers, sees_layers, options);
+    }
+
+    collision_shape collision_shape::sphere(sphere_primitive s, collision_layers_bitmask is_layers, collision_layers_bitmask sees_layers) {
+        EXPECTS(s.radius >= 0.f);
+        collision_shape ret;
+        ret.primitive = s;
+        ret.local_aabb = { .min = s.center - s.radius, .max = s.center + s.radius };
+        ret.bounding_sphere_center = s.center;
+        ret.bounding_sphere_radius = s.radius;
+        ret.is_layers = is_layers;
+        ret.sees_layers = sees_layers;
+        return ret;
+    }
+
+    collision_shape collision_shape::capsule(capsule_primitive c, collision_layers_bitmask is_layers, collision_layers_bitmask sees_layers) {
+        EXPECTS(c.radius >= 0.f && c.half_height >= 0.f);
+        collision_shape ret;
+        ret.primitive = c;
+        const vec3 half_extents = vec3(c.radius, c.half_height + c.radius, c.radius);
+        ret.local_aabb = { .min = c.center - half_extents, .max = c.center + half_extents };
+        ret.bounding_sphere_center = c.center;
+        ret.bounding_sphere_radius = c.half_height + c.radius;
+        ret.is_layers = is_layers;
+        ret.sees_layers = sees_layers;
+        return ret;
+    }
+
+    collision_shape collision_shape::box(box_primitive b, collision_layers_bitmask is_layers, collision_layers_bitmask sees_layers) {
+        EXPECTS(glm::all(glm::greaterThanEqual(b.half_extents, vec3(0))));
+        hashset<vec3> verts;
+        for(int i = 0; i < 8; i++)
+            verts.insert(b.center + b.half_extents * vec3(i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f, i & 4 ? 1.f : -1.f));
+        const hashset<vec3> axes = { vec3(1, 0, 0), vec3(0, 1, 0), vec3(0, 0, 1) };
+
+        collision_shape ret = make_shape(verts, axes, axes, is_layers, sees_layers);
+        ret.primitive = b;
+        return ret;
+    }
+
+    aabb collision_shape::world_aabb(const glm::mat4& transform) const {
+        // a sphere of radius r transformed by M has half extent r * |i-th row of M| along the i-th axis
+        const mat3 linear = mat3(transform);
+        const vec3 unit_sphere_half_extents = vec3(glm::length(glm::row(linear, 0)), glm::length(glm::row(linear, 1)), glm::length(glm::row(linear, 2)));
+
+        return std::visit(merge_callables {
+            [&](std::monostate) {
+                // the i-th world coordinate of M v + t is dot(i-th row of M, v) + t[i]
+                const vec3 translation = vec3(transform[3]);
+                const vec2 x = polytope.project(glm::row(linear, 0)), y = polytope.project(glm::row(linear, 1)), z = polytope.project(glm::row(linear, 2));
+                return aabb { .min = vec3(x.x, y.x, z.x) + translation, .max = vec3(x.y, y.y, z.y) + translation };
+            },
+            [&](const sphere_primitive& s) {
+                const vec3 center = transform * vec4(s.center, 1);
+                return aabb { .min = center - s.radius * unit_sphere_half_extents, .max = center + s.radius * unit_sphere_half_extents };
+            },
+            [&](const capsule_primitive& c) {
+                const std::array<vec3, 2> ends = {{ c.center - vec3(0, c.half_height, 0), c.center + vec3(0, c.half_height, 0) }};
+                const aabb segment = aabb::from_points(ends, transform);
+                return aabb { .min = segment.min - c.radius * unit_sphere_half_extents, .max = segment.max + c.radius * unit_sphere_half_extents };
+            },
+            [&](const box_primitive&) { return local_aabb.transform(transform); },
+        }, primitive);
+    }
+
+    std::optional<collision_distance_result> collision_distance(const collision_shape& a, const glm::mat4& a_trans, const collision_shape& b, const glm::mat4& b_trans) {
+        const float size = a.bounding_sphere_radius * max_scale(a_trans) + b.bounding_sphere_radius * max_scale(b_trans);
+        const support_shape a_support(a, a_trans), b_support(b, b_trans);
+        gjk_simplex simplex;
+        if(!gjk(a_support, b_support, 1e-5f * size, simplex))
+            return std::nullopt;
+
+        const minkowski_point closest = simplex.closest();
+        return collision_distance_result { .distance = glm::length(closest.w), .a_point = closest.a, .b_point = closest.b };
+    }
+
+    // a bound on how fast any point of the shape moves while its transform goes linearly from `from` to `to`, in units per
+    // the whole motion: a point c + u of the bounding sphere moves by D (c, 1) + D u, with D = to - from and |u| <= radius,
+    // and the frobenius norm bounds how much the linear part of D can stretch u
+    static float max_point_motion(const collision_shape& shape, const mat4& from, const mat4& to) {
+        const mat4 d = to - from;
+        const mat3 linear = mat3(d);
+        const float frobenius = std::sqrt(glm::dot(linear[0], linear[0]) + glm::dot(linear[1], linear[1]) + glm::dot(linear[2], linear[2]));
+        return glm::length(vec3(d * vec4(shape.bounding_sphere_center, 1))) + frobenius * shape.bounding_sphere_radius;
+    }
+
+    collision_result check_swept_collision(const collision_shape& a, const glm::mat4& a_from, const glm::mat4& a_to, const collision_shape& b, const glm::mat4& b_from, const glm::mat4& b_to) {
+        constexpr int max_iterations = 64;
+
+        // the distance between the shapes shrinks by at most motion * dt over dt of the motion, so advancing by
+        // distance / motion never steps past their first contact
+        const float motion = max_point_motion(a, a_from, a_to) + max_point_motion(b, b_from, b_to);
+        if(motion == 0.f)
+            return collision_result::null();
+        const float size = a.bounding_sphere_radius * std::max(max_scale(a_from), max_scale(a_to)) + b.bounding_sphere_radius * std::max(max_scale(b_from), max_scale(b_to));
+        const float contact_distance = 1e-3f * size;
+
+        auto a_at = [&](float t) { return a_from + (a_to - a_from) * t; };
+        auto b_at = [&](float t) { return b_from + (b_to - b_from) * t; };
+
+        float t = 0.f;
+        for(int i = 0; i < max_iterations; i++) {
+            const mat4 a_trans = a_at(t), b_trans = b_at(t);
+            const std::optional<collision_distance_result> distance = collision_distance(a, a_trans, b, b_trans);
+            if(!distance && t == 0.f)
+                return collision_result::null();
+
+            if(!distance || distance->distance <= contact_distance) {
+                // the contact: the closest points, or (if the last step went just past it) the shapes' centers
+                const vec3 a_point = distance ? distance->a_point : vec3(a_trans * vec4(a.bounding_sphere_center, 1));
+                const vec3 b_point = distance ? distance->b_point : vec3(b_trans * vec4(b.bounding_sphere_center, 1));
+                const vec3 normal = b_point - a_point;
+                if(normal == vec3(0))
+                    return collision_result::null();
+                const vec3 versor = glm::normalize(normal);
+
+                // where the contact points are carried by the rest of the motion; a's has to move back by what it advanced
+                // towards b's along the normal
+                const vec3 a_point_at_end = a_to * glm::inverse(a_trans) * vec4(a_point, 1);
+                const vec3 b_point_at_end = b_to * glm::inverse(b_trans) * vec4(b_point, 1);
+                const float depth = glm::dot(versor, (a_point_at_end - a_point) - (b_point_at_end - b_point)) - (distance ? distance->distance : 0.f);
+                if(!(depth > 0.f)) // they graze each other, and are moving apart along the normal
+                    return collision_result::null();
+                return { .versor = versor, .depth = depth, .time_of_impact = t };
+            }
+
+            t += distance->distance / motion;
+            if(t > 1.f)
+                return collision_result::null();
+        }
+        // still approaching after that many steps: the motion is (almost) tangent to the shapes, so they only graze
+        return collision_result::null();
+    }
+
+    // a hit of a ray in a shape's space; the normal is not normalized, and is 0 if the ray starts inside the shape
+    struct local_ray_hit {
+        float t;
+        vec3 normal;
+    };
+
+    // the first t >= 0 at which origin + t * direction is within radius of center
+    static std::optional<local_ray_hit> check_ray_sphere(vec3 origin, vec3 direction, vec3 center, float radius) {
+        const vec3 m = origin - center;
+        const float c = glm::dot(m, m) - radius * radius;
+        if(c <= 0.f)
+            return local_ray_hit { .t = 0.f, .normal = vec3(0) };
+
+        const float a = glm::dot(direction, direction);
+        const float b = glm::dot(m, direction);
+        if(b >= 0.f) // moving away from the center (or not moving at all)
+            return std::nullopt;
+        const float discriminant = b * b - a * c;
+        if(discriminant < 0.f)
+            return std::nullopt;
+
+        const float t = (-b - std::sqrt(discriminant)) / a;
+        return local_ray_hit { .t = t, .normal = m + t * direction };
+    }
+
+    // the slabs' intersection, clipped to [0, max_t]
+    static std::optional<local_ray_hit> check_ray_polytope(const collision_shape& shape, vec3 origin, vec3 direction, float max_t) {
+        float t_enter = 0.f, t_exit = max_t;
+        vec3 enter_normal = vec3(0);
+        for(std::size_t i = 0; i < shape.polytope.face_count(); i++) {
+            const vec3 n = shape.polytope.face_normal(i);
+            const vec2 extents = shape.polytope.face_normal_extents(i);
+            const float p = glm::dot(n, origin), q = glm::dot(n, direction);
+            if(q == 0.f) {
+                if(p < extents.x || p > extents.y)
+                    return std::nullopt;
+                continue;
+            }
+
+            // moving along n the ray enters through the min face, whose outward normal is -n
+            float t0 = (extents.x - p) / q, t1 = (extents.y - p) / q;
+            vec3 n0 = -n;
+            if(t0 > t1) {
+                std::swap(t0, t1);
+                n0 = n;
+            }
+            if(t0 > t_enter) {
+                t_enter = t0;
+                enter_normal = n0;
+            }
+            t_exit = std::min(t_exit, t1);
+            if(t_enter > t_exit)
+                return std::nullopt;
+        }
+        return local_ray_hit { .t = t_enter, .normal = enter_normal };
+    }
+
+    static std::optional<local_ray_hit> check_ray_capsule(const capsule_primitive& c, vec3 origin, vec3 direction) {
+        const vec3 axis_point = vec3(c.center.x, glm::clamp(origin.y, c.center.y - c.half_height, c.center.y + c.half_height), c.center.z);
+        if(glm::dot(origin - axis_point, origin - axis_point) <= c.radius * c.radius)
+            return local_ray_hit { .t = 0.f, .normal = vec3(0) };
+
+        std::optional<local_ray_hit> best;
+        auto consider = [&](std::optional<local_ray_hit> hit) {
+            if(hit && (!best || hit->t < best->t))
+                best = hit;
+        };
+        consider(check_ray_sphere(origin, direction, c.center - vec3(0, c.half_height, 0), c.radius));
+        consider(check_ray_sphere(origin, direction, c.center + vec3(0, c.half_height, 0), c.radius));
+
+        // the side: the infinite cylinder around the axis, between the ends
+        const vec2 m = vec2(origin.x - c.center.x, origin.z - c.center.z), d = vec2(direction.x, direction.z);
+        const float a = glm::dot(d, d), b = glm::dot(m, d), k = glm::dot(m, m) - c.radius * c.radius;
+        if(k > 0.f && b < 0.f) {
+            if(const float discriminant = b * b - a * k; discriminant >= 0.f) {
+                const float t = (-b - std::sqrt(discriminant)) / a;
+                if(std::abs(origin.y + t * direction.y - c.center.y) <= c.half_height)
+                    consider(local_ray_hit { .t = t, .normal = vec3(m.x + t * d.x, 0, m.y + t * d.y) });
+            }
+        }
+        return best;
+    }
+
+    std::optional<ray_hit> check_ray(const collision_shape& shape, const glm::mat4& trans, glm::vec3 origin, glm::vec3 direction, float max_distance) {
+        EXPECTS(max_distance >= 0.f && direction != vec3(0));
+
+        // in the shape's space: the transform is affine, so t is the same as in world space
+        const mat4 inverse_trans = glm::inverse(trans);
+        const vec3 local_origin = inverse_trans * vec4(origin, 1);
+        const vec3 local_direction = inverse_trans * vec4(direction, 0);
+
+        const std::optional<local_ray_hit> hit = std::visit(merge_callables {
+            [&](std::monostate) { return check_ray_polytope(shape, local_origin, local_direction, max_distance); },
+            [&](const sphere_primitive& s) { return check_ray_sphere(local_origin, local_direction, s.center, s.radius); },
+            [&](const capsule_primitive& c) { return check_ray_capsule(c, local_origin, local_direction); },
+            [&](const box_primitive&) { return check_ray_polytope(shape, local_origin, local_direction, max_distance); },
+        }, shape.primitive);
+        if(!hit || hit->t > max_distance)
+            return std::nullopt;
+
+        // normals go back to world space through the inverse transpose
+        const vec3 normal = hit->normal == vec3(0) ? -direction : glm::transpose(mat3(inverse_trans)) * hit->normal;
+        return ray_hit { .distance = hit->t, .normal = glm::normalize(normal) };
+    }
+
     collision_result collision_result::null() { return {glm::vec3(0), 0}; }
 
     bool collision_result::is_shallow() const { EXPECTS(this->operator bool()); return depth == 0.f; }
@@ -2,6 +2,7 @@
 #include <engine/scene/node/script.hpp>
 
 #include <engine/scene/node/narrow_phase_collision.hpp>
+#include <engine/resources_manager.hpp>
 #include <dylib.hpp>
 
 
@@ -21,6 +22,11 @@ namespace engine {
         (*m_script.vtable.react_to_collision)(self, this->m_state, res, event_src, other);
     }
 
+    void script::react_to_trigger(const node& self, trigger_event event, const node& event_src, const node& other) {
+        if(m_script.vtable.react_to_trigger)
+            (*m_script.vtable.react_to_trigger)(self, this->m_state, event, event_src, other);
+    }
+
     std::vector<std::pair<const char*, stateless_script> > stateless_script::from(rc<const dylib::library> dynlib) {
         const std::size_t imported_plugins_size = dynlib->get_variable<std::size_t>("exported_plugins_size");
         const std::pair<const char*, script_vtable> (&imported_plugins)[] = dynlib->get_variable<const std::pair<const char*, script_vtable>[]>("exported_plugins"); // NOLINT(cppcoreguidelines-avoid-c-arrays)
@@ -39,22 +45,18 @@ namespace engine {
         return std::move(ret);
     }
 
-    stateless_script stateless_script::from(rc<const dylib::library> dynlib, const char *name) {
-        const std::size_t imported_plugins_size = dynlib->get_variable<std::size_t>("exported_plugins_size");
-        const std::pair<const char*, script_vtable> (&imported_plugins)[] = dynlib->get_variable<const std::pair<const char*, script_vtable>[]>("exported_plugins"); // NOLINT(cppcoreguidelines-avoid-c-arrays)
+    stateless_script stateless_script::from(rc<const dylib::library> dynlib, std::string_view name) {
+        const script_index& index = get_rm().get_script_index(dynlib);
 
-        for(int i = 0; i < imported_plugins_size; i++) {
-            if(std::strcmp(imported_plugins[i].first, name) == 0) {
-
-                return stateless_script {
-                    .vtable = imported_plugins[i].second,
-                    .name = imported_plugins[i].first,
-                    .dynlib_ref = dynlib,
-                };
-            }
-        }
+        auto it = index.scripts.find(name);
+        if(it == index.scripts.end())
+            throw std::runtime_error(std::format("script with name {} not found in dynamic library", name));
 
-        throw std::runtime_error(std::format("script with name {} not found in dynamic library", name));
+        return stateless_script {
+            .vtable = it->second,
+            .name = it->first,
+            .dynlib_ref = std::move(dynlib),
+        };
     }
 
 }
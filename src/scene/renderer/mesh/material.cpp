@@ -9,10 +9,21 @@ namespace engine {
     material::material(rc<const shader> shader, std::vector<rc<const gal::texture>> textures)
         : m_shader(std::move(shader)), m_textures(std::move(textures)) {
         EXPECTS(m_shader->get_uniforms().sampler_names.size() == m_textures.size());
+        load_dither_texture_if_needed();
     }
 
     material::material(rc<const shader> shader, rc<const gal::texture> texture) : material(std::move(shader), std::vector { std::move(texture) }){}
 
+    void material::set_shader(rc<const engine::shader> s) {
+        m_shader = std::move(s);
+        load_dither_texture_if_needed();
+    }
+
+    void material::load_dither_texture_if_needed() {
+        if(m_shader->get_uniforms().dither_texture && !m_dither_texture)
+            m_dither_texture = get_rm().load<gal::texture>(internal_resource_name_t::dither_texture);
+    }
+
     void material::bind_and_set_uniforms(mvp_matrices mvp, glm::ivec2 output_resolution, float frame_time) const {
         EXPECTS(m_shader->get_uniforms().sampler_names.size() == m_textures.size());
         m_shader->get_program().bind();
@@ -51,7 +62,12 @@ namespace engine {
             }
 
             if(m_shader->get_uniforms().dither_texture) {
-                get_rm().load<gal::texture>(internal_resource_name_t::dither_texture)->bind(next_tex_slot);
+                if(m_dither_texture) {
+                    m_dither_texture->bind(next_tex_slot);
+                } else {
+                    // the shader was hot reloaded to use the dither texture after being set: fall back to loading it
+                    get_rm().load<gal::texture>(internal_resource_name_t::dither_texture)->bind(next_tex_slot);
+                }
                 m_shader->get_program().set_uniform<int>(uniform_names::dither_texture, (int)next_tex_slot);
                 next_tex_slot++;
             }
@@ -0,0 +1,83 @@
+#include <engine/scene/script_profiler.hpp>
+#include <imgui.h>
+
+namespace engine {
+    using ms = std::chrono::duration<float, std::milli>;
+
+    void script_profiler::add_sample(const std::string& script_name, call_kind kind, clock::duration d) {
+        auto it = m_current_frame.find(script_name);
+        if(it == m_current_frame.end())
+            it = m_current_frame.emplace(script_name, accumulator{}).first;
+
+        switch(kind) {
+            case call_kind::process: it->second.process.add_sample(d); break;
+            case call_kind::react_to_collision: it->second.react_to_collision.add_sample(d); break;
+        }
+    }
+
+    void script_profiler::clear() {
+        m_current_frame.clear();
+        m_stats.clear();
+    }
+
+    void script_profiler::end_frame() {
+        // m_current_frame is never shrunk (except by clear()), so it contains every script in m_stats: scripts which were
+        // not called this frame simply have an empty accumulator, and get a zero pushed into their history
+        for(auto& [name, acc] : m_current_frame) {
+            script_stats& stats = m_stats[name]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // hashmap [] does not fail
+
+            stats.process = acc.process;
+            stats.react_to_collision = acc.react_to_collision;
+            stats.history[stats.history_head] = ms(acc.process.total + acc.react_to_collision.total).count(); // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index) // history_head < history_size
+            stats.history_head = (stats.history_head + 1) % history_size;
+
+            acc = accumulator{};
+        }
+    }
+
+    void script_profiler::draw_imgui_window(bool* p_open) {
+        if(!ImGui::Begin("script profiler", p_open)) {
+            ImGui::End();
+            return;
+        }
+
+        bool enabled = m_enabled;
+        if(ImGui::Checkbox("enabled", &enabled))
+            set_enabled(enabled);
+        ImGui::SameLine();
+        if(ImGui::Button("clear"))
+            clear();
+
+        constexpr ImGuiTableFlags table_flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable;
+        if(ImGui::BeginTable("scripts", 6, table_flags)) {
+            ImGui::TableSetupColumn("script");
+            ImGui::TableSetupColumn("calls (process/collision)");
+            ImGui::TableSetupColumn("total (ms)");
+            ImGui::TableSetupColumn("max process (ms)");
+            ImGui::TableSetupColumn("max collision (ms)");
+            ImGui::TableSetupColumn("history");
+            ImGui::TableHeadersRow();
+
+            for(const auto& [name, stats] : m_stats) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(name.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%u/%u", stats.process.calls, stats.react_to_collision.calls);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", ms(stats.process.total + stats.react_to_collision.total).count());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", ms(stats.process.max).count());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", ms(stats.react_to_collision.max).count());
+                ImGui::TableNextColumn();
+                ImGui::PushID(name.c_str());
+                ImGui::PlotHistogram("##history", stats.history.data(), (int)history_size, (int)stats.history_head, nullptr, 0.f, FLT_MAX, ImVec2(-FLT_MIN, 0));
+                ImGui::PopID();
+            }
+            ImGui::EndTable();
+        }
+
+        ImGui::End();
+    }
+}
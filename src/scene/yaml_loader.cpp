@@ -140,16 +140,23 @@ namespace engine {
         ryml::ConstNodeRef root = get_child(tree.crootref(), "scene", "root");
         node* root_payload = nullptr;
 
-        node* root_raw_ptr = simple_dfs(root_payload, root, [](node* father, ryml::ConstNodeRef n) {
+        // (library path, script name) -> script; scenes usually instantiate the same few scripts on many nodes
+        hashmap<std::pair<std::string, std::string>, stateless_script> resolved_scripts;
+
+        node* root_raw_ptr = simple_dfs(root_payload, root, [&resolved_scripts](node* father, ryml::ConstNodeRef n) {
             auto name = get_optional_child_val(n, "name").value_or("");
 
             std::optional<stateless_script> script {};
             std::any script_construction_params = std::monostate();
             if(auto script_node = get_optional_child(n, "script")) {
-                auto path = get_child_val(*script_node, "path");
-                auto name = std::string(get_child_val(*script_node, "name"));
+                auto key = std::pair(std::string(get_child_val(*script_node, "path")), std::string(get_child_val(*script_node, "name")));
 
-                script = stateless_script::from(get_rm().load<dylib::library>(std::string(path)), name.c_str());
+                auto it = resolved_scripts.find(key);
+                if(it == resolved_scripts.end()) {
+                    stateless_script s = stateless_script::from(get_rm().load<dylib::library>(key.first), key.second);
+                    it = resolved_scripts.emplace(std::move(key), std::move(s)).first;
+                }
+                script = it->second;
 
                 if(auto params_node = get_optional_child(*script_node, "params")) {
                     std::vector<std::string> params = children_as_vector<std::string>(*params_node);
@@ -0,0 +1,463 @@
+#include <engine/utils/convex_hull.hpp>
+#include <engine/utils/aabb.hpp>
+#include <engine/utils/hash.hpp>
+#include <slogga/asserts.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace engine {
+    namespace {
+        struct hull_face {
+            std::array<std::uint32_t, 3> v; // counterclockwise seen from outside
+            glm::vec3 normal;
+            float offset; // the face's plane is dot(normal, p) == offset
+            std::vector<std::uint32_t> outside; // points in front of the face which are not on the hull yet
+            std::uint32_t visible_stamp = 0; // the last iteration in which the face was visible from the point being added
+            bool alive = true;
+
+            float distance(glm::vec3 p) const { return glm::dot(normal, p) - offset; }
+        };
+
+        std::uint64_t edge_key(std::uint32_t a, std::uint32_t b) { return (std::uint64_t(a) << 32) | b; }
+
+        class quickhull_builder {
+            std::span<const glm::vec3> m_points;
+            const convex_hull_options& m_options;
+            float m_eps = 0.f; // points closer than this to a face are not considered in front of it
+            float m_merge_eps = 0.f; // see convex_hull_options::coplanar_tolerance
+
+            std::vector<hull_face> m_faces;
+            hashmap<std::uint64_t, std::uint32_t> m_face_of_edge; // directed edge -> the alive face it belongs to
+            std::vector<std::uint32_t> m_vert_refs; // for each point, how many alive faces use it
+            std::uint32_t m_hull_verts = 0;
+            std::uint32_t m_alive_faces = 0;
+
+            glm::vec3 point(std::uint32_t i) const { return m_points[i]; } // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // indices come from m_points' range
+
+            std::uint32_t add_face(std::uint32_t a, std::uint32_t b, std::uint32_t c, glm::vec3 fallback_normal) {
+                const std::uint32_t idx = (std::uint32_t)m_faces.size();
+                const glm::vec3 n = glm::cross(point(b) - point(a), point(c) - point(a));
+                const glm::vec3 normal = glm::dot(n, n) > 0.f ? glm::normalize(n) : fallback_normal;
+                m_faces.push_back({ .v = { a, b, c }, .normal = normal, .offset = glm::dot(normal, point(a)), .outside = {} });
+
+                for(std::size_t i = 0; i < 3; i++) {
+                    const std::uint32_t from = m_faces.back().v[i], to = m_faces.back().v[(i + 1) % 3]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < 3
+                    m_face_of_edge[edge_key(from, to)] = idx;
+                    if(m_vert_refs[from]++ == 0) // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // from < m_points.size()
+                        m_hull_verts++;
+                }
+                m_alive_faces++;
+                return idx;
+            }
+
+            void remove_face(std::uint32_t idx) {
+                hull_face& f = m_faces[idx]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid face index
+                for(std::size_t i = 0; i < 3; i++) {
+                    const std::uint32_t from = f.v[i], to = f.v[(i + 1) % 3]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < 3
+                    m_face_of_edge.erase(edge_key(from, to));
+                    if(--m_vert_refs[from] == 0) // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // from < m_points.size()
+                        m_hull_verts--;
+                }
+                f.alive = false;
+                f.outside = {};
+                m_alive_faces--;
+            }
+
+            std::uint32_t neighbour(std::uint32_t from, std::uint32_t to) const {
+                auto it = m_face_of_edge.find(edge_key(to, from));
+                ASSERTS(it != m_face_of_edge.end()); // the hull is always closed
+                return it->second;
+            }
+
+            // gives each point to the face it is farthest in front of, if any
+            void assign_to_faces(std::span<const std::uint32_t> points, std::span<const std::uint32_t> faces) {
+                for(std::uint32_t p : points) {
+                    std::uint32_t best = UINT32_MAX;
+                    float best_distance = m_eps;
+                    for(std::uint32_t f : faces) {
+                        const float d = m_faces[f].distance(point(p)); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid face index
+                        if(d > best_distance) {
+                            best = f;
+                            best_distance = d;
+                        }
+                    }
+                    if(best != UINT32_MAX)
+                        m_faces[best].outside.push_back(p); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid face index
+                }
+            }
+
+            // builds the initial tetrahedron; returns false if the points are degenerate
+            bool build_simplex() {
+                const std::uint32_t n = (std::uint32_t)m_points.size();
+
+                // the two farthest apart among the points which are extreme on some axis
+                std::array<std::uint32_t, 6> extremes{};
+                for(std::uint32_t i = 0; i < n; i++) {
+                    for(int axis = 0; axis < 3; axis++) {
+                        if(point(i)[axis] < point(extremes[2 * axis])[axis]) // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access, cppcoreguidelines-pro-bounds-constant-array-index) // axis < 3
+                            extremes[2 * axis] = i; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access, cppcoreguidelines-pro-bounds-constant-array-index) // axis < 3
+                        if(point(i)[axis] > point(extremes[2 * axis + 1])[axis]) // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access, cppcoreguidelines-pro-bounds-constant-array-index) // axis < 3
+                            extremes[2 * axis + 1] = i; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access, cppcoreguidelines-pro-bounds-constant-array-index) // axis < 3
+                    }
+                }
+                std::uint32_t i0 = 0, i1 = 0;
+                float max_dist = -1.f;
+                for(std::uint32_t a : extremes) {
+                    for(std::uint32_t b : extremes) {
+                        const glm::vec3 d = point(a) - point(b);
+                        if(glm::dot(d, d) > max_dist) {
+                            max_dist = glm::dot(d, d);
+                            i0 = a;
+                            i1 = b;
+                        }
+                    }
+                }
+
+                // the farthest from their line
+                const glm::vec3 dir = glm::normalize(point(i1) - point(i0));
+                std::uint32_t i2 = 0;
+                max_dist = -1.f;
+                for(std::uint32_t i = 0; i < n; i++) {
+                    const float d = glm::length(glm::cross(point(i) - point(i0), dir));
+                    if(d > max_dist) {
+                        max_dist = d;
+                        i2 = i;
+                    }
+                }
+                if(max_dist <= m_eps)
+                    return false;
+
+                // and the farthest from their plane
+                const glm::vec3 plane_normal = glm::normalize(glm::cross(point(i1) - point(i0), point(i2) - point(i0)));
+                std::uint32_t i3 = 0;
+                max_dist = -1.f;
+                for(std::uint32_t i = 0; i < n; i++) {
+                    const float d = std::abs(glm::dot(plane_normal, point(i) - point(i0)));
+                    if(d > max_dist) {
+                        max_dist = d;
+                        i3 = i;
+                    }
+                }
+                if(max_dist <= m_eps)
+                    return false;
+
+                const glm::vec3 interior = (point(i0) + point(i1) + point(i2) + point(i3)) * .25f;
+                const std::array<std::array<std::uint32_t, 3>, 4> tetrahedron = {{ { i0, i1, i2 }, { i0, i1, i3 }, { i0, i2, i3 }, { i1, i2, i3 } }};
+                for(auto [a, b, c] : tetrahedron) {
+                    const glm::vec3 n = glm::cross(point(b) - point(a), point(c) - point(a));
+                    if(glm::dot(n, interior - point(a)) > 0.f)
+                        std::swap(b, c);
+                    add_face(a, b, c, glm::vec3(0));
+                }
+
+                std::vector<std::uint32_t> rest;
+                rest.reserve(n);
+                for(std::uint32_t i = 0; i < n; i++) {
+                    if(i != i0 && i != i1 && i != i2 && i != i3)
+                        rest.push_back(i);
+                }
+                const std::array<std::uint32_t, 4> faces = { 0, 1, 2, 3 };
+                assign_to_faces(rest, faces);
+                return true;
+            }
+
+            // adds the farthest point in front of face f to the hull
+            void add_point(std::uint32_t f, std::uint32_t stamp) {
+                const std::vector<std::uint32_t>& candidates = m_faces[f].outside; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid face index
+                const std::uint32_t eye = *std::ranges::max_element(candidates, {}, [&](std::uint32_t p) { return m_faces[f].distance(point(p)); }); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid face index
+
+                // the faces visible from eye, found by flooding from f, and the horizon, i.e. their edges towards the others
+                std::vector<std::uint32_t> visible, stack = { f };
+                std::vector<std::array<std::uint32_t, 3>> horizon; // from, to, face
+                m_faces[f].visible_stamp = stamp; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid face index
+                while(!stack.empty()) {
+                    const std::uint32_t g = stack.back();
+                    stack.pop_back();
+                    visible.push_back(g);
+
+                    for(std::size_t i = 0; i < 3; i++) {
+                        const std::uint32_t from = m_faces[g].v[i], to = m_faces[g].v[(i + 1) % 3]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid face index, i < 3
+                        const std::uint32_t nb = neighbour(from, to);
+                        hull_face& nb_face = m_faces[nb]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid face index
+                        if(nb_face.visible_stamp == stamp)
+                            continue;
+
+                        // with a tolerance as large as m_eps here the new faces could fold over the ones left in place;
+                        // without any, they could be degenerate if eye is (almost) on the plane of a neighbour
+                        if(nb_face.distance(point(eye)) > m_eps * .1f) {
+                            nb_face.visible_stamp = stamp;
+                            stack.push_back(nb);
+                        } else {
+                            horizon.push_back({ from, to, g });
+                        }
+                    }
+                }
+
+                std::vector<std::uint32_t> orphans;
+                for(std::uint32_t g : visible) {
+                    for(std::uint32_t p : m_faces[g].outside) { // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid face index
+                        if(p != eye)
+                            orphans.push_back(p);
+                    }
+                }
+                for(std::uint32_t g : visible)
+                    remove_face(g);
+
+                std::vector<std::uint32_t> new_faces;
+                new_faces.reserve(horizon.size());
+                for(const auto& [from, to, g] : horizon)
+                    new_faces.push_back(add_face(from, to, eye, m_faces[g].normal)); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid face index
+
+                assign_to_faces(orphans, new_faces);
+            }
+
+            convex_hull extract() const {
+                convex_hull ret;
+                std::vector<std::uint32_t> new_index(m_points.size(), UINT32_MAX);
+                std::vector<std::uint32_t> triangle_of_face(m_faces.size(), UINT32_MAX);
+                std::vector<std::uint32_t> alive;
+                for(std::uint32_t f = 0; f < m_faces.size(); f++) {
+                    const hull_face& face = m_faces[f]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // f < m_faces.size()
+                    if(!face.alive)
+                        continue;
+
+                    glm::uvec3 triangle;
+                    for(int i = 0; i < 3; i++) {
+                        std::uint32_t& idx = new_index[face.v[i]]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access, cppcoreguidelines-pro-bounds-constant-array-index) // i < 3, valid point index
+                        if(idx == UINT32_MAX) {
+                            idx = (std::uint32_t)ret.verts.size();
+                            ret.verts.push_back(point(face.v[i])); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access, cppcoreguidelines-pro-bounds-constant-array-index) // i < 3
+                        }
+                        triangle[i] = idx; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < 3
+                    }
+                    triangle_of_face[f] = (std::uint32_t)ret.triangles.size(); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // f < m_faces.size()
+                    ret.triangles.push_back(triangle);
+                    alive.push_back(f);
+                }
+
+                // merge adjacent triangles which are coplanar with the first triangle of their face, so that faces cannot
+                // drift away from planarity one small angle at a time
+                const float min_cos = 1.f - m_options.coplanar_tolerance;
+                ret.face_of_triangle.assign(ret.triangles.size(), UINT32_MAX);
+                std::vector<std::uint32_t> stack;
+                for(std::uint32_t t = 0; t < alive.size(); t++) {
+                    if(ret.face_of_triangle[t] != UINT32_MAX) // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // t < alive.size() == triangles.size()
+                        continue;
+
+                    const std::uint32_t face_idx = (std::uint32_t)ret.face_normals.size();
+                    const hull_face& seed = m_faces[alive[t]]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // t < alive.size()
+                    ret.face_normals.push_back(seed.normal);
+                    ret.face_of_triangle[t] = face_idx; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // t < triangles.size()
+
+                    stack = { alive[t] }; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // t < alive.size()
+                    while(!stack.empty()) {
+                        const hull_face& face = m_faces[stack.back()]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid face index
+                        stack.pop_back();
+                        for(std::size_t i = 0; i < 3; i++) {
+                            const std::uint32_t nb = neighbour(face.v[i], face.v[(i + 1) % 3]); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < 3
+                            std::uint32_t& nb_face_idx = ret.face_of_triangle[triangle_of_face[nb]]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // alive faces have a triangle
+                            const hull_face& nb_face = m_faces[nb]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid face index
+                            if(nb_face_idx != UINT32_MAX || glm::dot(nb_face.normal, seed.normal) < min_cos)
+                                continue;
+                            if(!std::ranges::all_of(nb_face.v, [&](std::uint32_t v) { return std::abs(seed.distance(point(v))) <= m_merge_eps; }))
+                                continue;
+
+                            nb_face_idx = face_idx;
+                            stack.push_back(nb);
+                        }
+                    }
+                }
+
+                // edges between different faces; each undirected edge is seen from both its triangles, so keep it once
+                for(std::uint32_t t = 0; t < alive.size(); t++) {
+                    const hull_face& face = m_faces[alive[t]]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // t < alive.size()
+                    for(std::size_t i = 0; i < 3; i++) {
+                        const std::uint32_t from = face.v[i], to = face.v[(i + 1) % 3]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < 3
+                        if(from > to)
+                            continue;
+                        const std::uint32_t nb_t = triangle_of_face[neighbour(from, to)]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid face index
+                        if(ret.face_of_triangle[t] != ret.face_of_triangle[nb_t]) // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid triangle indices
+                            ret.edges.emplace_back(new_index[from], new_index[to]); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid point indices
+                    }
+                }
+
+                return ret;
+            }
+        public:
+            quickhull_builder(std::span<const glm::vec3> points, const convex_hull_options& options) : m_points(points), m_options(options) {}
+
+            std::optional<convex_hull> build() {
+                if(m_points.size() < 4)
+                    return std::nullopt;
+
+                const aabb box = aabb::from_points(m_points, glm::mat4(1));
+                const float extent = glm::length(box.max - box.min);
+                if(!(extent > 0.f && std::isfinite(extent)))
+                    return std::nullopt;
+                // well above float rounding, which is about 1e-7 relative; faces are kept planar by merging them afterwards
+                m_eps = 1e-5f * extent;
+                m_merge_eps = m_options.coplanar_tolerance * extent;
+
+                m_vert_refs.assign(m_points.size(), 0);
+                if(!build_simplex())
+                    return std::nullopt;
+
+                for(std::uint32_t stamp = 1; ; stamp++) {
+                    if(m_options.max_verts != 0 && m_hull_verts >= m_options.max_verts)
+                        break;
+                    if(m_options.max_faces != 0 && m_alive_faces >= m_options.max_faces)
+                        break;
+
+                    auto it = std::ranges::find_if(m_faces, [](const hull_face& f) { return f.alive && !f.outside.empty(); });
+                    if(it == m_faces.end())
+                        break;
+                    add_point((std::uint32_t)(it - m_faces.begin()), stamp);
+                }
+
+                return extract();
+            }
+        };
+    }
+
+    std::optional<convex_hull> quickhull(std::span<const glm::vec3> points, const convex_hull_options& options) {
+        EXPECTS(options.coplanar_tolerance >= 0.f);
+        return quickhull_builder(points, options).build();
+    }
+
+
+
+    namespace {
+        struct mesh_part {
+            std::vector<glm::vec3> verts;
+            std::vector<glm::uvec3> triangles;
+
+            convex_hull hull;
+            float concavity; // the largest distance from the surface to the hull
+            glm::vec3 deepest; // where the surface is that far from the hull
+            bool splittable = true;
+        };
+
+        std::optional<mesh_part> make_part(std::vector<glm::vec3> verts, std::vector<glm::uvec3> triangles, const convex_hull_options& options) {
+            std::optional<convex_hull> hull = quickhull(verts, options);
+            if(!hull)
+                return std::nullopt;
+
+            // the planes of the hull's faces
+            std::vector<glm::vec4> planes(hull->face_normals.size(), glm::vec4(0));
+            for(std::size_t t = 0; t < hull->triangles.size(); t++) {
+                const std::uint32_t f = hull->face_of_triangle[t]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // t < triangles.size()
+                const glm::vec3 n = hull->face_normals[f]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid face index
+                planes[f] = glm::vec4(n, glm::dot(n, hull->verts[hull->triangles[t].x])); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid indices
+            }
+
+            // the distance from the surface to the hull, along the surface's normal: 0 for a convex part; a vertex's
+            // depth inside the hull would not do, as every vertex of a thin part lies on one of its large faces
+            mesh_part ret { .verts = std::move(verts), .triangles = std::move(triangles), .hull = std::move(*hull), .concavity = 0.f, .deepest = glm::vec3(0) };
+            for(const glm::uvec3& t : ret.triangles) {
+                const std::array<glm::vec3, 3> tri = { ret.verts[t.x], ret.verts[t.y], ret.verts[t.z] }; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid indices
+                const glm::vec3 n = glm::cross(tri[1] - tri[0], tri[2] - tri[0]);
+                if(glm::dot(n, n) == 0.f)
+                    continue;
+                const glm::vec3 dir = glm::normalize(n);
+
+                for(const glm::vec3& p : { tri[0], tri[1], tri[2], (tri[0] + tri[1] + tri[2]) / 3.f }) {
+                    float distance = std::numeric_limits<float>::max();
+                    for(const glm::vec4& plane : planes) {
+                        const float cos = glm::dot(glm::vec3(plane), dir);
+                        if(cos > 0.f)
+                            distance = std::min(distance, (plane.w - glm::dot(glm::vec3(plane), p)) / cos);
+                    }
+                    if(distance != std::numeric_limits<float>::max() && distance > ret.concavity) {
+                        ret.concavity = distance;
+                        ret.deepest = p;
+                    }
+                }
+            }
+            return ret;
+        }
+
+        // clips the triangle to the side of the plane {p[axis] == c} given by sign, and appends the result to part
+        void clip_triangle(std::array<glm::vec3, 3> tri, int axis, float c, float sign, std::vector<glm::vec3>& verts, std::vector<glm::uvec3>& triangles) {
+            std::array<glm::vec3, 4> poly{}; // a triangle clipped by a plane has at most 4 vertices
+            std::size_t size = 0;
+            bool strictly_inside = false;
+            for(std::size_t i = 0; i < 3; i++) {
+                const glm::vec3 p = tri[i], q = tri[(i + 1) % 3]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < 3
+                const float dp = sign * (p[axis] - c), dq = sign * (q[axis] - c); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // axis < 3
+                if(dp >= 0.f)
+                    poly[size++] = p; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // at most 4 vertices
+                strictly_inside |= dp > 0.f;
+                if((dp < 0.f) != (dq < 0.f))
+                    poly[size++] = p + (q - p) * (dp / (dp - dq)); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // at most 4 vertices
+            }
+            // a sliver lying on the plane would drag the far end of its triangle into this side's hull
+            if(size < 3 || !strictly_inside)
+                return;
+
+            const std::uint32_t base = (std::uint32_t)verts.size();
+            verts.insert(verts.end(), poly.begin(), poly.begin() + (std::ptrdiff_t)size);
+            for(std::uint32_t i = 1; i + 1 < size; i++)
+                triangles.emplace_back(base, base + i, base + i + 1);
+        }
+    }
+
+    std::vector<convex_hull> convex_decomposition(std::span<const glm::vec3> verts, std::span<const glm::uvec3> triangles, const convex_decomposition_options& options) {
+        EXPECTS(options.max_hulls > 0 && options.max_concavity >= 0.f);
+
+        std::vector<glm::vec3> used_verts;
+        for(const glm::uvec3& t : triangles) {
+            for(int i = 0; i < 3; i++)
+                used_verts.push_back(verts[t[i]]); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < 3 and indices must be valid
+        }
+        const aabb mesh_box = aabb::from_points(used_verts, glm::mat4(1));
+        const float max_concavity = options.max_concavity * glm::length(mesh_box.max - mesh_box.min);
+
+        std::vector<mesh_part> parts;
+        if(std::optional<mesh_part> whole = make_part(std::vector<glm::vec3>(verts.begin(), verts.end()), std::vector<glm::uvec3>(triangles.begin(), triangles.end()), options.hull))
+            parts.push_back(std::move(*whole));
+        else
+            return {};
+
+        while(parts.size() < options.max_hulls) {
+            auto most_concave = std::ranges::max_element(parts, {}, [](const mesh_part& p) { return p.splittable ? p.concavity : -1.f; });
+            if(!most_concave->splittable || most_concave->concavity <= max_concavity)
+                break;
+            mesh_part& part = *most_concave;
+
+            // split along the part's longest axis, through its deepest vertex unless that is too close to the part's sides
+            const aabb box = aabb::from_points(part.verts, glm::mat4(1));
+            const glm::vec3 size = box.max - box.min;
+            const int axis = size.x >= size.y && size.x >= size.z ? 0 : size.y >= size.z ? 1 : 2;
+            float c = part.deepest[axis]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // axis < 3
+            const float lo = box.min[axis], hi = box.max[axis]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // axis < 3
+            if(c < lo + .1f * (hi - lo) || c > hi - .1f * (hi - lo))
+                c = (lo + hi) * .5f;
+
+            std::array<std::vector<glm::vec3>, 2> side_verts;
+            std::array<std::vector<glm::uvec3>, 2> side_triangles;
+            for(const glm::uvec3& t : part.triangles) {
+                const std::array<glm::vec3, 3> tri = { part.verts[t.x], part.verts[t.y], part.verts[t.z] }; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid indices
+                clip_triangle(tri, axis, c, -1.f, side_verts[0], side_triangles[0]);
+                clip_triangle(tri, axis, c, 1.f, side_verts[1], side_triangles[1]);
+            }
+
+            std::optional<mesh_part> below = make_part(std::move(side_verts[0]), std::move(side_triangles[0]), options.hull);
+            std::optional<mesh_part> above = make_part(std::move(side_verts[1]), std::move(side_triangles[1]), options.hull);
+            if(!below || !above) {
+                // one side would be flat: this part is as good as it gets
+                part.splittable = false;
+                continue;
+            }
+            part = std::move(*below);
+            parts.push_back(std::move(*above));
+        }
+
+        std::vector<convex_hull> ret;
+        ret.reserve(parts.size());
+        for(mesh_part& p : parts)
+            ret.push_back(std::move(p.hull));
+        return ret;
+    }
+}
@@ -1,4 +1,5 @@
 #include <engine/utils/lin_algebra.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 namespace engine {
     using namespace glm;
@@ -9,4 +10,43 @@ namespace engine {
         //NOLINTEND(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access)
         return mat;
     }
+
+    struct decomposed_transform {
+        vec3 translation;
+        quat rotation;
+        vec3 scale;
+    };
+
+    static decomposed_transform decompose(const mat4& m) {
+        //NOLINTBEGIN(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access)
+        mat3 basis = mat3(m);
+        vec3 scale = { length(basis[0]), length(basis[1]), length(basis[2]) };
+        // a negative determinant means the transform contains a reflection, which cannot be represented by a rotation
+        if(determinant(basis) < 0)
+            scale.x = -scale.x;
+
+        for(int i = 0; i < 3; i++)
+            if(scale[i] != 0.f)
+                basis[i] /= scale[i];
+
+        return { .translation = vec3(m[3]), .rotation = quat_cast(basis), .scale = scale };
+        //NOLINTEND(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access)
+    }
+
+    mat4 interpolate_transforms(const mat4& a, const mat4& b, float t) {
+        decomposed_transform da = decompose(a), db = decompose(b);
+
+        vec3 translation = mix(da.translation, db.translation, t);
+        quat rotation = slerp(da.rotation, db.rotation, t);
+        vec3 scale = mix(da.scale, db.scale, t);
+
+        mat4 ret = mat4_cast(rotation);
+        //NOLINTBEGIN(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access)
+        ret[0] *= scale.x;
+        ret[1] *= scale.y;
+        ret[2] *= scale.z;
+        ret[3] = vec4(translation, 1);
+        //NOLINTEND(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access)
+        return ret;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include <engine/utils/mapped_file.hpp>
+#include <utility>
+
+#ifdef _WIN32
+#    define WIN32_LEAN_AND_MEAN
+#    define NOMINMAX
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace engine {
+    mapped_file::mapped_file(mapped_file&& o) noexcept { *this = std::move(o); }
+
+    mapped_file& mapped_file::operator=(mapped_file&& o) noexcept {
+        if(this != &o) {
+            unmap();
+            m_data = std::exchange(o.m_data, nullptr);
+            m_size = std::exchange(o.m_size, 0);
+#ifdef _WIN32
+            m_file = std::exchange(o.m_file, nullptr);
+            m_mapping = std::exchange(o.m_mapping, nullptr);
+#endif
+        }
+        return *this;
+    }
+
+    mapped_file::~mapped_file() { unmap(); }
+
+#ifdef _WIN32
+    void mapped_file::unmap() {
+        if(m_data != nullptr)
+            UnmapViewOfFile(m_data);
+        if(m_mapping != nullptr)
+            CloseHandle(m_mapping);
+        if(m_file != nullptr)
+            CloseHandle(m_file);
+        m_data = nullptr;
+        m_mapping = m_file = nullptr;
+        m_size = 0;
+    }
+
+    std::optional<mapped_file> mapped_file::open(const std::string& path) {
+        mapped_file ret;
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(file == INVALID_HANDLE_VALUE)
+            return std::nullopt;
+        ret.m_file = file;
+
+        LARGE_INTEGER size;
+        if(!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+            return std::nullopt;
+        ret.m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(ret.m_mapping == nullptr)
+            return std::nullopt;
+        ret.m_data = static_cast<const std::byte*>(MapViewOfFile(ret.m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if(ret.m_data == nullptr)
+            return std::nullopt;
+        ret.m_size = std::size_t(size.QuadPart);
+        return ret;
+    }
+#else
+    void mapped_file::unmap() {
+        if(m_data != nullptr)
+            munmap(const_cast<std::byte*>(m_data), m_size); // NOLINT(cppcoreguidelines-pro-type-const-cast) // munmap takes a non-const pointer
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    std::optional<mapped_file> mapped_file::open(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY); // NOLINT(cppcoreguidelines-pro-type-vararg)
+        if(fd == -1)
+            return std::nullopt;
+
+        // the mapping stays valid after the file is closed
+        struct stat st {};
+        void* data = MAP_FAILED;
+        if(fstat(fd, &st) == 0 && st.st_size > 0)
+            data = mmap(nullptr, std::size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if(data == MAP_FAILED)
+            return std::nullopt;
+
+        mapped_file ret;
+        ret.m_data = static_cast<const std::byte*>(data);
+        ret.m_size = std::size_t(st.st_size);
+        return ret;
+    }
+#endif
+}
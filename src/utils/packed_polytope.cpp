@@ -0,0 +1,152 @@
+#include <engine/utils/packed_polytope.hpp>
+#include <slogga/asserts.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace engine {
+    using glm::vec2;
+    using glm::vec3;
+
+    static constexpr float quantized_max = 32767.f;
+
+    // octahedral encoding: the unit sphere is mapped to the octahedron |x| + |y| + |z| = 1, whose lower half is folded
+    // over the upper one, and that is flattened on the xy plane; the result is in [-1, 1]^2, stored as snorm16
+    static void encode_direction(vec3 d, std::int16_t* out) {
+        const float l1 = std::abs(d.x) + std::abs(d.y) + std::abs(d.z);
+        vec2 p = l1 > 0.f ? vec2(d.x, d.y) / l1 : vec2(0);
+        if(l1 > 0.f && d.z < 0.f)
+            p = (vec2(1) - glm::abs(vec2(p.y, p.x))) * vec2(p.x >= 0.f ? 1.f : -1.f, p.y >= 0.f ? 1.f : -1.f);
+        out[0] = std::int16_t(std::lround(glm::clamp(p.x, -1.f, 1.f) * quantized_max)); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // out points to 2 int16s
+        out[1] = std::int16_t(std::lround(glm::clamp(p.y, -1.f, 1.f) * quantized_max)); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // out points to 2 int16s
+    }
+
+    static vec3 decode_direction(const std::int16_t* in) {
+        const vec2 p = vec2(float(in[0]), float(in[1])) / quantized_max; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // in points to 2 int16s
+        vec3 d = vec3(p, 1.f - std::abs(p.x) - std::abs(p.y));
+        // unfold the lower half
+        const float t = std::max(-d.z, 0.f);
+        d.x += d.x >= 0.f ? -t : t;
+        d.y += d.y >= 0.f ? -t : t;
+        return glm::normalize(d);
+    }
+
+    // the smallest power of two no smaller than half_extent / quantized_max, so that half_extent / step <= quantized_max
+    static float quantization_step(float half_extent) {
+        if(!(half_extent > 0.f))
+            return 0.f;
+        int exponent = 0;
+        const float mantissa = std::frexp(half_extent / quantized_max, &exponent); // in [.5, 1)
+        return std::ldexp(1.f, mantissa == .5f ? exponent - 1 : exponent);
+    }
+
+    packed_polytope::packed_polytope(std::span<const vec3> verts, std::span<const vec3> face_normals, std::span<const vec3> edges) :
+        m_vert_count(std::uint32_t(verts.size())), m_face_count(std::uint32_t(face_normals.size())), m_edge_count(std::uint32_t(edges.size())) {
+        EXPECTS(verts.size() <= std::numeric_limits<std::uint32_t>::max() && face_normals.size() <= std::numeric_limits<std::uint32_t>::max() && edges.size() <= std::numeric_limits<std::uint32_t>::max());
+        const std::size_t padded = padded_vert_count();
+        m_data.resize(data_size(padded, m_face_count, m_edge_count));
+
+        if(!verts.empty()) {
+            vec3 min = verts.front(), max = verts.front();
+            for(const vec3& v : verts) {
+                min = glm::min(min, v);
+                max = glm::max(max, v);
+            }
+            m_center = (min + max) * .5f;
+            const vec3 half_extents = glm::max(max - m_center, m_center - min);
+            m_step = vec3(quantization_step(half_extents.x), quantization_step(half_extents.y), quantization_step(half_extents.z));
+        }
+
+        std::int16_t* data = m_data.data();
+        for(std::size_t i = 0; i < padded; i++) {
+            const vec3 offset = verts[std::min(i, verts.size() - 1)] - m_center; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < padded implies !verts.empty()
+            for(glm::length_t c = 0; c < 3; c++) {
+                const float q = m_step[c] > 0.f ? glm::clamp(std::round(offset[c] / m_step[c]), -quantized_max, quantized_max) : 0.f;
+                data[c * padded + i] = std::int16_t(q); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // within the vertices' arrays
+            }
+        }
+
+        std::int16_t* out = data + 3 * padded; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // the normals' array
+        for(const vec3& n : face_normals) {
+            encode_direction(n, out);
+            out += 2; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // within the normals' array
+        }
+        for(const vec3& e : edges) {
+            encode_direction(e, out);
+            out += 2; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // within the edges' array
+        }
+        // the extents of the quantized vertices on the decoded normals: what sat would get by projecting them
+        for(std::size_t i = 0; i < m_face_count; i++) {
+            const vec2 extents = project(face_normal(i));
+            std::memcpy(out, &extents, sizeof(extents));
+            out += 4; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // within the extents' array
+        }
+    }
+
+    std::optional<packed_polytope> packed_polytope::from_data(const layout& l, std::span<const std::int16_t> data) {
+        packed_polytope ret;
+        ret.m_vert_count = l.vert_count;
+        ret.m_face_count = l.face_count;
+        ret.m_edge_count = l.edge_count;
+        ret.m_center = l.center;
+        ret.m_step = l.step;
+        if(data.size() != data_size(ret.padded_vert_count(), l.face_count, l.edge_count))
+            return std::nullopt;
+        ret.m_data.assign(data.begin(), data.end());
+        return ret;
+    }
+
+    vec3 packed_polytope::vert(std::size_t i) const {
+        EXPECTS(i < m_vert_count);
+        return m_center + m_step * vec3(xs()[i], ys()[i], zs()[i]); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // i < m_vert_count
+    }
+
+    vec3 packed_polytope::face_normal(std::size_t i) const {
+        EXPECTS(i < m_face_count);
+        return decode_direction(normals() + 2 * i); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // i < m_face_count
+    }
+
+    vec2 packed_polytope::face_normal_extents(std::size_t i) const {
+        EXPECTS(i < m_face_count);
+        vec2 ret;
+        std::memcpy(&ret, extents() + 4 * i, sizeof(ret)); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // i < m_face_count
+        return ret;
+    }
+
+    vec3 packed_polytope::edge(std::size_t i) const {
+        EXPECTS(i < m_edge_count);
+        return decode_direction(edges() + 2 * i); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // i < m_edge_count
+    }
+
+    vec2 packed_polytope::project(vec3 axis) const {
+        EXPECTS(!empty());
+        // dot(center + step * q, axis) = dot(q, step * axis) + dot(center, axis)
+        return project_int16_points(xs(), ys(), zs(), padded_vert_count(), m_step * axis) + glm::dot(m_center, axis);
+    }
+
+    vec3 packed_polytope::support(vec3 d) const {
+        EXPECTS(!empty());
+        const vec3 scaled = m_step * d;
+        std::size_t best = 0;
+        float best_dot = std::numeric_limits<float>::lowest();
+        for(std::size_t i = 0; i < m_vert_count; i++) {
+            const float dot = float(xs()[i]) * scaled.x + float(ys()[i]) * scaled.y + float(zs()[i]) * scaled.z; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // i < m_vert_count
+            if(dot > best_dot) {
+                best_dot = dot;
+                best = i;
+            }
+        }
+        return vert(best);
+    }
+
+    void packed_polytope::transform_verts(const glm::mat4& transform, soa_points& out) const {
+        glm::mat4 dequantize = glm::mat4(1);
+        dequantize[0][0] = m_step.x;
+        dequantize[1][1] = m_step.y;
+        dequantize[2][2] = m_step.z;
+        dequantize[3] = glm::vec4(m_center, 1);
+        out.assign(xs(), ys(), zs(), m_vert_count, transform * dequantize);
+    }
+}
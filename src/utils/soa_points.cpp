@@ -0,0 +1,224 @@
+#include <engine/utils/soa_points.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#    define ENGINE_SOA_POINTS_X86_64
+#    include <immintrin.h>
+#    if defined(_MSC_VER) && !defined(__clang__)
+#        include <intrin.h>
+#        define ENGINE_TARGET_AVX2 // msvc lets any function use any instruction set
+#    else
+#        define ENGINE_TARGET_AVX2 [[gnu::target("avx2")]]
+#    endif
+#endif
+
+namespace engine {
+    static simd_level best_supported_simd_level() {
+#ifdef ENGINE_SOA_POINTS_X86_64
+#    if defined(_MSC_VER) && !defined(__clang__)
+        std::array<int, 4> regs{};
+        __cpuid(regs.data(), 1);
+        const bool os_saves_ymm = (regs[2] & (1 << 27)) && (regs[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6; // osxsave, avx and the os saving xmm/ymm
+        __cpuidex(regs.data(), 7, 0);
+        if(os_saves_ymm && (regs[1] & (1 << 5))) // avx2
+            return simd_level::avx2;
+#    else
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2"))
+            return simd_level::avx2;
+#    endif
+        return simd_level::sse; // sse2 is part of x86-64
+#else
+        return simd_level::scalar;
+#endif
+    }
+
+    static std::atomic<simd_level>& current_simd_level() {
+        static std::atomic<simd_level> level = best_supported_simd_level();
+        return level;
+    }
+
+    simd_level get_simd_level() { return current_simd_level().load(std::memory_order_relaxed); }
+
+    bool set_simd_level(simd_level level) {
+        if(level > best_supported_simd_level())
+            return false;
+        current_simd_level().store(level, std::memory_order_relaxed);
+        return true;
+    }
+
+    void soa_points::assign(std::span<const glm::vec3> points, const glm::mat4& transform) {
+        m_size = points.size();
+        const std::size_t padded_size = (m_size + padding - 1) / padding * padding;
+        m_x.resize(padded_size);
+        m_y.resize(padded_size);
+        m_z.resize(padded_size);
+
+        for(std::size_t i = 0; i < padded_size; i++) {
+            const glm::vec3 p = transform * glm::vec4(points[std::min(i, m_size - 1)], 1); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < padded_size implies m_size > 0
+            m_x[i] = p.x; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < padded_size
+            m_y[i] = p.y; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < padded_size
+            m_z[i] = p.z; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < padded_size
+        }
+    }
+
+    void soa_points::assign(const std::int16_t* x, const std::int16_t* y, const std::int16_t* z, std::size_t size, const glm::mat4& transform) {
+        m_size = size;
+        const std::size_t padded_size = (m_size + padding - 1) / padding * padding;
+        m_x.resize(padded_size);
+        m_y.resize(padded_size);
+        m_z.resize(padded_size);
+
+        for(std::size_t i = 0; i < padded_size; i++) {
+            const std::size_t j = std::min(i, m_size - 1);
+            const glm::vec3 p = transform * glm::vec4(x[j], y[j], z[j], 1); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // j < size
+            m_x[i] = p.x; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < padded_size
+            m_y[i] = p.y; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < padded_size
+            m_z[i] = p.z; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < padded_size
+        }
+    }
+
+    // the kernels take arrays whose size is a multiple of soa_points::padding
+    static glm::vec2 project_scalar(const float* x, const float* y, const float* z, std::size_t n, glm::vec3 axis) {
+        glm::vec2 ret(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+        for(std::size_t i = 0; i < n; i++) {
+            const float d = x[i] * axis.x + y[i] * axis.y + z[i] * axis.z; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // i < n
+            ret.x = std::min(ret.x, d);
+            ret.y = std::max(ret.y, d);
+        }
+        return ret;
+    }
+
+#ifdef ENGINE_SOA_POINTS_X86_64
+    static glm::vec2 project_sse(const float* x, const float* y, const float* z, std::size_t n, glm::vec3 axis) {
+        const __m128 ax = _mm_set1_ps(axis.x), ay = _mm_set1_ps(axis.y), az = _mm_set1_ps(axis.z);
+        __m128 lo = _mm_set1_ps(std::numeric_limits<float>::max());
+        __m128 hi = _mm_set1_ps(std::numeric_limits<float>::lowest());
+        for(std::size_t i = 0; i < n; i += 4) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) // i + 4 <= n
+            const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(x + i), ax), _mm_mul_ps(_mm_loadu_ps(y + i), ay)), _mm_mul_ps(_mm_loadu_ps(z + i), az));
+            lo = _mm_min_ps(lo, d);
+            hi = _mm_max_ps(hi, d);
+        }
+
+        // horizontal reduction
+        lo = _mm_min_ps(lo, _mm_movehl_ps(lo, lo));
+        hi = _mm_max_ps(hi, _mm_movehl_ps(hi, hi));
+        lo = _mm_min_ss(lo, _mm_shuffle_ps(lo, lo, 1));
+        hi = _mm_max_ss(hi, _mm_shuffle_ps(hi, hi, 1));
+        return { _mm_cvtss_f32(lo), _mm_cvtss_f32(hi) };
+    }
+
+    ENGINE_TARGET_AVX2 static glm::vec2 project_avx2(const float* x, const float* y, const float* z, std::size_t n, glm::vec3 axis) {
+        const __m256 ax = _mm256_set1_ps(axis.x), ay = _mm256_set1_ps(axis.y), az = _mm256_set1_ps(axis.z);
+        __m256 lo = _mm256_set1_ps(std::numeric_limits<float>::max());
+        __m256 hi = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+        for(std::size_t i = 0; i < n; i += 8) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) // i + 8 <= n
+            const __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(x + i), ax), _mm256_mul_ps(_mm256_loadu_ps(y + i), ay)), _mm256_mul_ps(_mm256_loadu_ps(z + i), az));
+            lo = _mm256_min_ps(lo, d);
+            hi = _mm256_max_ps(hi, d);
+        }
+
+        // horizontal reduction
+        __m128 lo4 = _mm_min_ps(_mm256_castps256_ps128(lo), _mm256_extractf128_ps(lo, 1));
+        __m128 hi4 = _mm_max_ps(_mm256_castps256_ps128(hi), _mm256_extractf128_ps(hi, 1));
+        lo4 = _mm_min_ps(lo4, _mm_movehl_ps(lo4, lo4));
+        hi4 = _mm_max_ps(hi4, _mm_movehl_ps(hi4, hi4));
+        lo4 = _mm_min_ss(lo4, _mm_shuffle_ps(lo4, lo4, 1));
+        hi4 = _mm_max_ss(hi4, _mm_shuffle_ps(hi4, hi4, 1));
+        return { _mm_cvtss_f32(lo4), _mm_cvtss_f32(hi4) };
+    }
+#endif
+
+    // the same kernels, for 16 bit coordinates
+    static glm::vec2 project_int16_scalar(const std::int16_t* x, const std::int16_t* y, const std::int16_t* z, std::size_t n, glm::vec3 axis) {
+        glm::vec2 ret(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+        for(std::size_t i = 0; i < n; i++) {
+            const float d = float(x[i]) * axis.x + float(y[i]) * axis.y + float(z[i]) * axis.z; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic) // i < n
+            ret.x = std::min(ret.x, d);
+            ret.y = std::max(ret.y, d);
+        }
+        return ret;
+    }
+
+#ifdef ENGINE_SOA_POINTS_X86_64
+    // 4 16 bit integers, sign extended and converted to floats; sse2 has no cvtepi16_epi32
+    static __m128 load_int16x4_sse(const std::int16_t* p) {
+        const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast) // unaligned load of 4 int16s
+        return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+    }
+
+    static glm::vec2 project_int16_sse(const std::int16_t* x, const std::int16_t* y, const std::int16_t* z, std::size_t n, glm::vec3 axis) {
+        const __m128 ax = _mm_set1_ps(axis.x), ay = _mm_set1_ps(axis.y), az = _mm_set1_ps(axis.z);
+        __m128 lo = _mm_set1_ps(std::numeric_limits<float>::max());
+        __m128 hi = _mm_set1_ps(std::numeric_limits<float>::lowest());
+        for(std::size_t i = 0; i < n; i += 4) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) // i + 4 <= n
+            const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(load_int16x4_sse(x + i), ax), _mm_mul_ps(load_int16x4_sse(y + i), ay)), _mm_mul_ps(load_int16x4_sse(z + i), az));
+            lo = _mm_min_ps(lo, d);
+            hi = _mm_max_ps(hi, d);
+        }
+
+        lo = _mm_min_ps(lo, _mm_movehl_ps(lo, lo));
+        hi = _mm_max_ps(hi, _mm_movehl_ps(hi, hi));
+        lo = _mm_min_ss(lo, _mm_shuffle_ps(lo, lo, 1));
+        hi = _mm_max_ss(hi, _mm_shuffle_ps(hi, hi, 1));
+        return { _mm_cvtss_f32(lo), _mm_cvtss_f32(hi) };
+    }
+
+    ENGINE_TARGET_AVX2 static __m256 load_int16x8_avx2(const std::int16_t* p) {
+        return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast) // unaligned load of 8 int16s
+    }
+
+    ENGINE_TARGET_AVX2 static glm::vec2 project_int16_avx2(const std::int16_t* x, const std::int16_t* y, const std::int16_t* z, std::size_t n, glm::vec3 axis) {
+        const __m256 ax = _mm256_set1_ps(axis.x), ay = _mm256_set1_ps(axis.y), az = _mm256_set1_ps(axis.z);
+        __m256 lo = _mm256_set1_ps(std::numeric_limits<float>::max());
+        __m256 hi = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+        for(std::size_t i = 0; i < n; i += 8) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic) // i + 8 <= n
+            const __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(load_int16x8_avx2(x + i), ax), _mm256_mul_ps(load_int16x8_avx2(y + i), ay)), _mm256_mul_ps(load_int16x8_avx2(z + i), az));
+            lo = _mm256_min_ps(lo, d);
+            hi = _mm256_max_ps(hi, d);
+        }
+
+        __m128 lo4 = _mm_min_ps(_mm256_castps256_ps128(lo), _mm256_extractf128_ps(lo, 1));
+        __m128 hi4 = _mm_max_ps(_mm256_castps256_ps128(hi), _mm256_extractf128_ps(hi, 1));
+        lo4 = _mm_min_ps(lo4, _mm_movehl_ps(lo4, lo4));
+        hi4 = _mm_max_ps(hi4, _mm_movehl_ps(hi4, hi4));
+        lo4 = _mm_min_ss(lo4, _mm_shuffle_ps(lo4, lo4, 1));
+        hi4 = _mm_max_ss(hi4, _mm_shuffle_ps(hi4, hi4, 1));
+        return { _mm_cvtss_f32(lo4), _mm_cvtss_f32(hi4) };
+    }
+#endif
+
+    glm::vec2 soa_points::project(glm::vec3 axis) const {
+        const std::size_t n = m_x.size();
+        switch(get_simd_level()) {
+#ifdef ENGINE_SOA_POINTS_X86_64
+        case simd_level::avx2:
+            return project_avx2(m_x.data(), m_y.data(), m_z.data(), n, axis);
+        case simd_level::sse:
+            return project_sse(m_x.data(), m_y.data(), m_z.data(), n, axis);
+#endif
+        default:
+            return project_scalar(m_x.data(), m_y.data(), m_z.data(), n, axis);
+        }
+    }
+
+    glm::vec2 project_int16_points(const std::int16_t* x, const std::int16_t* y, const std::int16_t* z, std::size_t n, glm::vec3 axis) {
+        switch(get_simd_level()) {
+#ifdef ENGINE_SOA_POINTS_X86_64
+        case simd_level::avx2:
+            return project_int16_avx2(x, y, z, n, axis);
+        case simd_level::sse:
+            return project_int16_sse(x, y, z, n, axis);
+#endif
+        default:
+            return project_int16_scalar(x, y, z, n, axis);
+        }
+    }
+}
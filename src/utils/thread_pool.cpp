@@ -0,0 +1,106 @@
+#include <engine/utils/thread_pool.hpp>
+#include <algorithm>
+#include <utility>
+
+namespace engine {
+    thread_pool::thread_pool(std::size_t threads) {
+        m_workers.reserve(threads);
+        for(std::size_t i = 0; i < threads; i++)
+            m_workers.emplace_back([this]() { worker_loop(); });
+    }
+
+    thread_pool::~thread_pool() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake_workers.notify_all();
+        m_workers.clear(); // joins them
+    }
+
+    thread_pool& thread_pool::shared() {
+        static thread_pool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+        return pool;
+    }
+
+    void thread_pool::worker_loop() {
+        std::uint64_t seen_generation = 0;
+        while(true) {
+            {
+                std::unique_lock lock(m_mutex);
+                m_wake_workers.wait(lock, [&]() { return m_stop || m_job_generation != seen_generation; });
+                if(m_stop)
+                    return;
+                seen_generation = m_job_generation;
+                m_busy_workers++;
+            }
+
+            run_chunks();
+
+            {
+                std::lock_guard lock(m_mutex);
+                m_busy_workers--;
+            }
+            m_wake_caller.notify_one();
+        }
+    }
+
+    void thread_pool::run_chunks() {
+        while(true) {
+            const std::size_t chunk = m_job.next_chunk.fetch_add(1);
+            if(chunk >= m_job.chunks)
+                return;
+
+            const std::size_t begin = chunk * m_job.chunk_size;
+            const std::size_t end = std::min(m_job.count, begin + m_job.chunk_size);
+            try {
+                m_job.call(m_job.f, begin, end);
+            } catch(...) {
+                std::lock_guard lock(m_mutex);
+                if(!m_exception)
+                    m_exception = std::current_exception();
+            }
+        }
+    }
+
+    void thread_pool::run(void (*call)(const void*, std::size_t, std::size_t), const void* f, std::size_t count, std::size_t min_chunk_size) {
+        if(count == 0)
+            return;
+
+        // a few chunks per thread, so that threads finishing early can take over some of the others' work
+        constexpr std::size_t chunks_per_thread = 4;
+        const std::size_t chunk_size = std::max({ min_chunk_size, std::size_t(1), count / (chunks_per_thread * (m_workers.size() + 1)) });
+        const std::size_t chunks = (count + chunk_size - 1) / chunk_size;
+        if(m_workers.empty() || chunks == 1) {
+            call(f, 0, count);
+            return;
+        }
+
+        std::lock_guard loop_lock(m_loop_mutex);
+        {
+            std::unique_lock lock(m_mutex);
+            // workers which woke up late for the previous job may still be looking at it
+            m_wake_caller.wait(lock, [&]() { return m_busy_workers == 0; });
+            m_job.call = call;
+            m_job.f = f;
+            m_job.count = count;
+            m_job.chunk_size = chunk_size;
+            m_job.chunks = chunks;
+            m_job.next_chunk = 0;
+            m_job_generation++;
+        }
+        m_wake_workers.notify_all();
+
+        run_chunks();
+
+        std::exception_ptr exception;
+        {
+            // once the caller is out of chunks, the job is over when the workers are
+            std::unique_lock lock(m_mutex);
+            m_wake_caller.wait(lock, [&]() { return m_busy_workers == 0; });
+            exception = std::exchange(m_exception, nullptr);
+        }
+        if(exception)
+            std::rethrow_exception(exception);
+    }
+}
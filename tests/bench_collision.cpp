@@ -0,0 +1,301 @@
+#include <engine/resources_manager.hpp>
+#include <engine/scene/node.hpp>
+#include <engine/scene/broad_phase_collision.hpp>
+#include <engine/scene/broad_phase_collision/dynamic_aabb_tree.hpp>
+#include <engine/scene/broad_phase_collision/sweep_and_prune.hpp>
+#include <engine/scene/broad_phase_collision/spatial_hash_grid.hpp>
+#include <engine/utils/thread_pool.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// the collision benchmark suite: every detector runs the same synthetic scenes, headless, and the results are printed as
+// json on stdout, to be compared against pass all and across changes. the scenes are generated from a fixed seed and,
+// but for plane, mix colliders of every complexity (spheres, capsules, boxes, hulls of 18 and 63 points and a triangle mesh):
+// - plane: the scene resembling our content, triangle mesh unit cubes spread out on a plane, half of them doing a slow random walk;
+// - uniform: colliders spread evenly in a cube, half of them doing a slow random walk;
+// - clustered: dense clumps far apart from each other, a few colliders in each jittering;
+// - stacked: columns of resting colliders just touching each other, which never move;
+// - swarm: every collider moves every frame, along with a drift common to all, wrapping around the cube.
+// each detector runs the narrow phase on the calling thread only (with and without reusing the pair cache's results) and
+// on the shared thread pool. for each scene, detector, narrow phase and number of colliders it reports the pairs tested by
+// the narrow phase (reused from the pair cache or not), the colliding pairs, the time per frame and per pair tested; they
+// must all agree on the colliding pairs.
+// usage: engine__bench_collision [frames] [max n]
+
+using namespace engine;
+
+namespace {
+    std::size_t colliding_pairs_this_frame = 0;
+
+    stateless_script collision_counter() {
+        return stateless_script {
+            .vtable = {
+                // every pair is reported to both colliders: count it once
+                .react_to_collision = [](const node&, std::any&, collision_result, const node& event_src, const node& other) {
+                    if(std::less<const node*>{}(&event_src, &other))
+                        colliding_pairs_this_frame++;
+                },
+            },
+            .name = "collision_counter",
+        };
+    }
+
+    // the hull of points on a sphere of radius .5; points are grouped in triangles, all of which must be used
+    collision_shape hull_of_random_points(std::mt19937& rng, std::uint32_t points) {
+        std::normal_distribution<float> normal;
+        std::vector<glm::vec3> verts;
+        std::vector<glm::uvec3> indices;
+        for(std::uint32_t i = 0; i < points; i++)
+            verts.push_back(glm::normalize(glm::vec3(normal(rng), normal(rng), normal(rng))) * .5f);
+        for(std::uint32_t i = 0; i + 2 < points; i += 3)
+            indices.emplace_back(i, i + 1, i + 2);
+        stride_span<const glm::vec3> verts_span(verts.data(), 0, sizeof(glm::vec3), verts.size());
+        return collision_shape::from_mesh_convex_hull(verts_span, indices, collision_layer(0), collision_layer(0));
+    }
+
+    collision_shape cube_mesh() {
+        const std::array<glm::vec3, 8> verts = {{
+            {-.5f, -.5f, -.5f}, {.5f, -.5f, -.5f}, {.5f, .5f, -.5f}, {-.5f, .5f, -.5f},
+            {-.5f, -.5f,  .5f}, {.5f, -.5f,  .5f}, {.5f, .5f,  .5f}, {-.5f, .5f,  .5f},
+        }};
+        const std::array<glm::uvec3, 12> indices = {{
+            {0, 1, 2}, {0, 2, 3}, {4, 6, 5}, {4, 7, 6}, {0, 4, 5}, {0, 5, 1},
+            {3, 2, 6}, {3, 6, 7}, {0, 3, 7}, {0, 7, 4}, {1, 5, 6}, {1, 6, 2},
+        }};
+        stride_span<const glm::vec3> verts_span(verts.data(), 0, sizeof(glm::vec3), verts.size());
+        return collision_shape::from_mesh(verts_span, indices, collision_layer(0), collision_layer(0));
+    }
+
+    // the shapes colliders cycle through, all about a unit across, from the cheapest to the most expensive to test; the
+    // last one is the unit cube mesh
+    std::vector<rc<const collision_shape>> shapes_of_every_complexity() {
+        std::mt19937 rng(7);
+        std::vector<rc<const collision_shape>> ret;
+        ret.push_back(get_rm().new_from(collision_shape::sphere({ .radius = .5f }, collision_layer(0), collision_layer(0))));
+        ret.push_back(get_rm().new_from(collision_shape::capsule({ .radius = .3f, .half_height = .3f }, collision_layer(0), collision_layer(0))));
+        ret.push_back(get_rm().new_from(collision_shape::box({ .half_extents = glm::vec3(.5f, .4f, .3f) }, collision_layer(0), collision_layer(0))));
+        ret.push_back(get_rm().new_from(hull_of_random_points(rng, 18)));
+        ret.push_back(get_rm().new_from(hull_of_random_points(rng, 63)));
+        ret.push_back(get_rm().new_from(cube_mesh()));
+        return ret;
+    }
+
+    enum class scene_kind { plane, uniform, clustered, stacked, swarm };
+    constexpr std::array<scene_kind, 5> scene_kinds = { scene_kind::plane, scene_kind::uniform, scene_kind::clustered, scene_kind::stacked, scene_kind::swarm };
+
+    const char* name_of(scene_kind kind) {
+        switch(kind) {
+            case scene_kind::plane: return "plane";
+            case scene_kind::uniform: return "uniform";
+            case scene_kind::clustered: return "clustered";
+            case scene_kind::stacked: return "stacked";
+            case scene_kind::swarm: return "swarm";
+        }
+        return "";
+    }
+
+    // a scene's colliders, and how they move from a frame to the next; the same seed gives the same scene and motion
+    class synthetic_scene {
+        scene_kind m_kind;
+        std::mt19937 m_rng;
+        float m_world_size;
+        std::vector<glm::vec3> m_positions;
+        std::vector<glm::mat4> m_rotations;
+        std::vector<glm::vec3> m_velocities; // swarm only
+        std::vector<std::size_t> m_movers; // the colliders moving every frame
+    public:
+        synthetic_scene(scene_kind kind, std::size_t n, std::uint32_t seed) : m_kind(kind), m_rng(seed) {
+            // about a collider every 8 cubic units (or 16 square units on the plane): each touches a few others at any given time
+            m_world_size = kind == scene_kind::plane ? 4.f * std::sqrt(float(n)) : 2.f * std::cbrt(float(n));
+            std::uniform_real_distribution<float> unit(0.f, 1.f), angle(0.f, 6.3f);
+            std::normal_distribution<float> normal;
+
+            const std::size_t clusters = std::max<std::size_t>(1, n / 50);
+            std::vector<glm::vec3> cluster_centers;
+            for(std::size_t c = 0; c < clusters; c++)
+                cluster_centers.push_back(glm::vec3(unit(m_rng), unit(m_rng), unit(m_rng)) * m_world_size * 2.f);
+            const std::size_t columns_per_side = std::max<std::size_t>(1, std::size_t(std::ceil(std::sqrt(float(n) / 8.f))));
+
+            for(std::size_t i = 0; i < n; i++) {
+                glm::vec3 p;
+                switch(kind) {
+                    case scene_kind::plane:
+                        p = glm::vec3(unit(m_rng), 0.f, unit(m_rng)) * m_world_size;
+                        break;
+                    case scene_kind::uniform: case scene_kind::swarm:
+                        p = glm::vec3(unit(m_rng), unit(m_rng), unit(m_rng)) * m_world_size;
+                        break;
+                    case scene_kind::clustered:
+                        p = cluster_centers[i % clusters] + glm::vec3(normal(m_rng), normal(m_rng), normal(m_rng)) * 1.5f; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i % clusters < clusters
+                        break;
+                    case scene_kind::stacked: {
+                        const std::size_t column = i / 8;
+                        p = glm::vec3(float(column % columns_per_side) * 3.f, float(i % 8) * .95f, float(column / columns_per_side) * 3.f);
+                        break;
+                    }
+                }
+                m_positions.push_back(p);
+                // stacked colliders are upright, so that they rest on each other, and so are the cubes on the plane
+                const glm::vec3 axis = glm::normalize(glm::vec3(normal(m_rng), normal(m_rng), normal(m_rng)) + glm::vec3(0.f, 0.f, 1e-3f));
+                const bool upright = kind == scene_kind::stacked || kind == scene_kind::plane;
+                m_rotations.push_back(upright ? glm::mat4(1) : glm::rotate(glm::mat4(1), angle(m_rng), axis));
+                m_velocities.push_back(glm::vec3(normal(m_rng), normal(m_rng), normal(m_rng)) * .02f);
+
+                const bool moves = kind == scene_kind::swarm || ((kind == scene_kind::uniform || kind == scene_kind::plane) && i % 2 == 1) || (kind == scene_kind::clustered && i % 10 == 0);
+                if(moves)
+                    m_movers.push_back(i);
+            }
+        }
+
+        std::size_t size() const { return m_positions.size(); }
+        glm::mat4 transform(std::size_t i) const { return glm::translate(glm::mat4(1), m_positions.at(i)) * m_rotations.at(i); }
+
+        // moves the colliders to their next frame's positions, calling moved(i) for each one which moved
+        template<typename F>
+        void step(F&& moved) {
+            std::uniform_real_distribution<float> step_dist(-.05f, .05f);
+            const glm::vec3 drift = glm::vec3(.03f, 0.f, .01f);
+            for(std::size_t i : m_movers) {
+                glm::vec3& p = m_positions.at(i);
+                if(m_kind == scene_kind::swarm) {
+                    p += drift + m_velocities.at(i);
+                    p -= glm::floor(p / m_world_size) * m_world_size; // wrap around the cube
+                } else if(m_kind == scene_kind::plane) {
+                    p += glm::vec3(step_dist(m_rng), 0.f, step_dist(m_rng));
+                } else {
+                    p += glm::vec3(step_dist(m_rng), step_dist(m_rng), step_dist(m_rng));
+                }
+                moved(i);
+            }
+        }
+    };
+
+    struct run_result {
+        std::size_t frames;
+        std::vector<std::size_t> colliding_pairs_per_frame;
+        std::chrono::steady_clock::duration total{}, slowest_frame{};
+        broad_phase_collision_detector::pair_cache_stats stats;
+    };
+
+    run_result run(broad_phase_collision_detector& bpcd, scene_kind kind, std::size_t n, std::size_t frames, const std::vector<rc<const collision_shape>>& shapes) {
+        synthetic_scene scene(kind, n, 42);
+        std::vector<std::unique_ptr<node>> nodes;
+        nodes.reserve(n);
+        for(std::size_t i = 0; i < n; i++) {
+            const rc<const collision_shape>& shape = kind == scene_kind::plane ? shapes.back() : shapes.at(i % shapes.size());
+            nodes.push_back(node::make(std::to_string(i), collision_counter(), std::monostate(), shape, scene.transform(i)));
+            nodes.back()->set_collision_behaviour({ .passes_events_to_script = true });
+            bpcd.subscribe(nodes.back().get());
+        }
+
+        run_result ret { .frames = frames, .colliding_pairs_per_frame = {}, .stats = {} };
+        bpcd.reset_pair_cache_stats();
+        for(std::size_t frame = 0; frame < frames; frame++) {
+            if(frame != 0)
+                scene.step([&](std::size_t i) { nodes.at(i)->set_transform(scene.transform(i)); });
+
+            colliding_pairs_this_frame = 0;
+            const auto start = std::chrono::steady_clock::now();
+            bpcd.check_collisions_and_trigger_reactions();
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+
+            ret.total += elapsed;
+            ret.slowest_frame = std::max(ret.slowest_frame, elapsed);
+            ret.colliding_pairs_per_frame.push_back(colliding_pairs_this_frame);
+        }
+        ret.stats = bpcd.get_pair_cache_stats();
+
+        for(std::unique_ptr<node>& n : nodes)
+            bpcd.unsubscribe(n.get());
+        return ret;
+    }
+}
+
+int main(int argc, char** argv) {
+    const std::size_t frames = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 60;
+    const std::size_t max_n = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000;
+    // pass all hands n^2/2 pairs to the narrow phase every frame: cap how many it gets overall, or at 10k it would take minutes
+    constexpr std::size_t pass_all_pairs_budget = 5'000'000;
+
+    resources_manager::headless_instance rm;
+    const std::vector<rc<const collision_shape>> shapes = shapes_of_every_complexity();
+
+    struct detector {
+        const char* name;
+        bool is_quadratic;
+        std::function<std::unique_ptr<broad_phase_collision_detector>()> make;
+    };
+    const std::array<detector, 4> detectors = {{
+        { "pass_all", true, [] { return std::make_unique<pass_all_broad_phase_collision_detector>(); } },
+        { "dynamic_aabb_tree", false, [] { return std::make_unique<dynamic_aabb_tree_broad_phase_collision_detector>(); } },
+        { "sweep_and_prune", false, [] { return std::make_unique<sweep_and_prune_broad_phase_collision_detector>(); } },
+        { "spatial_hash_grid", false, [] { return std::make_unique<spatial_hash_grid_broad_phase_collision_detector>(1.5f); } },
+    }};
+
+    struct narrow_phase_config {
+        const char* name;
+        thread_pool* pool;
+        float pair_cache_tolerance;
+    };
+    const std::array<narrow_phase_config, 3> configs = {{
+        { .name = "serial_no_reuse", .pool = nullptr, .pair_cache_tolerance = -1.f },
+        { .name = "serial", .pool = nullptr, .pair_cache_tolerance = 1e-5f },
+        { .name = "thread_pool", .pool = &thread_pool::shared(), .pair_cache_tolerance = 1e-5f },
+    }};
+
+    bool ok = true;
+    bool first_result = true;
+    std::printf("{\n  \"threads\": %zu,\n  \"results\": [", thread_pool::shared().size() + 1);
+    for(scene_kind kind : scene_kinds) for(std::size_t n = 100; n <= max_n; n *= 10) {
+        std::vector<std::size_t> reference; // colliding pairs per frame reported by the detector which ran the most frames so far
+        for(const detector& d : detectors) for(const narrow_phase_config& config : configs) {
+            const std::size_t det_frames = d.is_quadratic ? std::clamp<std::size_t>(pass_all_pairs_budget / (n * n / 2), 1, frames) : frames;
+
+            std::unique_ptr<broad_phase_collision_detector> bpcd = d.make();
+            bpcd->set_thread_pool(config.pool);
+            bpcd->set_pair_cache_tolerance(config.pair_cache_tolerance);
+            const run_result res = run(*bpcd, kind, n, det_frames, shapes);
+            get_rm().collect_garbage();
+
+            std::size_t colliding_pairs = 0;
+            for(std::size_t c : res.colliding_pairs_per_frame)
+                colliding_pairs += c;
+            const std::size_t pairs_tested = res.stats.hits + res.stats.axis_early_outs + res.stats.misses;
+            const double total_ns = std::chrono::duration<double, std::nano>(res.total).count();
+            std::printf("%s\n    { \"scene\": \"%s\", \"detector\": \"%s\", \"narrow_phase\": \"%s\", \"colliders\": %zu, \"frames\": %zu, "
+                        "\"pairs_tested\": %zu, \"pairs_reused\": %zu, \"axis_early_outs\": %zu, \"pairs_colliding\": %zu, "
+                        "\"ns_per_pair\": %.1f, \"total_ms\": %.3f, \"ms_per_frame\": %.3f, \"slowest_frame_ms\": %.3f }",
+                first_result ? "" : ",", name_of(kind), d.name, config.name, n, res.frames,
+                pairs_tested, res.stats.hits, res.stats.axis_early_outs, colliding_pairs,
+                pairs_tested != 0 ? total_ns / double(pairs_tested) : 0., total_ns * 1e-6, total_ns * 1e-6 / double(res.frames),
+                std::chrono::duration<double, std::milli>(res.slowest_frame).count());
+            first_result = false;
+
+            // detectors may have run a different number of frames: compare the common ones
+            const std::size_t common = std::min(reference.size(), res.colliding_pairs_per_frame.size());
+            for(std::size_t f = 0; f < common; f++) {
+                if(reference[f] != res.colliding_pairs_per_frame[f]) { // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // f < common
+                    std::fprintf(stderr, "%s, n = %zu, %s, %s: %zu colliding pairs at frame %zu, expected %zu\n", name_of(kind), n, d.name, config.name, res.colliding_pairs_per_frame[f], f, reference[f]); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // f < common
+                    ok = false;
+                    break;
+                }
+            }
+            if(res.colliding_pairs_per_frame.size() > reference.size())
+                reference = res.colliding_pairs_per_frame;
+        }
+    }
+    std::printf("\n  ]\n}\n");
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+#include <engine/scene/node/narrow_phase_collision.hpp>
+#include <engine/utils/soa_points.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// times check_collision between convex meshes (ellipsoids) of a given number of vertices at random poses, once for
+// every simd level the cpu supports, and checks that they all agree with the scalar one. sat tests every pair of edges,
+// so colliding pairs cost O(edges^2 * verts): a few hundred pairs of the largest meshes already take a while.
+// usage: engine__tests_bench_narrow_phase [pairs] [max verts]
+
+using namespace engine;
+
+namespace {
+    // a uv ellipsoid with 2 + rings * segments vertices
+    collision_shape ellipsoid(std::uint32_t rings, std::uint32_t segments, glm::vec3 radii) {
+        std::vector<glm::vec3> verts;
+        verts.emplace_back(0.f, radii.y, 0.f);
+        for(std::uint32_t r = 1; r <= rings; r++) {
+            const float phi = glm::pi<float>() * float(r) / float(rings + 1);
+            for(std::uint32_t s = 0; s < segments; s++) {
+                const float theta = glm::two_pi<float>() * float(s) / float(segments);
+                verts.emplace_back(radii.x * std::sin(phi) * std::cos(theta), radii.y * std::cos(phi), radii.z * std::sin(phi) * std::sin(theta));
+            }
+        }
+        verts.emplace_back(0.f, -radii.y, 0.f);
+
+        const std::uint32_t bottom = (std::uint32_t)verts.size() - 1;
+        auto ring_vert = [&](std::uint32_t r, std::uint32_t s) { return 1 + r * segments + s % segments; };
+        std::vector<glm::uvec3> indices;
+        for(std::uint32_t s = 0; s < segments; s++) {
+            indices.emplace_back(0, ring_vert(0, s + 1), ring_vert(0, s));
+            indices.emplace_back(bottom, ring_vert(rings - 1, s), ring_vert(rings - 1, s + 1));
+            for(std::uint32_t r = 0; r + 1 < rings; r++) {
+                indices.emplace_back(ring_vert(r, s), ring_vert(r, s + 1), ring_vert(r + 1, s + 1));
+                indices.emplace_back(ring_vert(r, s), ring_vert(r + 1, s + 1), ring_vert(r + 1, s));
+            }
+        }
+
+        stride_span<const glm::vec3> verts_span(verts.data(), 0, sizeof(glm::vec3), verts.size());
+        return collision_shape::from_mesh(verts_span, std::span<const glm::uvec3>(indices), collision_layer(0), collision_layer(0));
+    }
+
+    glm::mat4 random_pose(std::mt19937& rng) {
+        std::uniform_real_distribution<float> pos_dist(-1.5f, 1.5f);
+        std::uniform_real_distribution<float> unit_dist(-1.f, 1.f);
+        std::uniform_real_distribution<float> angle_dist(0.f, glm::two_pi<float>());
+
+        const glm::vec3 axis = glm::vec3(unit_dist(rng), unit_dist(rng), unit_dist(rng)) + glm::vec3(0.f, 0.f, 1e-3f);
+        return glm::rotate(glm::translate(glm::mat4(1), { pos_dist(rng), pos_dist(rng), pos_dist(rng) }), angle_dist(rng), glm::normalize(axis));
+    }
+
+    struct result {
+        double ns_per_pair;
+        std::vector<collision_result> collisions;
+    };
+
+    result run(const collision_shape& a, const collision_shape& b, const std::vector<std::array<glm::mat4, 2>>& poses) {
+        result ret { .ns_per_pair = 0., .collisions = {} };
+        ret.collisions.reserve(poses.size());
+
+        auto start = std::chrono::steady_clock::now();
+        for(const auto& [a_trans, b_trans] : poses)
+            ret.collisions.push_back(check_collision(a, a_trans, b, b_trans));
+        ret.ns_per_pair = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / double(poses.size());
+
+        return ret;
+    }
+}
+
+int main(int argc, char** argv) {
+    const std::size_t pairs = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100;
+    const std::size_t max_verts = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 500;
+
+    struct level {
+        const char* name;
+        simd_level value;
+    };
+    const std::array<level, 3> levels = {{ { "scalar", simd_level::scalar }, { "sse", simd_level::sse }, { "avx2", simd_level::avx2 } }};
+    const simd_level default_level = get_simd_level();
+
+    std::mt19937 rng(42);
+    bool ok = true;
+    // rings * segments + 2 vertices: 50, 102, 202, 502
+    constexpr std::array<std::array<std::uint32_t, 2>, 4> sizes = {{ { 4, 12 }, { 5, 20 }, { 8, 25 }, { 10, 50 } }};
+    for(const auto& [rings, segments] : sizes) {
+        const collision_shape a = ellipsoid(rings, segments, { 1.f, .6f, .8f });
+        const collision_shape b = ellipsoid(rings, segments, { .5f, 1.f, .7f });
+        if(a.polytope.vert_count() > max_verts)
+            break;
+
+        std::vector<std::array<glm::mat4, 2>> poses(pairs);
+        for(auto& [a_trans, b_trans] : poses) {
+            a_trans = random_pose(rng);
+            b_trans = random_pose(rng);
+        }
+
+        std::vector<collision_result> reference;
+        double scalar_ns = 0.;
+        for(const level& l : levels) {
+            if(!set_simd_level(l.value))
+                continue;
+
+            const result res = run(a, b, poses);
+            if(l.value == simd_level::scalar) {
+                scalar_ns = res.ns_per_pair;
+                reference = res.collisions;
+            }
+
+            std::size_t hits = 0, mismatches = 0;
+            for(std::size_t i = 0; i < pairs; i++) {
+                const collision_result& c = res.collisions[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < pairs
+                const collision_result& r = reference[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < pairs
+                hits += bool(c);
+                // the kernels may round differently, so only the outcome and (roughly) the depth must match
+                if(bool(c) != bool(r) || (c && std::abs(std::abs(c.depth) - std::abs(r.depth)) > 1e-3f))
+                    mismatches++;
+            }
+            std::printf("verts = %4zu  %-6s %10.1f ns/pair  x%.2f  (%zu/%zu colliding)\n", a.polytope.vert_count(), l.name, res.ns_per_pair, scalar_ns / res.ns_per_pair, hits, pairs);
+            if(mismatches != 0) {
+                std::printf("  %zu results differ from the scalar ones\n", mismatches);
+                ok = false;
+            }
+        }
+    }
+
+    set_simd_level(default_level);
+    return ok ? 0 : 1;
+}
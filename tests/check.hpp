@@ -0,0 +1,24 @@
+#ifndef ENGINE_TESTS_CHECK_HPP
+#define ENGINE_TESTS_CHECK_HPP
+
+#include <cstdio>
+
+// the checks of the tests which are plain mains: failed ones are printed, and checks_result() is main's return value
+namespace {
+    bool failed = false;
+
+    void check(bool condition, const char* what) {
+        if(!condition) {
+            std::printf("FAILED: %s\n", what);
+            failed = true;
+        }
+    }
+
+    int checks_result() {
+        if(!failed)
+            std::printf("all checks passed\n");
+        return failed ? 1 : 0;
+    }
+}
+
+#endif // ENGINE_TESTS_CHECK_HPP
@@ -0,0 +1,112 @@
+#include <engine/resources_manager.hpp>
+#include <engine/scene/node.hpp>
+#include <engine/scene/broad_phase_collision.hpp>
+#include <engine/utils/thread_pool.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+
+// checks the collision resolver on a few small scenes of unit cubes: how far the nodes moving away are moved, that
+// several contacts pushing the same way are not summed, and that the result does not depend on the thread pool
+
+using namespace engine;
+
+namespace {
+    bool near(glm::vec3 a, glm::vec3 b) { return glm::all(glm::lessThan(glm::abs(a - b), glm::vec3(1e-4f))); }
+
+    rc<const collision_shape> unit_cube() {
+        return get_rm().new_from(collision_shape::box({ .half_extents = glm::vec3(.5f) }, collision_layer(0), collision_layer(0)));
+    }
+
+    struct scene_of_cubes {
+        rc<const collision_shape> shape = unit_cube();
+        std::vector<std::unique_ptr<node>> nodes;
+        pass_all_broad_phase_collision_detector bpcd;
+
+        node& add(glm::vec3 position, bool moves_away) {
+            nodes.push_back(node::make(std::to_string(nodes.size()), shape, glm::translate(glm::mat4(1), position)));
+            nodes.back()->set_collision_behaviour({ .moves_away_on_collision = moves_away });
+            bpcd.subscribe(nodes.back().get());
+            return *nodes.back();
+        }
+
+        ~scene_of_cubes() {
+            for(std::unique_ptr<node>& n : nodes)
+                bpcd.unsubscribe(n.get());
+        }
+    };
+
+    glm::vec3 position(const node& n) { return glm::vec3(n.transform()[3]); }
+}
+
+int main() {
+    resources_manager::headless_instance rm;
+
+    {
+        scene_of_cubes s;
+        node& mover = s.add({ .8f, 0, 0 }, true);
+        s.add({ 0, 0, 0 }, false);
+        s.bpcd.check_collisions_and_trigger_reactions();
+        check(near(position(mover), { 1.f, 0, 0 }), "a node moves away from a static one by the whole depth");
+    }
+
+    {
+        scene_of_cubes s;
+        node& a = s.add({ .8f, 0, 0 }, true);
+        node& b = s.add({ 0, 0, 0 }, true);
+        s.bpcd.check_collisions_and_trigger_reactions();
+        check(near(position(a), { .9f, 0, 0 }) && near(position(b), { -.1f, 0, 0 }), "two nodes moving away share the depth");
+    }
+
+    {
+        // two static cubes overlapping the mover by .2 and .3 along x: it has to move by .3, not .5
+        scene_of_cubes s;
+        node& mover = s.add({ 0, 0, 0 }, true);
+        s.add({ -.8f, .3f, 0 }, false);
+        s.add({ -.7f, -.3f, 0 }, false);
+        s.bpcd.check_collisions_and_trigger_reactions();
+        check(near(position(mover), { .3f, 0, 0 }), "contacts pushing the same way are not summed");
+    }
+
+    {
+        // rows of cubes moving away, overlapping each other and a static one, are pushed apart the same way whatever the thread pool
+        std::array<std::vector<glm::vec3>, 2> results;
+        thread_pool pool(3);
+        for(std::size_t i = 0; i < results.size(); i++) {
+            scene_of_cubes s;
+            s.bpcd.set_thread_pool(i == 0 ? nullptr : &pool);
+            s.bpcd.get_collision_resolver().set_iterations(64);
+
+            std::mt19937 rng(7);
+            std::uniform_real_distribution<float> jitter(-.05f, .05f);
+            for(int row = 0; row < 16; row++) {
+                s.add({ -1.f, 3.f * float(row), 0 }, false);
+                for(int j = 0; j < 4; j++)
+                    s.add({ .9f * float(j) + jitter(rng), 3.f * float(row), 0 }, true);
+            }
+            s.bpcd.check_collisions_and_trigger_reactions();
+
+            for(const std::unique_ptr<node>& n : s.nodes)
+                results[i].push_back(position(*n)); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < results.size()
+        }
+        check(results[0] == results[1], "the result does not depend on the thread pool");
+
+        bool separated = true;
+        for(std::size_t i = 0; i + 1 < results[0].size(); i++) {
+            const glm::vec3 a = results[0][i], b = results[0][i + 1]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i + 1 < results[0].size()
+            if(a.y == b.y && b.x - a.x < 1.f - 1e-3f)
+                separated = false;
+        }
+        check(separated, "a row of cubes is pushed apart by the iterations");
+    }
+
+    return checks_result();
+}
@@ -0,0 +1,113 @@
+#include <engine/scene/node/collision_shape_cache.hpp>
+
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "check.hpp"
+
+// checks that cooked collision shapes come back out of the cache file as they went in, that stale entries are dropped on
+// save, and that a corrupt file is ignored
+
+using namespace engine;
+
+namespace {
+    bool same_shape(const collision_shape& a, const collision_shape& b) {
+        const packed_polytope::layout al = a.polytope.get_layout(), bl = b.polytope.get_layout();
+        return a.primitive.index() == b.primitive.index() && std::ranges::equal(a.polytope.data(), b.polytope.data())
+            && al.vert_count == bl.vert_count && al.face_count == bl.face_count && al.edge_count == bl.edge_count
+            && al.center == bl.center && al.step == bl.step && a.local_aabb.min == b.local_aabb.min && a.local_aabb.max == b.local_aabb.max
+            && a.bounding_sphere_center == b.bounding_sphere_center && a.bounding_sphere_radius == b.bounding_sphere_radius
+            && a.is_layers == b.is_layers && a.sees_layers == b.sees_layers
+            && (a.polytope.empty() || a.polytope.project(glm::vec3(1, 2, 3)) == b.polytope.project(glm::vec3(1, 2, 3)));
+    }
+
+    bool same_shapes(const std::optional<std::vector<collision_shape>>& a, const std::vector<collision_shape>& b) {
+        return a && std::ranges::equal(*a, b, same_shape);
+    }
+
+    std::uint64_t key_of(std::uint64_t n) { return collision_shape_cache::make_key({ std::as_bytes(std::span(&n, 1)) }); }
+}
+
+int main() {
+    const std::array<glm::vec3, 8> cube_verts = {{
+        {-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1}, {-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1},
+    }};
+    const std::array<glm::uvec3, 12> cube_indices = {{
+        {0, 2, 1}, {0, 3, 2}, {4, 5, 6}, {4, 6, 7}, {0, 1, 5}, {0, 5, 4}, {2, 3, 7}, {2, 7, 6}, {1, 2, 6}, {1, 6, 5}, {0, 4, 7}, {0, 7, 3},
+    }};
+    const stride_span<const glm::vec3> verts(cube_verts.data(), 0, sizeof(glm::vec3), cube_verts.size());
+
+    const std::vector<collision_shape> meshes = {
+        collision_shape::from_mesh(verts, cube_indices, collision_layer(1), collision_layer(2)),
+        collision_shape::from_mesh_convex_hull(verts, cube_indices, collision_layer(3), collision_layer(4)),
+    };
+    const std::vector<collision_shape> primitives = {
+        collision_shape::sphere({ .radius = .5f, .center = glm::vec3(1, 2, 3) }, 1, 1),
+        collision_shape::capsule({ .radius = .25f, .half_height = 1.f }, 2, 2),
+        collision_shape::box({ .half_extents = glm::vec3(1, 2, 3) }, 3, 3),
+    };
+
+    check(key_of(1) == key_of(1) && key_of(1) != key_of(2), "keys depend on the sources alone");
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "engine_test_collision_shape_cache.colshapes";
+    std::filesystem::remove(path);
+    {
+        collision_shape_cache cache(path.string());
+        check(!cache.find(key_of(1)), "a cache which does not exist is empty");
+        cache.insert(key_of(1), meshes);
+        cache.insert(key_of(2), primitives);
+        cache.insert(key_of(3), {});
+        check(cache.save(), "the cache is saved");
+    }
+    {
+        collision_shape_cache cache(path.string());
+        check(same_shapes(cache.find(key_of(1)), meshes) && same_shapes(cache.find(key_of(2)), primitives), "shapes are loaded as they were saved");
+        check(!cache.find(key_of(4)), "unknown keys are not found");
+        cache.insert(key_of(4), primitives);
+        check(cache.save(), "the cache is saved again");
+        check(same_shapes(cache.find(key_of(2)), primitives) && same_shapes(cache.find(key_of(4)), primitives), "the saved entries are found without opening the cache again");
+    }
+    {
+        collision_shape_cache cache(path.string());
+        check(same_shapes(cache.find(key_of(1)), meshes) && same_shapes(cache.find(key_of(4)), primitives), "found and inserted entries are kept");
+        check(!cache.find(key_of(3)), "entries neither found nor inserted are dropped on save");
+        // key 2 was in the file but not found since it was opened; what the first save wrote counts as found by the second
+        cache.insert(key_of(5), meshes);
+        check(cache.save() && !cache.find(key_of(2)) && same_shapes(cache.find(key_of(5)), meshes), "entries not found are dropped on save");
+        cache.insert(key_of(6), {});
+        check(cache.save() && same_shapes(cache.find(key_of(1)), meshes) && same_shapes(cache.find(key_of(5)), meshes), "saved entries are kept by later saves");
+    }
+
+    // a file cut short is ignored as a whole, and loading it does not crash
+    const std::uintmax_t size = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, size / 2);
+    {
+        collision_shape_cache cache(path.string());
+        check(!cache.find(key_of(1)) && !cache.find(key_of(4)), "a truncated cache is ignored");
+    }
+    {
+        // an entry count far larger than the index the file could hold (it follows the magic, format version and endianness marker)
+        std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(16);
+        const std::uint64_t entry_count = ~std::uint64_t(0) / 2;
+        f.write(reinterpret_cast<const char*>(&entry_count), sizeof(entry_count)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast) // writing the bytes
+    }
+    {
+        collision_shape_cache cache(path.string());
+        check(!cache.find(key_of(1)), "a cache whose entry count does not fit in the file is ignored");
+    }
+    {
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+        f << "not a cache";
+    }
+    {
+        collision_shape_cache cache(path.string());
+        check(!cache.find(key_of(1)), "a file of another format is ignored");
+    }
+    std::filesystem::remove(path);
+
+    return checks_result();
+}
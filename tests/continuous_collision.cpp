@@ -0,0 +1,111 @@
+#include <engine/resources_manager.hpp>
+#include <engine/scene/node.hpp>
+#include <engine/scene/broad_phase_collision.hpp>
+#include <engine/scene/broad_phase_collision/dynamic_aabb_tree.hpp>
+#include <engine/scene/broad_phase_collision/spatial_hash_grid.hpp>
+#include <engine/scene/broad_phase_collision/sweep_and_prune.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "check.hpp"
+
+// checks that check_swept_collision finds when fast colliders first touch what they would tunnel through, and that the
+// detectors sweep continuous colliders, moving them back in front of thin walls instead of letting them pass
+
+using namespace engine;
+
+namespace {
+    bool near(float a, float b, float eps) { return std::abs(a - b) <= eps; }
+
+    glm::mat4 at(glm::vec3 position) { return glm::translate(glm::mat4(1), position); }
+
+    std::vector<collision_result> collisions;
+
+    stateless_script collision_logger() {
+        return stateless_script {
+            .vtable = {
+                .react_to_collision = [](const node&, std::any&, collision_result res, const node&, const node&) { collisions.push_back(res); },
+            },
+            .name = "collision_logger",
+        };
+    }
+
+    // a bullet fired through a thin wall in a single frame, with and without being continuous
+    template<typename detector_t>
+    void check_detector(const char* name, const rc<const collision_shape>& bullet_shape, const rc<const collision_shape>& wall_shape) {
+        detector_t bpcd;
+        std::unique_ptr<node> wall = node::make("wall", wall_shape, at({ 0, 0, 0 }));
+        std::unique_ptr<node> bullet = node::make("bullet", bullet_shape, at({ -5, 0, 0 }));
+        std::unique_ptr<node> ghost = node::make("ghost", bullet_shape, at({ -5, 1, 0 }));
+        bullet->set_collision_behaviour({ .moves_away_on_collision = true, .passes_events_to_script = true, .is_continuous = true });
+        bullet->attach_script(collision_logger());
+        ghost->set_collision_behaviour({ .moves_away_on_collision = true });
+        bpcd.subscribe(wall.get());
+        bpcd.subscribe(bullet.get());
+        bpcd.subscribe(ghost.get());
+
+        collisions.clear();
+        bpcd.check_collisions_and_trigger_reactions();
+        check(collisions.empty(), name);
+
+        bullet->set_transform(at({ 5, 0, 0 }));
+        ghost->set_transform(at({ 5, 1, 0 }));
+        bpcd.check_collisions_and_trigger_reactions();
+        const glm::vec3 bullet_position = bullet->transform()[3];
+        check(collisions.size() == 1 && collisions.front().time_of_impact < 1.f && near(collisions.front().time_of_impact, .489f, 1e-2f), name);
+        check(bullet_position.x < -.1f && near(bullet_position.x, -.11f, 1e-2f) && bullet_position.y == 0.f, name);
+        check(glm::vec3(ghost->transform()[3]) == glm::vec3(5, 1, 0), name);
+
+        // the sweep starts from where the bullet was moved back to, not from where it was found behind the wall
+        collisions.clear();
+        bpcd.check_collisions_and_trigger_reactions();
+        check(collisions.empty(), name);
+    }
+}
+
+int main() {
+    // the wall is 2 cm thick; the bullet, 20 cm wide, crosses 10 m in a frame
+    const collision_shape wall = collision_shape::box({ .half_extents = glm::vec3(.01f, 2.f, 2.f) }, collision_layer(0), collision_layer(0));
+    const collision_shape bullet = collision_shape::sphere({ .radius = .1f }, collision_layer(0), collision_layer(0));
+    const collision_shape box_bullet = collision_shape::box({ .half_extents = glm::vec3(.1f) }, collision_layer(0), collision_layer(0));
+
+    check(!check_collision(bullet, at({ 5, 0, 0 }), wall, glm::mat4(1)), "the bullet ends past the wall");
+    {
+        const collision_result res = check_swept_collision(bullet, at({ -5, 0, 0 }), at({ 5, 0, 0 }), wall, glm::mat4(1), glm::mat4(1));
+        check(res && near(res.time_of_impact, .489f, 1e-3f), "the sweep finds when the bullet reaches the wall");
+        check(res && near(res.versor.x, 1.f, 1e-3f) && near(res.depth, 5.11f, 1e-2f), "the min translation moves the bullet back to the wall");
+        check(res && res.inverse().time_of_impact == res.time_of_impact, "the inverse result keeps the time of impact");
+    }
+    {
+        // the wall moves instead, and the bullet is a box: only the relative motion matters
+        const collision_result res = check_swept_collision(box_bullet, glm::mat4(1), glm::mat4(1), wall, at({ 5, 0, 0 }), at({ -5, 0, 0 }));
+        check(res && near(res.time_of_impact, .489f, 1e-3f) && near(res.versor.x, 1.f, 1e-3f), "moving walls are swept too");
+    }
+    {
+        // a bullet spinning a little while it flies
+        const glm::mat4 to = glm::rotate(at({ 5, 0, 0 }), .3f, glm::vec3(0, 0, 1));
+        const collision_result res = check_swept_collision(box_bullet, at({ -5, 0, 0 }), to, wall, glm::mat4(1), glm::mat4(1));
+        check(res && res.time_of_impact > .48f && res.time_of_impact < .5f, "rotating colliders are swept");
+    }
+    check(!check_swept_collision(bullet, at({ -5, 3, 0 }), at({ 5, 3, 0 }), wall, glm::mat4(1), glm::mat4(1)), "a bullet passing by the wall misses it");
+    check(!check_swept_collision(bullet, at({ 5, 0, 0 }), at({ 15, 0, 0 }), wall, glm::mat4(1), glm::mat4(1)), "a bullet moving away misses it");
+    check(!check_swept_collision(bullet, at({ -5, 0, 0 }), at({ -1, 0, 0 }), wall, glm::mat4(1), glm::mat4(1)), "a bullet stopping short misses it");
+    check(!check_swept_collision(bullet, glm::mat4(1), at({ 5, 0, 0 }), wall, glm::mat4(1), glm::mat4(1)), "a bullet starting in the wall is left to check_collision");
+    check(!check_swept_collision(bullet, at({ -5, .2f, 0 }), at({ -5, .2f, 0 }), wall, glm::mat4(1), glm::mat4(1)), "a still bullet misses it");
+
+    {
+        resources_manager::headless_instance rm;
+        const rc<const collision_shape> bullet_rc = get_rm().new_from(collision_shape(bullet));
+        const rc<const collision_shape> wall_rc = get_rm().new_from(collision_shape(wall));
+        check_detector<pass_all_broad_phase_collision_detector>("pass all detector sweeps continuous colliders", bullet_rc, wall_rc);
+        check_detector<dynamic_aabb_tree_broad_phase_collision_detector>("dynamic aabb tree sweeps continuous colliders", bullet_rc, wall_rc);
+        check_detector<sweep_and_prune_broad_phase_collision_detector>("sweep and prune sweeps continuous colliders", bullet_rc, wall_rc);
+        check_detector<spatial_hash_grid_broad_phase_collision_detector>("spatial hash grid sweeps continuous colliders", bullet_rc, wall_rc);
+    }
+
+    return checks_result();
+}
@@ -0,0 +1,140 @@
+#include <engine/utils/convex_hull.hpp>
+#include <engine/utils/hash.hpp>
+
+#include <array>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "check.hpp"
+
+// checks quickhull and convex_decomposition on point clouds and meshes whose hulls are known
+
+using namespace engine;
+
+namespace {
+    // every point is inside (or on) every face of the hull, and the triangles form a closed surface (euler: V - E + F == 2)
+    bool is_valid_hull(const convex_hull& hull, std::span<const glm::vec3> points, float eps) {
+        for(std::size_t t = 0; t < hull.triangles.size(); t++) {
+            const glm::uvec3 tri = hull.triangles[t]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // t < triangles.size()
+            const glm::vec3 n = glm::normalize(glm::cross(hull.verts[tri.y] - hull.verts[tri.x], hull.verts[tri.z] - hull.verts[tri.x])); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid indices
+            for(const glm::vec3& p : points) {
+                if(glm::dot(n, p - hull.verts[tri.x]) > eps) // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // valid index
+                    return false;
+            }
+        }
+        const std::size_t tri_edges = hull.triangles.size() * 3 / 2;
+        return hull.verts.size() + hull.triangles.size() == tri_edges + 2;
+    }
+
+    // a unit cube's 24 corners (duplicated, as in a mesh with split normals) plus some of its inside and surface
+    std::vector<glm::vec3> cube_cloud(std::mt19937& rng) {
+        std::vector<glm::vec3> ret;
+        for(int rep = 0; rep < 3; rep++)
+            for(int i = 0; i < 8; i++)
+                ret.emplace_back(i & 1 ? .5f : -.5f, i & 2 ? .5f : -.5f, i & 4 ? .5f : -.5f);
+
+        std::uniform_real_distribution<float> dist(-.5f, .5f);
+        for(int i = 0; i < 200; i++)
+            ret.emplace_back(dist(rng), dist(rng), dist(rng));
+        for(int i = 0; i < 50; i++)
+            ret.emplace_back(dist(rng), dist(rng), .5f); // on the top face
+        return ret;
+    }
+
+    // a box mesh, as 12 triangles
+    void add_box(glm::vec3 min, glm::vec3 max, std::vector<glm::vec3>& verts, std::vector<glm::uvec3>& triangles) {
+        const std::uint32_t base = (std::uint32_t)verts.size();
+        for(int i = 0; i < 8; i++)
+            verts.emplace_back(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z);
+
+        const std::array<glm::uvec3, 12> indices = {{
+            {0, 2, 3}, {0, 3, 1}, {4, 5, 7}, {4, 7, 6}, {0, 1, 5}, {0, 5, 4},
+            {2, 6, 7}, {2, 7, 3}, {0, 4, 6}, {0, 6, 2}, {1, 3, 7}, {1, 7, 5},
+        }};
+        for(glm::uvec3 t : indices)
+            triangles.push_back(t + base);
+    }
+
+    // an L-shaped prism of height 1, as a single closed surface
+    void add_l_prism(std::vector<glm::vec3>& verts, std::vector<glm::uvec3>& triangles) {
+        const std::array<glm::vec2, 6> outline = {{ {0, 0}, {4, 0}, {4, 1}, {1, 1}, {1, 4}, {0, 4} }}; // counterclockwise
+        const std::array<glm::uvec3, 4> cap = {{ {0, 1, 2}, {0, 2, 3}, {0, 3, 4}, {0, 4, 5} }};
+
+        const std::uint32_t base = (std::uint32_t)verts.size();
+        for(float z : { 0.f, 1.f })
+            for(glm::vec2 p : outline)
+                verts.emplace_back(p, z);
+
+        for(glm::uvec3 t : cap) {
+            triangles.emplace_back(base + t.x, base + t.z, base + t.y); // bottom, seen from below
+            triangles.push_back(t + base + 6u); // top
+        }
+        for(std::uint32_t i = 0; i < 6; i++) {
+            const std::uint32_t j = (i + 1) % 6;
+            triangles.emplace_back(base + i, base + j, base + 6 + j);
+            triangles.emplace_back(base + i, base + 6 + j, base + 6 + i);
+        }
+    }
+}
+
+int main() {
+    std::mt19937 rng(42);
+
+    {
+        const std::vector<glm::vec3> cloud = cube_cloud(rng);
+        const std::optional<convex_hull> hull = quickhull(cloud);
+        check(hull.has_value(), "cube: a hull is found");
+        if(hull) {
+            check(hull->verts.size() == 8, "cube: 8 vertices");
+            check(hull->face_normals.size() == 6, "cube: coplanar triangles are merged into 6 faces");
+            check(hull->edges.size() == 12, "cube: the diagonals inside faces are not edges");
+            check(is_valid_hull(*hull, cloud, 1e-4f), "cube: valid hull");
+        }
+    }
+
+    {
+        std::normal_distribution<float> dist;
+        std::vector<glm::vec3> sphere;
+        for(int i = 0; i < 2000; i++)
+            sphere.push_back(glm::normalize(glm::vec3(dist(rng), dist(rng), dist(rng))));
+
+        const std::optional<convex_hull> hull = quickhull(sphere);
+        check(hull && is_valid_hull(*hull, sphere, 1e-4f), "sphere: valid hull");
+
+        const std::optional<convex_hull> limited = quickhull(sphere, { .max_verts = 32 });
+        check(limited && limited->verts.size() <= 32 && limited->verts.size() >= 4, "sphere: the vertex limit is honoured");
+
+        const std::optional<convex_hull> limited_faces = quickhull(sphere, { .max_faces = 40 });
+        check(limited_faces && limited_faces->face_normals.size() <= 40 + 3, "sphere: the face limit is honoured (overshooting by at most a horizon)");
+    }
+
+    {
+        const std::vector<glm::vec3> flat = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 1, 1, 0 }, { .5f, .5f, 0 } };
+        check(!quickhull(flat).has_value(), "flat points have no hull");
+    }
+
+    {
+        std::vector<glm::vec3> verts;
+        std::vector<glm::uvec3> triangles;
+        add_box({ 0, 0, 0 }, { 1, 1, 1 }, verts, triangles);
+        check(convex_decomposition(verts, triangles).size() == 1, "a convex mesh is not split");
+
+        verts.clear();
+        triangles.clear();
+        add_l_prism(verts, triangles);
+        const std::vector<convex_hull> parts = convex_decomposition(verts, triangles);
+        check(parts.size() >= 2 && parts.size() <= 4, "an L is split in a few convex parts");
+
+        // no part may cover the L's notch
+        for(const convex_hull& part : parts) {
+            const std::array<glm::vec3, 1> notch = {{ { 2.5f, 2.5f, .5f } }};
+            check(!is_valid_hull(part, notch, 0.f), "the parts of an L do not cover its notch");
+        }
+
+        const std::vector<convex_hull> one = convex_decomposition(verts, triangles, { .max_hulls = 1 });
+        check(one.size() == 1, "max_hulls is honoured");
+    }
+
+    return checks_result();
+}
@@ -0,0 +1,115 @@
+#include <engine/resources_manager.hpp>
+#include <engine/scene/node.hpp>
+#include <engine/scene/mutation_queue.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "check.hpp"
+
+// checks that mutation_queue applies its batches by kind (payload swaps, reparents, spawns, destroys) whatever the order
+// they were recorded in, so that destroying a subtree wins over anything moved or spawned into it; that it ignores
+// reparents creating cycles and duplicate destroys; that blueprint spawns grow the ecs id pool once per batch; and that
+// deferred destruction keeps the destroyed nodes alive until flushed
+
+using namespace engine;
+
+namespace {
+    // the ecs ids in use: each node holds one, released when it is destroyed
+    ecs_id_t ids_in_use() { return get_rm().ecs().get_id_pool_size() - get_rm().ecs().get_freed_ids(); }
+
+    node& add(node& father, const std::string& name) {
+        father.add_child(node::make(name));
+        return father.get_child(name);
+    }
+
+    bool has_child(node& father, std::string_view name) {
+        for(const node& c : father.children())
+            if(c.name() == name)
+                return true;
+        return false;
+    }
+}
+
+int main() {
+    resources_manager::headless_instance rm;
+
+    {
+        // root -> { a -> { a1 }, b, c -> { c1 }, d }
+        std::unique_ptr<node> root = node::make("root");
+        node& a = add(*root, "a");
+        node& a1 = add(a, "a1");
+        node& b = add(*root, "b");
+        node& c = add(*root, "c");
+        add(c, "c1");
+        node& d = add(*root, "d");
+
+        // recorded in the reverse order of application: c is destroyed last anyway, taking along what was moved and spawned into it
+        mutation_queue q;
+        q.destroy(c);
+        q.spawn(c, node::make("spawned_into_c"));
+        q.reparent(d, c);
+        q.swap_payload(d, camera());
+        q.spawn(b, node::make("b1"));
+        q.reparent(b, a1);
+        check(!q.empty(), "recorded mutations are pending");
+
+        const ecs_id_t ids_before = ids_in_use();
+        q.apply();
+        check(q.empty(), "apply clears the queue");
+        check(!has_child(*root, "c") && !has_child(*root, "d"), "destroying a node destroys what was reparented into it");
+        // c, c1, d and spawned_into_c are gone (the spawned nodes got their ids when they were made)
+        check(ids_in_use() == ids_before - 4, "destroying a node destroys what was spawned into it");
+        check(b.get_father() == &a1 && has_child(b, "b1"), "reparents and spawns outside destroyed subtrees are applied");
+
+        // cycles are checked as if the reparents were applied one at a time
+        q.reparent(a, b); // b is a's descendant
+        q.reparent(b, *root);
+        q.reparent(*root, a); // the root has no father
+        q.apply();
+        check(a.get_father() == root.get() && b.get_father() == root.get(), "reparents creating cycles are ignored");
+
+        q.reparent(a1, b);
+        q.reparent(b, a1); // a1 is now b's child
+        q.apply();
+        check(a1.get_father() == &b && b.get_father() == root.get(), "reparents creating cycles with earlier ones in the batch are ignored");
+
+        // duplicates, and nodes whose ancestor is destroyed too, are destroyed once
+        const ecs_id_t ids_before_destroys = ids_in_use();
+        q.destroy(b);
+        q.destroy(a1);
+        q.destroy(b);
+        q.apply();
+        check(!has_child(*root, "b") && ids_in_use() == ids_before_destroys - 3, "duplicate destroys destroy once");
+
+        // deferred destruction: the nodes are detached at once, but only freed when flushed
+        node& e = add(*root, "e");
+        add(e, "e1");
+        q.set_deferred_destruction(true);
+        const ecs_id_t ids_before_deferred = ids_in_use();
+        q.destroy(e);
+        q.swap_payload(a, camera());
+        q.apply();
+        check(!has_child(*root, "e") && ids_in_use() == ids_before_deferred, "deferred destroys keep the nodes alive");
+        q.flush_deferred_destructions();
+        check(ids_in_use() == ids_before_deferred - 2, "flushing frees the deferred nodes");
+        q.set_deferred_destruction(false);
+
+        // blueprint spawns allocate all of their ecs ids at once
+        std::unique_ptr<node> bp_root = node::make("bp");
+        add(add(*bp_root, "bp_child"), "bp_grandchild");
+        const rc<const nodetree_blueprint> bp = get_rm().new_from(nodetree_blueprint(std::move(bp_root), "bp"));
+        constexpr ecs_id_t spawns = 100, nodes_per_spawn = 3;
+        for(ecs_id_t i = 0; i < spawns; i++)
+            q.spawn(a, bp, "copy" + std::to_string(i));
+        const ecs_id_t pool_before = get_rm().ecs().get_id_pool_size(), free_before = get_rm().ecs().get_freed_ids();
+        q.apply();
+        // allocating them one at a time would double the pool several times instead
+        const ecs_id_t needed = spawns * nodes_per_spawn;
+        const ecs_id_t expected_pool = free_before >= needed ? pool_before : std::max(pool_before * 2, pool_before + (needed - free_before));
+        check(a.children().size() == spawns && get_rm().ecs().get_id_pool_size() == expected_pool, "blueprint spawns reserve their ecs ids in one batch");
+    }
+
+    return checks_result();
+}
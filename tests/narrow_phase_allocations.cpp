@@ -0,0 +1,76 @@
+#include <engine/scene/node/narrow_phase_collision.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+// checks that check_collision does not allocate once its scratch buffers have grown: every pair test is run once to
+// warm them up and once more counting the allocations, which must be none.
+// the count relies on the replacement operator new below also being used by the engine's shared library, which holds
+// for ELF platforms; where it does not (e.g. with a dll) this test can only pass vacuously.
+
+namespace {
+    std::atomic<bool> counting = false;
+    std::atomic<std::size_t> allocations = 0;
+}
+
+void* operator new(std::size_t size) {
+    if(counting)
+        allocations++;
+    if(void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using namespace engine;
+
+namespace {
+    collision_shape box(glm::vec3 half_extents) {
+        std::array<glm::vec3, 8> verts{};
+        for(std::size_t i = 0; i < verts.size(); i++)
+            verts[i] = half_extents * glm::vec3(i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f, i & 4 ? 1.f : -1.f); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < verts.size()
+
+        const std::array<glm::uvec3, 12> indices = {{
+            {0, 1, 3}, {0, 3, 2}, {4, 7, 5}, {4, 6, 7}, {0, 4, 5}, {0, 5, 1},
+            {2, 3, 7}, {2, 7, 6}, {0, 2, 6}, {0, 6, 4}, {1, 5, 7}, {1, 7, 3},
+        }};
+        stride_span<const glm::vec3> verts_span(verts.data(), 0, sizeof(glm::vec3), verts.size());
+        return collision_shape::from_mesh(verts_span, indices, collision_layer(0), collision_layer(0));
+    }
+}
+
+int main() {
+    const collision_shape a = box({ 1.f, .5f, .3f });
+    const collision_shape b = box({ .4f, .8f, .6f });
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    std::vector<std::array<glm::mat4, 2>> poses(1000);
+    for(auto& [a_trans, b_trans] : poses) {
+        a_trans = glm::rotate(glm::translate(glm::mat4(1), { dist(rng), dist(rng), dist(rng) }), 3.f * dist(rng), glm::normalize(glm::vec3(dist(rng), dist(rng), 1.f)));
+        b_trans = glm::rotate(glm::translate(glm::mat4(1), { dist(rng), dist(rng), dist(rng) }), 3.f * dist(rng), glm::normalize(glm::vec3(1.f, dist(rng), dist(rng))));
+    }
+
+    for(const auto& [a_trans, b_trans] : poses) {
+        (void)check_collision(a, a_trans, b, b_trans);
+        (void)check_collision(b, b_trans, a, a_trans);
+    }
+
+    std::size_t collisions = 0;
+    counting = true;
+    for(const auto& [a_trans, b_trans] : poses) {
+        collisions += bool(check_collision(a, a_trans, b, b_trans));
+        collisions += bool(check_collision(b, b_trans, a, a_trans));
+    }
+    counting = false;
+
+    std::printf("%zu allocations over %zu pair tests (%zu collisions)\n", allocations.load(), 2 * poses.size(), collisions);
+    return allocations == 0 && collisions != 0 ? 0 : 1;
+}
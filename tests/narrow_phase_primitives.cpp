@@ -0,0 +1,154 @@
+#include <engine/scene/node/narrow_phase_collision.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "check.hpp"
+
+// checks check_collision's primitive shapes: the closed form tests against gjk and epa (which a slightly non uniform scale
+// forces check_collision to use), that the minimum translations separate the shapes, and the gjk distance query
+
+using namespace engine;
+
+namespace {
+    bool near(float a, float b, float eps) { return std::abs(a - b) <= eps; }
+
+    collision_shape box_mesh(glm::vec3 half_extents) {
+        std::array<glm::vec3, 8> verts{};
+        for(std::size_t i = 0; i < verts.size(); i++)
+            verts[i] = half_extents * glm::vec3(i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f, i & 4 ? 1.f : -1.f); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < verts.size()
+
+        const std::array<glm::uvec3, 12> indices = {{
+            {0, 1, 3}, {0, 3, 2}, {4, 7, 5}, {4, 6, 7}, {0, 4, 5}, {0, 5, 1},
+            {2, 3, 7}, {2, 7, 6}, {0, 2, 6}, {0, 6, 4}, {1, 5, 7}, {1, 7, 3},
+        }};
+        stride_span<const glm::vec3> verts_span(verts.data(), 0, sizeof(glm::vec3), verts.size());
+        return collision_shape::from_mesh(verts_span, indices, collision_layer(0), collision_layer(0));
+    }
+
+    glm::mat4 random_pose(std::mt19937& rng) {
+        std::uniform_real_distribution<float> pos_dist(-1.2f, 1.2f);
+        std::uniform_real_distribution<float> unit_dist(-1.f, 1.f);
+        std::uniform_real_distribution<float> angle_dist(0.f, glm::two_pi<float>());
+
+        const glm::vec3 axis = glm::vec3(unit_dist(rng), unit_dist(rng), unit_dist(rng)) + glm::vec3(0.f, 0.f, 1e-3f);
+        return glm::rotate(glm::translate(glm::mat4(1), { pos_dist(rng), pos_dist(rng), pos_dist(rng) }), angle_dist(rng), glm::normalize(axis));
+    }
+
+    // a's pose moved by translation
+    glm::mat4 moved(const glm::mat4& trans, glm::vec3 translation) { return glm::translate(glm::mat4(1), translation) * trans; }
+
+    struct pair_stats {
+        std::size_t hits = 0;
+        std::size_t mismatches = 0;
+        std::size_t not_separated = 0;
+    };
+
+    // compares check_collision between a and b with the one between a and b scaled by (1, 1 + 1e-3, 1), which is no
+    // similarity and so goes through gjk and epa; the results may only differ for pairs (almost) touching
+    pair_stats compare(const collision_shape& a, const collision_shape& b, std::mt19937& rng, std::size_t pairs) {
+        constexpr float eps = 1e-2f;
+        const glm::mat4 squash = glm::scale(glm::mat4(1), { 1.f, 1.f + 1e-3f, 1.f });
+
+        pair_stats ret;
+        for(std::size_t i = 0; i < pairs; i++) {
+            const glm::mat4 a_trans = random_pose(rng), b_trans = random_pose(rng);
+            const collision_result fast = check_collision(a, a_trans, b, b_trans);
+            const collision_result general = check_collision(a, a_trans, b, b_trans * squash);
+
+            ret.hits += bool(fast);
+            const float fast_depth = fast ? fast.depth : 0.f, general_depth = general ? general.depth : 0.f;
+            if(bool(fast) != bool(general) ? std::max(fast_depth, general_depth) > eps : !near(fast_depth, general_depth, eps))
+                ret.mismatches++;
+
+            for(const auto& [res, trans] : { std::pair(fast, b_trans), std::pair(general, b_trans * squash) }) {
+                if(!res)
+                    continue;
+                const collision_result after = check_collision(a, moved(a_trans, res.get_min_translation() * 1.01f - res.versor * 1e-3f), b, trans);
+                if(after && after.depth > eps)
+                    ret.not_separated++;
+            }
+        }
+        return ret;
+    }
+}
+
+int main() {
+    const collision_shape sphere = collision_shape::sphere({ .radius = .8f }, collision_layer(0), collision_layer(0));
+    const collision_shape small_sphere = collision_shape::sphere({ .radius = .5f, .center = { .1f, 0, 0 } }, collision_layer(0), collision_layer(0));
+    const collision_shape capsule = collision_shape::capsule({ .radius = .4f, .half_height = .6f }, collision_layer(0), collision_layer(0));
+    const collision_shape box = collision_shape::box({ .half_extents = { .5f, .7f, .3f } }, collision_layer(0), collision_layer(0));
+    const collision_shape mesh = box_mesh({ .6f, .4f, .5f });
+
+    {
+        const glm::mat4 a_trans = glm::mat4(1);
+        const collision_result res = check_collision(sphere, a_trans, small_sphere, glm::translate(glm::mat4(1), { 1.1f, 0, 0 }));
+        check(res && near(res.depth, .1f, 1e-5f) && near(res.versor.x, 1.f, 1e-5f), "sphere-sphere: depth and direction");
+        check(!check_collision(sphere, a_trans, small_sphere, glm::translate(glm::mat4(1), { 1.3f, 0, 0 })), "sphere-sphere: apart");
+
+        const collision_result on_box = check_collision(box, a_trans, sphere, glm::translate(glm::mat4(1), { 0, 0, 1.f }));
+        check(on_box && near(on_box.depth, .1f, 1e-5f) && near(on_box.versor.z, 1.f, 1e-5f), "box-sphere: depth and direction");
+
+        const collision_result crossed = check_collision(capsule, a_trans, capsule, glm::rotate(glm::mat4(1), glm::half_pi<float>(), { 1, 0, 0 }));
+        check(crossed && near(crossed.depth, .8f, 1e-5f), "capsule-capsule: crossing segments");
+    }
+
+    std::mt19937 rng(42);
+    struct pair_case {
+        const char* name;
+        const collision_shape& a;
+        const collision_shape& b;
+    };
+    const std::array<pair_case, 7> cases = {{
+        { "sphere-sphere", sphere, small_sphere },
+        { "sphere-box", sphere, box },
+        { "box-sphere", box, sphere },
+        { "capsule-capsule", capsule, capsule },
+        { "sphere-capsule", sphere, capsule },
+        { "capsule-box", capsule, box },
+        { "capsule-mesh", capsule, mesh },
+    }};
+    constexpr std::size_t pairs = 2000;
+    for(const pair_case& c : cases) {
+        const pair_stats stats = compare(c.a, c.b, rng, pairs);
+        std::printf("%-16s %4zu/%zu colliding, %zu differ from gjk/epa, %zu not separated by their min translation\n", c.name, stats.hits, pairs, stats.mismatches, stats.not_separated);
+        check(stats.hits != 0 && stats.mismatches == 0 && stats.not_separated == 0, c.name);
+    }
+
+    {
+        const std::optional<collision_distance_result> dist = collision_distance(sphere, glm::mat4(1), small_sphere, glm::translate(glm::mat4(1), { 0, 2.f, 0 }));
+        check(dist && near(dist->distance, glm::distance(glm::vec3(.1f, 2.f, 0), glm::vec3(0)) - 1.3f, 1e-4f), "distance: spheres");
+
+        const std::optional<collision_distance_result> to_mesh = collision_distance(capsule, glm::mat4(1), mesh, glm::translate(glm::mat4(1), { 2.f, .3f, 0 }));
+        check(to_mesh && near(to_mesh->distance, 2.f - .6f - .4f, 1e-4f) && near(to_mesh->b_point.x, 1.4f, 1e-4f), "distance: capsule to mesh");
+
+        check(!collision_distance(capsule, glm::mat4(1), box, glm::mat4(1)), "distance: intersecting shapes");
+    }
+
+    {
+        // rays along -x from x = 5, so that each shape is entered at its max x
+        const glm::vec3 origin = { 5.f, .1f, 0 }, direction = { -1.f, 0, 0 };
+        const std::optional<ray_hit> on_sphere = check_ray(sphere, glm::mat4(1), origin, direction, 10.f);
+        check(on_sphere && near(on_sphere->distance, 5.f - std::sqrt(.8f * .8f - .1f * .1f), 1e-4f), "ray: sphere");
+        const std::optional<ray_hit> on_capsule = check_ray(capsule, glm::translate(glm::mat4(1), { 0, 0, .2f }), origin, direction, 10.f);
+        check(on_capsule && near(on_capsule->distance, 5.f - std::sqrt(.4f * .4f - .2f * .2f), 1e-4f) && near(on_capsule->normal.z, -std::sqrt(.2f * .2f / (.4f * .4f)), 1e-4f), "ray: capsule side");
+        const std::optional<ray_hit> on_mesh = check_ray(mesh, glm::scale(glm::mat4(1), { 2.f, 1.f, 1.f }), origin, direction, 10.f);
+        check(on_mesh && near(on_mesh->distance, 5.f - 1.2f, 1e-4f) && near(on_mesh->normal.x, 1.f, 1e-5f), "ray: scaled mesh");
+        check(!check_ray(box, glm::mat4(1), origin, direction, 4.f), "ray: max_distance");
+        check(!check_ray(box, glm::mat4(1), origin, -direction, 10.f), "ray: pointing away");
+        const std::optional<ray_hit> inside = check_ray(box, glm::mat4(1), glm::vec3(0), direction, 10.f);
+        check(inside && inside->distance == 0.f && inside->normal == -direction, "ray: starting inside");
+    }
+
+    {
+        const aabb box_aabb = sphere.world_aabb(glm::rotate(glm::translate(glm::mat4(1), { 1, 2, 3 }), 1.f, glm::normalize(glm::vec3(1, 1, 0))));
+        check(glm::all(glm::lessThan(glm::abs(box_aabb.min - glm::vec3(.2f, 1.2f, 2.2f)), glm::vec3(1e-5f))), "world_aabb: a rotated sphere's is tight");
+    }
+
+    return checks_result();
+}
@@ -0,0 +1,117 @@
+#include <engine/utils/packed_polytope.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "check.hpp"
+
+// checks that packed_polytope's quantized vertices and directions stay within their documented error, that its
+// projections agree with projecting the decoded vertices at every simd level, and that boxes' corners are exact
+
+using namespace engine;
+
+namespace {
+    glm::vec2 project_decoded(const packed_polytope& p, glm::vec3 axis) {
+        glm::vec2 ret(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+        for(std::size_t i = 0; i < p.vert_count(); i++) {
+            const float d = glm::dot(p.vert(i), axis);
+            ret = glm::vec2(std::min(ret.x, d), std::max(ret.y, d));
+        }
+        return ret;
+    }
+}
+
+int main() {
+    std::mt19937 rng(42); // NOLINT(cert-msc32-c, cert-msc51-cpp) // deterministic on purpose
+    std::uniform_real_distribution<float> coord(-10.f, 10.f);
+    auto random_vec = [&]() { return glm::vec3(coord(rng), coord(rng), coord(rng)); };
+
+    // a box: its corners and the axes are exact
+    {
+        const glm::vec3 center(1.5f, -2.f, .25f), half(1.f, 2.5f, .5f);
+        std::vector<glm::vec3> corners;
+        for(int i = 0; i < 8; i++)
+            corners.push_back(center + half * glm::vec3(i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f, i & 4 ? 1.f : -1.f));
+        const std::array<glm::vec3, 3> axes = {{ {1, 0, 0}, {0, 1, 0}, {0, 0, 1} }};
+        const packed_polytope box(corners, axes, axes);
+
+        bool exact = box.vert_count() == 8 && box.face_count() == 3 && box.edge_count() == 3;
+        for(std::size_t i = 0; i < corners.size() && exact; i++)
+            exact = box.vert(i) == corners[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < corners.size()
+        for(std::size_t i = 0; i < axes.size() && exact; i++)
+            exact = box.face_normal(i) == axes[i] && box.edge(i) == axes[i]; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < axes.size()
+        check(exact, "a box's corners and axes are exact");
+        check(box.face_normal_extents(0) == glm::vec2(.5f, 2.5f) && box.project(glm::vec3(0, 1, 0)) == glm::vec2(-4.5f, .5f), "a box's extents are exact");
+    }
+
+    // a random point cloud, with random directions
+    std::vector<glm::vec3> verts(37), normals(20), edges(15);
+    std::ranges::generate(verts, random_vec);
+    std::ranges::generate(normals, random_vec);
+    std::ranges::generate(edges, random_vec);
+    const packed_polytope p(verts, normals, edges);
+
+    float max_vert_error = 0.f;
+    for(std::size_t i = 0; i < verts.size(); i++)
+        max_vert_error = std::max(max_vert_error, glm::length(p.vert(i) - verts[i])); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < verts.size()
+    check(max_vert_error <= 20.f / 16384.f, "vertices are within half a step of where they were");
+
+    // the sine of the angle: acos is too coarse near 1 in single precision
+    float max_angle = 0.f;
+    for(std::size_t i = 0; i < normals.size(); i++)
+        max_angle = std::max(max_angle, glm::length(glm::cross(p.face_normal(i), glm::normalize(normals[i])))); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < normals.size()
+    for(std::size_t i = 0; i < edges.size(); i++)
+        max_angle = std::max(max_angle, glm::length(glm::cross(p.edge(i), glm::normalize(edges[i])))); // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < edges.size()
+    check(max_angle < 1e-4f, "directions are within 1e-4 radians of where they were");
+
+    bool unit = true;
+    for(std::size_t i = 0; i < normals.size(); i++)
+        unit = unit && std::abs(glm::length(p.face_normal(i)) - 1.f) < 1e-6f;
+    check(unit, "face normals are unit length");
+
+    // the projections, the precomputed extents and the support function all agree with the decoded vertices
+    const simd_level best = get_simd_level();
+    for(simd_level level : { simd_level::scalar, simd_level::sse, simd_level::avx2 }) {
+        if(!set_simd_level(level))
+            continue;
+        bool agree = true;
+        for(int i = 0; i < 100; i++) {
+            const glm::vec3 axis = random_vec();
+            const glm::vec2 expected = project_decoded(p, axis), got = p.project(axis);
+            agree = agree && glm::all(glm::lessThanEqual(glm::abs(expected - got), glm::vec2(1e-4f * (1.f + glm::length(axis)) * 20.f)));
+        }
+        check(agree, "projections agree with the decoded vertices at every simd level");
+    }
+    set_simd_level(best);
+
+    bool extents_agree = true;
+    for(std::size_t i = 0; i < p.face_count(); i++)
+        extents_agree = extents_agree && glm::all(glm::lessThan(glm::abs(p.face_normal_extents(i) - project_decoded(p, p.face_normal(i))), glm::vec2(1e-4f)));
+    check(extents_agree, "the extents are the decoded vertices' projections on the decoded normals");
+
+    bool support_agrees = true;
+    for(int i = 0; i < 100; i++) {
+        const glm::vec3 d = random_vec();
+        support_agrees = support_agrees && std::abs(glm::dot(p.support(d), d) - project_decoded(p, d).y) < 1e-3f;
+    }
+    check(support_agrees, "the support function finds the farthest vertex");
+
+    soa_points transformed;
+    const glm::mat4 trans = glm::mat4(glm::vec4(0, 2, 0, 0), glm::vec4(-2, 0, 0, 0), glm::vec4(0, 0, 2, 0), glm::vec4(3, 4, 5, 1));
+    p.transform_verts(trans, transformed);
+    const glm::vec3 axis(.3f, -.5f, .8f);
+    const glm::vec2 direct = transformed.project(axis), through_decoded = project_decoded(p, glm::transpose(glm::mat3(trans)) * axis) + glm::dot(glm::vec3(3, 4, 5), axis);
+    check(transformed.size() == p.vert_count() && glm::all(glm::lessThan(glm::abs(direct - through_decoded), glm::vec2(1e-3f))), "transform_verts transforms the decoded vertices");
+
+    // round trip through the serialized form
+    const std::optional<packed_polytope> copy = packed_polytope::from_data(p.get_layout(), p.data());
+    check(copy && std::ranges::equal(copy->data(), p.data()) && copy->vert(5) == p.vert(5) && copy->face_normal(3) == p.face_normal(3), "from_data rebuilds the polytope");
+    check(!packed_polytope::from_data(p.get_layout(), p.data().first(p.data().size() - 1)), "from_data rejects data of the wrong size");
+
+    return checks_result();
+}
@@ -0,0 +1,80 @@
+#include <engine/resources_manager.hpp>
+#include <engine/scene/node.hpp>
+#include <engine/scene/broad_phase_collision.hpp>
+#include <engine/scene/broad_phase_collision/dynamic_aabb_tree.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+
+// checks that resting colliders fall asleep along with their island, cost no narrow phase while asleep, and wake up when
+// moved, hit by a moving collider or woken explicitly
+
+using namespace engine;
+
+namespace {
+    std::size_t narrow_phase_checks(const broad_phase_collision_detector& bpcd) {
+        const broad_phase_collision_detector::pair_cache_stats& stats = bpcd.get_pair_cache_stats();
+        return stats.hits + stats.axis_early_outs + stats.misses;
+    }
+}
+
+int main() {
+    resources_manager::headless_instance rm;
+
+    const rc<const collision_shape> cube = get_rm().new_from(collision_shape::box({ .half_extents = glm::vec3(.5f) }, collision_layer(0), collision_layer(0)));
+    std::vector<std::unique_ptr<node>> nodes;
+    dynamic_aabb_tree_broad_phase_collision_detector bpcd;
+    bpcd.set_sleep_frames(5);
+
+    auto add = [&](glm::vec3 position, node_collision_behaviour behaviour) -> node& {
+        nodes.push_back(node::make(std::to_string(nodes.size()), cube, glm::translate(glm::mat4(1), position)));
+        nodes.back()->set_collision_behaviour(behaviour);
+        bpcd.subscribe(nodes.back().get());
+        return *nodes.back();
+    };
+    auto run = [&](int frames) {
+        for(int i = 0; i < frames; i++)
+            bpcd.check_collisions_and_trigger_reactions();
+    };
+
+    // a floor which never sleeps, a pile of three cubes just touching each other and it, and a cube on its own
+    const node_collision_behaviour prop = { .moves_away_on_collision = true, .can_sleep = true };
+    add({ 0, 0, 0 }, {});
+    node& bottom = add({ 0, 1, 0 }, prop);
+    node& middle = add({ 0, 2, 0 }, prop);
+    node& top = add({ 0, 3, 0 }, prop);
+    node& alone = add({ 10, 0, 0 }, prop);
+
+    run(7);
+    check(bpcd.is_asleep(&bottom) && bpcd.is_asleep(&middle) && bpcd.is_asleep(&top) && bpcd.is_asleep(&alone), "resting colliders fall asleep");
+    check(!bpcd.is_asleep(nodes.front().get()), "colliders which cannot sleep stay awake");
+
+    bpcd.reset_pair_cache_stats();
+    run(3);
+    check(narrow_phase_checks(bpcd) == 0, "sleeping pairs skip the narrow phase");
+
+    top.set_transform(glm::translate(glm::mat4(1), { .01f, 3.f, 0 }));
+    run(1);
+    check(!bpcd.is_asleep(&bottom) && !bpcd.is_asleep(&top), "moving a node wakes its island up");
+    check(bpcd.is_asleep(&alone), "other islands keep sleeping");
+
+    run(6);
+    check(bpcd.is_asleep(&bottom), "the island falls asleep again");
+    bpcd.wake_up(&middle);
+    check(!bpcd.is_asleep(&bottom) && !bpcd.is_asleep(&top), "wake_up wakes the whole island");
+
+    // a new collider overlapping the sleeping one counts as moving
+    add({ 10.8f, 0, 0 }, {});
+    run(1);
+    check(!bpcd.is_asleep(&alone) && glm::vec3(alone.transform()[3]).x < 10.f, "a collider which moved wakes the sleeping ones it hits");
+
+    for(std::unique_ptr<node>& n : nodes)
+        bpcd.unsubscribe(n.get());
+
+    return checks_result();
+}
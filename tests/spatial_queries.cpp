@@ -0,0 +1,177 @@
+#include <engine/resources_manager.hpp>
+#include <engine/scene/node.hpp>
+#include <engine/scene/broad_phase_collision.hpp>
+#include <engine/scene/broad_phase_collision/dynamic_aabb_tree.hpp>
+#include <engine/scene/broad_phase_collision/spatial_hash_grid.hpp>
+#include <engine/scene/broad_phase_collision/sweep_and_prune.hpp>
+#include <engine/utils/thread_pool.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+
+// checks each detector's spatial queries against testing every collider, and the batched queries against the single ones
+
+using namespace engine;
+
+namespace {
+    bool layers_match(const node* n, collision_layers_bitmask layers) { return (n->get<collision_shape>().is_layers & layers) != 0; }
+
+    std::optional<spatial_query_hit> brute_force_raycast(const std::vector<std::unique_ptr<node>>& nodes, const raycast_query& q) {
+        std::optional<spatial_query_hit> closest;
+        for(const std::unique_ptr<node>& n : nodes) {
+            if(!layers_match(n.get(), q.layers))
+                continue;
+            const std::optional<ray_hit> hit = check_ray(n->get<collision_shape>(), n->get_global_transform(), q.origin, q.direction, q.max_distance);
+            if(hit && (!closest || hit->distance < closest->distance))
+                closest = spatial_query_hit { .collider = n.get(), .distance = hit->distance };
+        }
+        return closest;
+    }
+
+    std::vector<node*> brute_force_overlap(const std::vector<std::unique_ptr<node>>& nodes, const collision_shape& shape, const glm::mat4& trans, collision_layers_bitmask layers) {
+        std::vector<node*> ret;
+        for(const std::unique_ptr<node>& n : nodes) {
+            if(layers_match(n.get(), layers) && check_collision(n->get<collision_shape>(), n->get_global_transform(), shape, trans))
+                ret.push_back(n.get());
+        }
+        std::ranges::sort(ret);
+        return ret;
+    }
+
+    std::vector<float> brute_force_nearest_distances(const std::vector<std::unique_ptr<node>>& nodes, const k_nearest_query& q) {
+        const collision_shape point = collision_shape::sphere({ .radius = 0.f, .center = q.point }, 0, 0);
+        std::vector<float> ret;
+        for(const std::unique_ptr<node>& n : nodes) {
+            if(!layers_match(n.get(), q.layers))
+                continue;
+            const std::optional<collision_distance_result> d = collision_distance(point, glm::mat4(1), n->get<collision_shape>(), n->get_global_transform());
+            const float distance = d ? d->distance : 0.f;
+            if(distance <= q.max_distance)
+                ret.push_back(distance);
+        }
+        std::ranges::sort(ret);
+        ret.resize(std::min(ret.size(), q.k));
+        return ret;
+    }
+
+    std::vector<node*> sorted(std::vector<node*> v) {
+        std::ranges::sort(v);
+        return v;
+    }
+}
+
+int main() {
+    resources_manager::headless_instance rm;
+
+    // colliders of every kind, scattered in a 20 units wide cube, on two layers
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> coord(-10.f, 10.f), size(.2f, .8f), angle(0.f, 6.f);
+    std::vector<std::unique_ptr<node>> nodes;
+    for(int i = 0; i < 300; i++) {
+        const collision_layers_bitmask layer = collision_layer(i % 2);
+        collision_shape shape =
+            i % 3 == 0 ? collision_shape::box({ .half_extents = glm::vec3(size(rng), size(rng), size(rng)) }, layer, layer) :
+            i % 3 == 1 ? collision_shape::sphere({ .radius = size(rng) }, layer, layer) :
+                         collision_shape::capsule({ .radius = size(rng) * .5f, .half_height = size(rng) }, layer, layer);
+        const glm::mat4 transform = glm::rotate(glm::translate(glm::mat4(1), { coord(rng), coord(rng), coord(rng) }), angle(rng), glm::normalize(glm::vec3(coord(rng), coord(rng), 1.f)));
+        nodes.push_back(node::make(std::to_string(i), get_rm().new_from(std::move(shape)), transform));
+    }
+    // one so far away that its cells' coordinates do not fit in an int
+    nodes.push_back(node::make("far", get_rm().new_from(collision_shape::sphere({ .radius = 1.f }, all_collision_layers, all_collision_layers)), glm::translate(glm::mat4(1), { 1e10f, 0, 0 })));
+
+    std::vector<spatial_query> queries;
+    for(int i = 0; i < 200; i++) {
+        const collision_layers_bitmask layers = i % 3 == 0 ? all_collision_layers : collision_layer(i % 2);
+        const glm::vec3 p = { coord(rng), coord(rng), coord(rng) };
+        switch(i % 4) {
+            case 0: queries.emplace_back(raycast_query { .origin = p, .direction = glm::normalize(glm::vec3(coord(rng), coord(rng), coord(rng))), .max_distance = 15.f, .layers = layers }); break;
+            case 1: queries.emplace_back(sphere_overlap_query { .center = p, .radius = size(rng) * 4.f, .layers = layers }); break;
+            case 2: queries.emplace_back(aabb_overlap_query { .box = { .min = p, .max = p + glm::vec3(size(rng), size(rng), size(rng)) * 5.f }, .layers = layers }); break;
+            default: queries.emplace_back(k_nearest_query { .point = p, .k = 5, .max_distance = 4.f, .layers = layers }); break;
+        }
+    }
+
+    std::vector<std::unique_ptr<broad_phase_collision_detector>> detectors;
+    detectors.push_back(std::make_unique<pass_all_broad_phase_collision_detector>());
+    detectors.push_back(std::make_unique<dynamic_aabb_tree_broad_phase_collision_detector>());
+    detectors.push_back(std::make_unique<sweep_and_prune_broad_phase_collision_detector>());
+    detectors.push_back(std::make_unique<spatial_hash_grid_broad_phase_collision_detector>(1.f));
+
+    const collision_shape unit_cube = collision_shape::box({ .half_extents = glm::vec3(1) }, 0, 0);
+    thread_pool pool(3);
+    for(std::unique_ptr<broad_phase_collision_detector>& bpcd : detectors) {
+        for(std::unique_ptr<node>& n : nodes)
+            bpcd->subscribe(n.get());
+        bpcd->check_collisions_and_trigger_reactions();
+
+        std::vector<node*> overlapping;
+        std::vector<spatial_query_hit> nearest;
+        bool raycasts_ok = true, spheres_ok = true, boxes_ok = true, nearest_ok = true;
+        for(const spatial_query& query : queries) {
+            if(const auto* q = std::get_if<raycast_query>(&query)) {
+                const std::optional<spatial_query_hit> hit = bpcd->raycast(*q), expected = brute_force_raycast(nodes, *q);
+                // rays starting inside several colliders hit them all at 0, so only the distances are compared
+                if(bool(hit) != bool(expected) || (hit && hit->distance != expected->distance))
+                    raycasts_ok = false;
+            } else if(const auto* q = std::get_if<sphere_overlap_query>(&query)) {
+                bpcd->sphere_overlap(*q, overlapping);
+                const collision_shape sphere = collision_shape::sphere({ .radius = q->radius, .center = q->center }, 0, 0);
+                if(sorted(overlapping) != brute_force_overlap(nodes, sphere, glm::mat4(1), q->layers))
+                    spheres_ok = false;
+            } else if(const auto* q = std::get_if<aabb_overlap_query>(&query)) {
+                bpcd->aabb_overlap(*q, overlapping);
+                // a unit cube scaled to the box, as the detectors test it, so that the same closed forms are used
+                const glm::mat4 box_transform = glm::scale(glm::translate(glm::mat4(1), (q->box.min + q->box.max) * .5f), q->box.extent() * .5f);
+                if(sorted(overlapping) != brute_force_overlap(nodes, unit_cube, box_transform, q->layers))
+                    boxes_ok = false;
+            } else {
+                const k_nearest_query& k_query = std::get<k_nearest_query>(query);
+                bpcd->k_nearest(k_query, nearest);
+                std::vector<float> distances;
+                for(const spatial_query_hit& hit : nearest)
+                    distances.push_back(hit.distance);
+                if(distances != brute_force_nearest_distances(nodes, k_query))
+                    nearest_ok = false;
+            }
+        }
+        check(raycasts_ok, "raycasts hit the closest collider");
+        check(spheres_ok, "sphere overlaps find the overlapping colliders");
+        check(boxes_ok, "aabb overlaps find the overlapping colliders");
+        check(nearest_ok, "k_nearest finds the closest colliders");
+
+        // a batch gives the same hits, in the same order, whatever the thread pool
+        spatial_query_results serial, parallel;
+        bpcd->set_thread_pool(nullptr);
+        bpcd->run_queries(queries, serial);
+        bpcd->set_thread_pool(&pool);
+        bpcd->run_queries(queries, parallel);
+
+        bool batch_ok = serial.size() == queries.size() && parallel.size() == queries.size();
+        for(std::size_t i = 0; batch_ok && i < queries.size(); i++) {
+            const std::span<const spatial_query_hit> a = serial[i], b = parallel[i];
+            batch_ok = std::ranges::equal(a, b, [](const spatial_query_hit& x, const spatial_query_hit& y) { return x.collider == y.collider && x.distance == y.distance; });
+
+            if(const auto* q = std::get_if<raycast_query>(&queries[i])) { // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < queries.size()
+                const std::optional<spatial_query_hit> hit = bpcd->raycast(*q);
+                batch_ok = batch_ok && a.size() == (hit ? 1 : 0) && (!hit || a.front().collider == hit->collider);
+            } else if(const auto* q = std::get_if<sphere_overlap_query>(&queries[i])) { // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // i < queries.size()
+                bpcd->sphere_overlap(*q, overlapping);
+                batch_ok = batch_ok && a.size() == overlapping.size();
+            }
+        }
+        check(batch_ok, "batched queries give the same answers as single ones");
+
+        for(std::unique_ptr<node>& n : nodes)
+            bpcd->unsubscribe(n.get());
+    }
+
+    return checks_result();
+}
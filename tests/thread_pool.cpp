@@ -0,0 +1,74 @@
+#include <engine/utils/thread_pool.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+
+// checks that thread_pool::parallel_for covers its range exactly once whatever the pool and chunk sizes, that it propagates
+// exceptions and that it can be called from several threads at once
+
+using namespace engine;
+
+namespace {
+    // whether each index in [0, count) is visited exactly once, by chunks at least min_chunk_size long (but the last)
+    bool covers_once(thread_pool& pool, std::size_t count, std::size_t min_chunk_size) {
+        std::vector<std::atomic<int>> visits(count);
+        std::atomic<bool> short_chunk = false;
+        pool.parallel_for(count, min_chunk_size, [&](std::size_t begin, std::size_t end) {
+            if(end - begin < min_chunk_size && end != count)
+                short_chunk = true;
+            for(std::size_t i = begin; i < end; i++)
+                visits[i]++; // NOLINT(cppcoreguidelines-pro-bounds-avoid-unchecked-container-access) // end <= count
+        });
+
+        for(const std::atomic<int>& v : visits)
+            if(v != 1)
+                return false;
+        return !short_chunk;
+    }
+}
+
+int main() {
+    for(std::size_t threads : { 0, 1, 3, 8 }) {
+        thread_pool pool(threads);
+        for(std::size_t count : { 0, 1, 7, 100, 10'000 })
+            for(std::size_t min_chunk_size : { 0, 1, 32, 1000 })
+                check(covers_once(pool, count, min_chunk_size), "every index is visited exactly once");
+
+        bool caught = false;
+        try {
+            pool.parallel_for(1000, 1, [](std::size_t begin, std::size_t end) {
+                if(begin <= 500 && 500 < end)
+                    throw std::runtime_error("index 500");
+            });
+        } catch(const std::runtime_error&) {
+            caught = true;
+        }
+        check(caught, "an exception thrown in a chunk reaches the caller");
+        check(covers_once(pool, 1000, 1), "the pool still works after an exception");
+    }
+
+    {
+        // parallel_fors issued by different threads wait for each other instead of mixing up their chunks
+        thread_pool pool(4);
+        std::atomic<bool> all_ok = true;
+        std::vector<std::jthread> callers;
+        for(int i = 0; i < 4; i++)
+            callers.emplace_back([&]() {
+                for(int j = 0; j < 200; j++)
+                    if(!covers_once(pool, 1000, 8))
+                        all_ok = false;
+            });
+        callers.clear();
+        check(all_ok, "concurrent parallel_fors");
+    }
+
+    std::printf("shared pool: %zu workers\n", thread_pool::shared().size());
+    check(covers_once(thread_pool::shared(), 100'000, 32), "shared pool");
+
+    return checks_result();
+}
@@ -0,0 +1,107 @@
+#include <engine/resources_manager.hpp>
+#include <engine/scene/node.hpp>
+#include <engine/scene/broad_phase_collision.hpp>
+#include <engine/scene/broad_phase_collision/dynamic_aabb_tree.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "check.hpp"
+
+// checks that triggers get enter, stay and exit events, including when a collider leaves the broad phase's candidates or is unsubscribed,
+// that their overlaps are not resolved, and that they keep seeing the sleeping colliders inside them
+
+using namespace engine;
+
+namespace {
+    struct logged_event {
+        trigger_event event;
+        const node* other;
+        bool operator==(const logged_event&) const = default;
+    };
+    std::vector<logged_event> events;
+
+    stateless_script trigger_logger() {
+        return stateless_script {
+            .vtable = {
+                .react_to_trigger = [](const node&, std::any&, trigger_event event, const node&, const node& other) { events.push_back({ event, &other }); },
+            },
+            .name = "trigger_logger",
+        };
+    }
+
+    glm::mat4 at(glm::vec3 position) { return glm::translate(glm::mat4(1), position); }
+}
+
+int main() {
+    resources_manager::headless_instance rm;
+
+    const rc<const collision_shape> cube = get_rm().new_from(collision_shape::box({ .half_extents = glm::vec3(.5f) }, collision_layer(0), collision_layer(0)));
+    const rc<const collision_shape> volume = get_rm().new_from(collision_shape::box({ .half_extents = glm::vec3(2.f) }, collision_layer(0), collision_layer(0)));
+
+    dynamic_aabb_tree_broad_phase_collision_detector bpcd;
+    bpcd.set_sleep_frames(2);
+
+    std::unique_ptr<node> trigger = node::make("trigger", volume, at({ 0, 0, 0 }));
+    trigger->set_collision_behaviour({ .passes_events_to_script = true, .can_sleep = true, .is_trigger = true });
+    trigger->attach_script(trigger_logger());
+    std::unique_ptr<node> mover = node::make("mover", cube, at({ 5, 0, 0 }));
+    mover->set_collision_behaviour({ .moves_away_on_collision = true, .can_sleep = true });
+    bpcd.subscribe(trigger.get());
+    bpcd.subscribe(mover.get());
+
+    auto frame = [&]() {
+        events.clear();
+        bpcd.check_collisions_and_trigger_reactions();
+    };
+
+    frame();
+    check(events.empty(), "colliders apart send no events");
+
+    mover->set_transform(at({ 1.5f, 0, 0 }));
+    frame();
+    check(events == std::vector<logged_event>{{ trigger_event::enter, mover.get() }}, "overlapping colliders enter the trigger");
+    check(glm::vec3(mover->transform()[3]) == glm::vec3(1.5f, 0, 0), "trigger overlaps are not resolved");
+
+    frame();
+    check(events == std::vector<logged_event>{{ trigger_event::stay, mover.get() }}, "colliders still overlapping stay in the trigger");
+
+    frame();
+    frame();
+    check(bpcd.is_asleep(mover.get()) && !bpcd.is_asleep(trigger.get()), "triggers do not sleep, the colliders in them may");
+    check(events == std::vector<logged_event>{{ trigger_event::stay, mover.get() }}, "triggers keep seeing the sleeping colliders in them");
+
+    mover->set_transform(at({ 2.6f, 0, 0 }));
+    frame();
+    check(events == std::vector<logged_event>{{ trigger_event::exit, mover.get() }}, "colliders which stopped overlapping exit the trigger");
+    frame();
+    check(events.empty(), "exit is sent once");
+
+    mover->set_transform(at({ 0, 0, 0 }));
+    frame();
+    mover->set_transform(at({ 50, 0, 0 }));
+    frame();
+    check(events == std::vector<logged_event>{{ trigger_event::exit, mover.get() }}, "colliders which stopped being candidates exit the trigger");
+
+    mover->set_transform(at({ 0, 0, 0 }));
+    frame();
+    events.clear();
+    bpcd.unsubscribe(mover.get());
+    check(events == std::vector<logged_event>{{ trigger_event::exit, mover.get() }}, "unsubscribed colliders exit the trigger right away");
+    frame();
+    check(events.empty(), "unsubscribed colliders exit once");
+
+    // the collider stays, the trigger goes: the exit goes to the collider (which has no script), not to the trigger
+    bpcd.subscribe(mover.get());
+    frame();
+    check(events == std::vector<logged_event>{{ trigger_event::enter, mover.get() }}, "resubscribed colliders enter the trigger again");
+    events.clear();
+    bpcd.unsubscribe(trigger.get());
+    check(events.empty(), "unsubscribed nodes get no exit themselves");
+
+    bpcd.unsubscribe(mover.get());
+
+    return checks_result();
+}
@@ -0,0 +1,54 @@
+#include <engine/application/update_schedule.hpp>
+
+#include <variant>
+#include <vector>
+
+#include "check.hpp"
+
+// checks that in fixed timestep mode the events of a frame which runs no step are delivered to the next step, once,
+// and that the number of steps per frame is capped
+
+using namespace engine;
+
+namespace {
+    // a frame as application runs it: returns the events the frame's steps received
+    std::vector<event_variant_t> run_frame(update_schedule& s, float delta, const std::vector<event_variant_t>& polled) {
+        s.begin_frame();
+        for(const event_variant_t& e : polled)
+            s.push_event(e);
+
+        std::vector<event_variant_t> delivered;
+        const int steps = s.advance(delta);
+        for(int i = 0; i < steps; i++) {
+            if(i == 0)
+                delivered = s.events();
+            s.consume_events();
+        }
+        return delivered;
+    }
+
+    bool is_key(const event_variant_t& e, int key) {
+        return std::holds_alternative<key_event_t>(e) && std::get<key_event_t>(e).key == key;
+    }
+}
+
+int main() {
+    update_schedule s;
+    s.set_fixed_timestep(0.25f); // the deltas below are exact binary fractions of it
+
+    check(run_frame(s, 0.0625f, {key_event_t{1, 0, 1, 0}}).empty(), "a frame running no step delivers no events");
+    check(s.interpolation() == 0.25f, "the time left over is a fraction of a step");
+
+    const std::vector<event_variant_t> delivered = run_frame(s, 0.1875f, {key_event_t{2, 0, 1, 0}});
+    check(delivered.size() == 2 && is_key(delivered[0], 1) && is_key(delivered[1], 2), "the events of a frame running no step are delivered to the next step");
+    check(s.interpolation() == 0.f, "a step consumes its time");
+
+    check(run_frame(s, 0.25f, {}).empty() && s.events().empty(), "delivered events are delivered once");
+
+    const std::vector<event_variant_t> after_steps = run_frame(s, 0.5f, {key_event_t{3, 0, 1, 0}});
+    check(after_steps.size() == 1 && is_key(after_steps[0], 3), "a frame running several steps delivers its events to the first one");
+
+    check(s.advance(100.f) == update_schedule::max_steps_per_frame && s.interpolation() == 0.f, "steps per frame are capped, dropping the time left behind");
+
+    return checks_result();
+}